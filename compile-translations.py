@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+
+# Compiles the .po translation files into the binary catalogs the launcher embeds
+#
+# The launcher searches a catalog directly in its resource data, so nothing has to be parsed
+# or converted when it starts. Run this after changing a .po file and commit the .cat files.
+#
+# Usage: ./compile-translations.py [translations_xx.po ...]
+#
+# Catalog format, all integers are 32-bit little-endian:
+#   Header:  "KFXT", version, entry count, reserved
+#   Entries: hash, source offset, source size, translation offset, translation size
+#   Data:    UTF-8 source texts and UTF-16LE translations (2-byte aligned)
+# The entries are sorted by the FNV-1a hash of their UTF-8 source text and then by the source text.
+# Offsets are from the start of the file. The translation size is in UTF-16 code units.
+# This has to match 'src/translator.cpp'.
+
+import glob
+import html
+import os
+import re
+import struct
+import sys
+
+CATALOG_MAGIC = b"KFXT"
+CATALOG_VERSION = 1
+CATALOG_HEADER_SIZE = 16
+CATALOG_ENTRY_SIZE = 20
+
+
+def fnv1a(data):
+    hash = 0x811C9DC5
+    for byte in data:
+        hash ^= byte
+        hash = (hash * 0x01000193) & 0xFFFFFFFF
+    return hash
+
+
+def parse_po(data):
+    # Same rules as 'Translator::loadPoFile()'
+    translations = {}
+    msgid = b""
+    msgstr = b""
+    in_msgid = False
+    in_msgstr = False
+
+    for line in data.split(b"\n"):
+        line = line.strip()
+        if line.startswith(b"msgid"):
+            if msgid and msgstr:
+                translations[msgid] = msgstr
+                msgid = b""
+                msgstr = b""
+            msgid = line[7:-1]
+            in_msgid = True
+            in_msgstr = False
+        elif line.startswith(b"msgstr"):
+            msgstr = line[8:-1]
+            in_msgid = False
+            in_msgstr = True
+        elif in_msgid and line.startswith(b'"'):
+            msgid += line[1:-1]
+        elif in_msgstr and line.startswith(b'"'):
+            msgstr += line[1:-1]
+
+    if msgid and msgstr:
+        translations[msgid] = msgstr
+
+    # Translations that contain newlines are also added with real newlines
+    for key in list(translations.keys()):
+        if b"\\n" in key:
+            translations[key.replace(b"\\n", b"\n")] = translations[key].replace(b"\\n", b"\n")
+
+    catalog = {key: value.decode("utf-8", errors="replace") for key, value in translations.items()}
+
+    # Translations for HTML escaped sources are also added for their unescaped source text
+    for key, value in list(catalog.items()):
+        if b"&" not in key:
+            continue
+
+        escaped_source = key.decode("utf-8", errors="replace")
+        source = escaped_source.replace("&lt;", "<").replace("&gt;", ">").replace("&quot;", '"').replace("&amp;", "&")
+        if html.escape(source, quote=True).replace("&#x27;", "'") != escaped_source:
+            continue
+
+        source_utf8 = source.encode("utf-8")
+        if catalog.get(source_utf8):
+            continue
+
+        catalog[source_utf8] = html_to_plain_text(value)
+
+    return catalog
+
+
+def html_to_plain_text(text):
+    # Rich text is shown as plain text for the unescaped source
+    text = re.sub(r"(?i)<br\s*/?>", "\n", text)
+    text = re.sub(r"(?i)</p\s*>", "\n", text)
+    text = re.sub(r"<[^>]*>", "", text)
+    text = re.sub(r"[ \t\r\n]*\n[ \t\r\n]*", "\n", text)
+    text = re.sub(r"[ \t\r]+", " ", text)
+    return html.unescape(text).replace(" ", " ").strip()
+
+
+def write_catalog(catalog, path):
+    entries = sorted(
+        ((fnv1a(source), source, translation) for source, translation in catalog.items() if translation),
+        key=lambda entry: (entry[0], entry[1]),
+    )
+
+    table = bytearray()
+    data = bytearray()
+    data_start = CATALOG_HEADER_SIZE + CATALOG_ENTRY_SIZE * len(entries)
+
+    for hash, source, translation in entries:
+        source_offset = data_start + len(data)
+        data += source
+
+        if len(data) % 2:
+            data += b"\0"
+        translation_utf16 = translation.encode("utf-16-le")
+        translation_offset = data_start + len(data)
+        data += translation_utf16
+
+        table += struct.pack("<5I", hash, source_offset, len(source), translation_offset, len(translation_utf16) // 2)
+
+    header = CATALOG_MAGIC + struct.pack("<3I", CATALOG_VERSION, len(entries), 0)
+
+    with open(path, "wb") as file:
+        file.write(header + table + data)
+
+    return len(entries)
+
+
+def main():
+    po_files = sys.argv[1:] or sorted(glob.glob(os.path.join(os.path.dirname(os.path.abspath(__file__)), "i18n", "translations_*.po")))
+
+    for po_file in po_files:
+        with open(po_file, "rb") as file:
+            catalog = parse_po(file.read())
+
+        cat_file = os.path.splitext(po_file)[0] + ".cat"
+        entry_count = write_catalog(catalog, cat_file)
+        print(f"{os.path.basename(cat_file)}: {entry_count} translations")
+
+
+if __name__ == "__main__":
+    main()
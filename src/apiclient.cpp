@@ -1,4 +1,5 @@
 #include "apiclient.h"
+#include "logcategories.h"
 
 #include "launcheroptions.h"
 
@@ -25,7 +26,7 @@ QString ApiClient::getApiEndpoint()
     return QString(API_ENDPOINT);
 }
 
-QJsonDocument ApiClient::getJsonResponse(QUrl endpointPath, HttpMethod method, QJsonObject jsonPostObject)
+QString ApiClient::getEndpointUrlString(QUrl endpointPath)
 {
     // Strip '/api' and slashes from the endpoint path
     QString endpointPathString = endpointPath.toString();
@@ -36,13 +37,18 @@ QJsonDocument ApiClient::getJsonResponse(QUrl endpointPath, HttpMethod method, Q
         endpointPathString.remove(0, 1);
     }
 
+    return ApiClient::getApiEndpoint() + "/" + endpointPathString;
+}
+
+QJsonDocument ApiClient::getJsonResponse(QUrl endpointPath, HttpMethod method, QJsonObject jsonPostObject)
+{
     // Create full URL for logging
-    QString endpointUrlString = ApiClient::getApiEndpoint() + "/" + endpointPathString;
-    qDebug() << "ApiClient:" << (method == HttpMethod::GET ? "GET" : "POST") << endpointUrlString;
+    QString endpointUrlString = ApiClient::getEndpointUrlString(endpointPath);
+    qCDebug(logNet) << "ApiClient:" << (method == HttpMethod::GET ? "GET" : "POST") << endpointUrlString;
 
     // Setup network manager and API
     QNetworkAccessManager manager;
-    QNetworkRequest apiRequest(QUrl(ApiClient::getApiEndpoint() + "/" + endpointPathString));
+    QNetworkRequest apiRequest((QUrl(endpointUrlString)));
     apiRequest.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
 
     // Create the network reply object
@@ -61,13 +67,13 @@ QJsonDocument ApiClient::getJsonResponse(QUrl endpointPath, HttpMethod method, Q
 
     // Check for errors
     if (reply->error() != QNetworkReply::NoError) {
-        qWarning() << "ApiClient [ERROR]" << endpointUrlString << "->" << reply->errorString();
+        qCWarning(logNet) << "ApiClient [ERROR]" << endpointUrlString << "->" << reply->errorString();
         reply->deleteLater();
         return QJsonDocument();  // Return an empty QJsonDocument on error
     }
 
     // We retrieved something!
-    qDebug() << "ApiClient:" << endpointUrlString << "-> Success";
+    qCDebug(logNet) << "ApiClient:" << endpointUrlString << "-> Success";
 
     // Read the response and parse it as JSON
     QByteArray response = reply->readAll();
@@ -76,6 +82,18 @@ QJsonDocument ApiClient::getJsonResponse(QUrl endpointPath, HttpMethod method, Q
     return QJsonDocument::fromJson(response);
 }
 
+QNetworkReply *ApiClient::postJson(QNetworkAccessManager *manager, QUrl endpointPath, QIODevice *jsonBody)
+{
+    QString endpointUrlString = ApiClient::getEndpointUrlString(endpointPath);
+    qCDebug(logNet) << "ApiClient: POST" << endpointUrlString << "(" << jsonBody->size() << "bytes )";
+
+    QNetworkRequest apiRequest((QUrl(endpointUrlString)));
+    apiRequest.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    apiRequest.setHeader(QNetworkRequest::ContentLengthHeader, jsonBody->size());
+
+    return manager->post(apiRequest, jsonBody);
+}
+
 QJsonObject ApiClient::getLatestStable(){
 
     // URL of the API endpoint
@@ -120,7 +138,7 @@ QUrl ApiClient::getDownloadUrlStable()
 
     // Get download URL
     QString downloadUrlString = releaseObj["download_url"].toString();
-    qDebug() << "Stable Download URL:" << downloadUrlString;
+    qCDebug(logNet) << "Stable Download URL:" << downloadUrlString;
 
     // Return
     return QUrl(downloadUrlString);
@@ -136,7 +154,7 @@ QUrl ApiClient::getDownloadUrlAlpha()
 
     // Get download URL
     QString downloadUrlString = releaseObj["download_url"].toString();
-    qDebug() << "Alpha Download URL:" << downloadUrlString;
+    qCDebug(logNet) << "Alpha Download URL:" << downloadUrlString;
 
     // Return
     return QUrl(downloadUrlString);
@@ -151,7 +169,7 @@ QUrl ApiClient::getDownloadUrlMusic()
     // Get the JSON response
     QJsonDocument jsonDoc = ApiClient::getJsonResponse(url);
     if (jsonDoc.isObject() == false) {
-        qWarning() << "Download music URL: Invalid response";
+        qCWarning(logNet) << "Download music URL: Invalid response";
         return QUrl();
     }
 
@@ -161,32 +179,32 @@ QUrl ApiClient::getDownloadUrlMusic()
     // Get workshop item obj
     QJsonObject workshopItemObj = jsonObj["workshop_item"].toObject();
     if (workshopItemObj.isEmpty()) {
-        qWarning() << "Download music URL: Workshop item object not found";
+        qCWarning(logNet) << "Download music URL: Workshop item object not found";
         return QUrl();
     }
 
     // Get files obj
     QJsonArray filesArray = workshopItemObj["files"].toArray();
     if (filesArray.isEmpty()) {
-        qWarning() << "Download music URL: Files array not found";
+        qCWarning(logNet) << "Download music URL: Files array not found";
         return QUrl();
     }
 
     // Get first file
     QJsonObject fileObj = filesArray[0].toObject();
     if (fileObj.isEmpty()) {
-        qWarning() << "Download music URL: First file object not found";
+        qCWarning(logNet) << "Download music URL: First file object not found";
         return QUrl();
     }
 
     // Get URL
     QString fileDownloadString = fileObj["url"].toString();
     if (fileDownloadString.isEmpty() || fileDownloadString.isNull()) {
-        qWarning() << "Download music URL: File download string not found";
+        qCWarning(logNet) << "Download music URL: File download string not found";
         return QUrl();
     }
 
-    qDebug() << "Download music URL:" << fileDownloadString;
+    qCDebug(logNet) << "Download music URL:" << fileDownloadString;
 
     // Return
     return QUrl(fileDownloadString);
@@ -4,8 +4,11 @@
 
 #include <QUrl>
 #include <QImage>
+#include <QIODevice>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
 
 class ApiClient
 {
@@ -19,6 +22,10 @@ public:
 
     static QJsonDocument getJsonResponse(QUrl endpointPath, HttpMethod method = HttpMethod::GET, QJsonObject jsonPostObject = QJsonObject());
 
+    // Starts a POST request without blocking
+    // The JSON body is streamed from the device so it does not have to be in memory
+    static QNetworkReply *postJson(QNetworkAccessManager *manager, QUrl endpointPath, QIODevice *jsonBody);
+
     static QJsonObject getLatestStable();
     static QJsonObject getLatestAlpha();
 
@@ -27,4 +34,7 @@ public:
     static QUrl getDownloadUrlMusic();
 
     static std::optional<QMap<QString, QString>> getGameFileList(KfxVersion::ReleaseType type, QString version);
+
+private:
+    static QString getEndpointUrlString(QUrl endpointPath);
 };
@@ -1,4 +1,5 @@
 #include "archiver.h"
+#include "logcategories.h"
 
 #ifdef WIN32
 #include "helper.h" // For 64bit check on lib dll
@@ -12,6 +13,7 @@
 #include <bit7z/bitarchivereader.hpp>
 #include <bit7z/bitfilecompressor.hpp>
 #include <bit7z/bitfileextractor.hpp>
+#include <bit7z/bitmemcompressor.hpp>
 
 std::optional<bit7z::Bit7zLibrary> Archiver::lib;
 
@@ -31,19 +33,19 @@ void Archiver::loadBit7zLib()
     } else if (QFile(QCoreApplication::applicationDirPath() + "/7z.dll").exists()) {
         libPath = BIT7Z_STRING(QCoreApplication::applicationDirPath().toStdString() + "/7z.dll");
     } else {
-        qWarning() << "Failed to find 7zip lib to load";
+        qCWarning(logArchive) << "Failed to find 7zip lib to load";
         return;
     }
 
     if (!Helper::is64BitDLL(libPath)) {
-        qWarning() << "Not a 64 bit dll:" << libPath;
+        qCWarning(logArchive) << "Not a 64 bit dll:" << libPath;
     }
 #else
     bit7z::tstring libPath = BIT7Z_STRING(QCoreApplication::applicationDirPath().toStdString()
                                           + "/7z.so");
 #endif
 
-    qDebug() << "7z lib path:" << libPath;
+    qCDebug(logArchive) << "7z lib path:" << libPath;
     lib.emplace(libPath); // Initialize the static library
 
     // Make sure lib is loaded now
@@ -83,12 +85,22 @@ bit7z::BitFileCompressor Archiver::getCompressor()
     return bit7z::BitFileCompressor{*lib, bit7z::BitFormat::SevenZip};
 }
 
+bit7z::BitMemCompressor Archiver::getMemCompressor()
+{
+    // Make sure library is loaded
+    Archiver::loadBit7zLib();
+
+    // Create the compressor
+    // For now only 7z
+    return bit7z::BitMemCompressor{*lib, bit7z::BitFormat::SevenZip};
+}
+
 bool Archiver::compressSingleFile(QFile *inputFile, std::string outputPath)
 {
     bit7z::BitFileCompressor compressor = Archiver::getCompressor();
 
-    qDebug() << inputFile->fileName().toStdString();
-    qDebug() << outputPath;
+    qCDebug(logArchive) << inputFile->fileName().toStdString();
+    qCDebug(logArchive) << outputPath;
 
     try {
         compressor.compress({inputFile->fileName().toStdString()}, outputPath);
@@ -97,7 +109,41 @@ bool Archiver::compressSingleFile(QFile *inputFile, std::string outputPath)
 
     } catch ( const bit7z::BitException& ex ) {
 
-        qWarning() << "Failed to compress single file:" << ex.what();
+        qCWarning(logArchive) << "Failed to compress single file:" << ex.what();
+    }
+
+    return false;
+}
+
+bool Archiver::compressSingleFileToMemory(QFile *inputFile, std::vector<bit7z::byte_t> &outputBuffer)
+{
+    // Read the input file
+    // The compressor needs the whole input as a buffer
+    QFile file(inputFile->fileName());
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCWarning(logArchive) << "Failed to open file for compression:" << file.fileName();
+        return false;
+    }
+
+    std::vector<bit7z::byte_t> inputBuffer(static_cast<size_t>(file.size()));
+    if (file.read(reinterpret_cast<char *>(inputBuffer.data()), file.size()) != file.size()) {
+        qCWarning(logArchive) << "Failed to read file for compression:" << file.fileName();
+        return false;
+    }
+    file.close();
+
+    bit7z::BitMemCompressor compressor = Archiver::getMemCompressor();
+
+    try {
+        // Name the file inside the archive like the original file
+        outputBuffer.clear();
+        compressor.compressFile(inputBuffer, outputBuffer, QFileInfo(file.fileName()).fileName().toStdString());
+
+        return true;
+
+    } catch (const bit7z::BitException &ex) {
+
+        qCWarning(logArchive) << "Failed to compress single file to memory:" << ex.what();
     }
 
     return false;
@@ -124,7 +170,7 @@ uint64_t Archiver::testArchiveAndGetSize(QFile *archiveFile)
 
     } catch (const bit7z::BitException& ex) {
 
-        qWarning() << "Archive test failure:" << ex.what();
+        qCWarning(logArchive) << "Archive test failure:" << ex.what();
         return -1;
     }
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <optional>
+#include <vector>
 
 #include <QFile>
 
@@ -9,6 +10,7 @@
 #include <bit7z/bitarchivereader.hpp>
 #include <bit7z/bitfilecompressor.hpp>
 #include <bit7z/bitfileextractor.hpp>
+#include <bit7z/bitmemcompressor.hpp>
 
 class Archiver
 {
@@ -16,8 +18,10 @@ public:
     static bit7z::BitArchiveReader getReader(std::string filePath);
     static bit7z::BitFileExtractor getExtractor();
     static bit7z::BitFileCompressor getCompressor();
+    static bit7z::BitMemCompressor getMemCompressor();
 
     static bool compressSingleFile(QFile *inputFile, std::string outputPath);
+    static bool compressSingleFileToMemory(QFile *inputFile, std::vector<bit7z::byte_t> &outputBuffer);
 
     static uint64_t testArchiveAndGetSize(QFile *archiveFile);
 
@@ -1,17 +1,22 @@
 #include "campaign.h"
+#include "logcategories.h"
 
 #include <QApplication>
 #include <QDir>
-#include <QSettings>
 
 Campaign::Campaign(const QString &filePath)
+    : Campaign(CampaignIndex::getEntry(filePath))
+{
+}
+
+Campaign::Campaign(const CampaignIndex::Entry &entry)
 {
     // Set the path of the campaign file
-    file.setFileName(filePath);
+    file.setFileName(entry.filePath);
 
-    // Make sure the campaign can be loaded
-    if (!file.exists() || !file.open(QIODevice::ReadOnly)) {
-        qWarning() << "Failed to open campaign file:" << filePath;
+    // Make sure the campaign file exists
+    if (!file.exists()) {
+        qCWarning(logGame) << "Failed to open campaign file:" << entry.filePath;
         return;
     }
 
@@ -20,21 +25,19 @@ Campaign::Campaign(const QString &filePath)
     this->fileName = fileInfo.fileName();
     this->campaignShortName = fileInfo.baseName();
 
-    // Load the campaign settings file
-    settings = new QSettings(fileInfo.absoluteFilePath(), QSettings::IniFormat);
-    if (settings->status() != QSettings::NoError) {
-        qWarning() << "Failed to load campaign:" << this->fileName;
-        return;
-    }
-
     // Make sure campaign has a name
-    QString campaignNameString = settings->value("common/NAME").toString();
-    if (campaignNameString.isEmpty()) {
-        qWarning() << "Unable to find campaign name:" << this->campaignShortName;
+    if (entry.name.isEmpty()) {
+        qCWarning(logGame) << "Unable to find campaign name:" << this->campaignShortName;
         return;
     }
 
-    this->campaignName = campaignNameString;
+    // Load the indexed campaign information
+    this->campaignName = entry.name;
+    this->singleLevels = entry.singleLevels;
+    this->multiLevels = entry.multiLevels;
+    this->speechLanguages = entry.speechLanguages;
+    this->landViewStart = entry.landViewStart;
+    this->landViewEnd = entry.landViewEnd;
 }
 
 bool Campaign::isValid()
@@ -68,16 +71,29 @@ QList<Campaign *> Campaign::getAll()
         return list; // Empty list
     }
 
-    // Loop trough all files
+    // Get the campaign file paths
+    QStringList campaignFilePaths;
     for (const QString &campaignFilename : std::as_const(campaignFiles)) {
-        // Try to load this file as a campaign
-        Campaign *campaignFile = new Campaign(campaignFileDir.absoluteFilePath(campaignFilename));
+        campaignFilePaths << campaignFileDir.absoluteFilePath(campaignFilename);
+    }
+
+    // Get the campaigns from the campaign index
+    // Only new or changed campaign files are parsed
+    const QList<CampaignIndex::Entry> entries = CampaignIndex::getEntries(campaignFilePaths);
+
+    // Loop trough all entries
+    for (const CampaignIndex::Entry &entry : entries) {
+        // Try to load this entry as a campaign
+        Campaign *campaignFile = new Campaign(entry);
 
         if (campaignFile->isValid()) {
             list << campaignFile;
+        } else {
+            delete campaignFile;
+            continue;
         }
 
-        qDebug() << "Campaign:" << campaignFile->toString();
+        qCDebug(logGame) << "Campaign:" << campaignFile->toString();
     }
 
     return list;
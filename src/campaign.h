@@ -1,20 +1,26 @@
 #pragma once
 
+#include "campaignindex.h"
+
 #include <QFile>
-#include <QSettings>
 #include <QString>
 
 class Campaign
 {
 public:
     Campaign(const QString &filePath);
+    Campaign(const CampaignIndex::Entry &entry);
 
     QFile file;
     QString fileName;
     QString campaignName;
     QString campaignShortName;
 
-    QSettings *settings;
+    QList<int> singleLevels;
+    QList<int> multiLevels;
+    QStringList speechLanguages;
+    QString landViewStart;
+    QString landViewEnd;
 
     bool isValid();
     QString toString();
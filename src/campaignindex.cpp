@@ -0,0 +1,257 @@
+#include "campaignindex.h"
+#include "logcategories.h"
+
+#include "inireader.h"
+#include "launcheroptions.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFuture>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QtConcurrent/QtConcurrentRun>
+
+#define CAMPAIGN_INDEX_VERSION 1
+
+QHash<QString, CampaignIndex::Entry> CampaignIndex::entries;
+QMutex CampaignIndex::entriesMutex;
+bool CampaignIndex::isIndexLoaded = false;
+
+CampaignIndex::Entry CampaignIndex::getEntry(const QString &filePath)
+{
+    return CampaignIndex::getEntries({filePath}).value(0);
+}
+
+QList<CampaignIndex::Entry> CampaignIndex::getEntries(const QStringList &filePaths)
+{
+    QList<CampaignIndex::Entry> list(filePaths.size());
+    QList<int> outdatedIndexes;
+
+    // Grab the entries that are still up to date
+    {
+        QMutexLocker locker(&CampaignIndex::entriesMutex);
+        CampaignIndex::loadIndex();
+
+        for (int i = 0; i < filePaths.size(); ++i) {
+            QFileInfo fileInfo(filePaths.at(i));
+            auto it = CampaignIndex::entries.constFind(fileInfo.absoluteFilePath());
+            if (it != CampaignIndex::entries.constEnd() && CampaignIndex::isEntryUpToDate(it.value(), fileInfo)) {
+                list[i] = it.value();
+            } else {
+                outdatedIndexes << i;
+            }
+        }
+    }
+
+    // Everything is up to date
+    if (outdatedIndexes.isEmpty()) {
+        return list;
+    }
+
+    // Parse the new and changed campaign files in parallel
+    QList<QFuture<CampaignIndex::Entry>> futures;
+    for (int index : std::as_const(outdatedIndexes)) {
+        QString filePath = QFileInfo(filePaths.at(index)).absoluteFilePath();
+        futures << QtConcurrent::run([filePath]() { return CampaignIndex::parseFile(filePath); });
+    }
+
+    // Collect the parsed entries and store them in the index
+    QMutexLocker locker(&CampaignIndex::entriesMutex);
+    for (int i = 0; i < futures.size(); ++i) {
+        CampaignIndex::Entry entry = futures[i].result();
+        CampaignIndex::entries.insert(entry.filePath, entry);
+        list[outdatedIndexes.at(i)] = entry;
+    }
+
+    qCDebug(logGame) << "Campaign index updated:" << outdatedIndexes.size() << "file(s)";
+    CampaignIndex::saveIndex();
+
+    return list;
+}
+
+QString CampaignIndex::getIndexFilePath()
+{
+    return QDir::temp().filePath("kfx-launcher-campaign-index.json");
+}
+
+void CampaignIndex::loadIndex()
+{
+    // Only load the index once
+    if (CampaignIndex::isIndexLoaded) {
+        return;
+    }
+    CampaignIndex::isIndexLoaded = true;
+
+    // Check if the index should be bypassed
+    if (LauncherOptions::isSet("no-campaign-index")) {
+        return;
+    }
+
+    // Open the index file
+    QFile indexFile(CampaignIndex::getIndexFilePath());
+    if (indexFile.exists() == false || indexFile.open(QIODevice::ReadOnly) == false) {
+        return;
+    }
+
+    // Make sure the index is made by this version of the index
+    QJsonObject indexObject = QJsonDocument::fromJson(indexFile.readAll()).object();
+    if (indexObject["version"].toInt() != CAMPAIGN_INDEX_VERSION) {
+        qCDebug(logGame) << "Ignoring campaign index of a different version";
+        return;
+    }
+
+    // Load the entries
+    QJsonObject entriesObject = indexObject["entries"].toObject();
+    for (auto it = entriesObject.constBegin(); it != entriesObject.constEnd(); ++it) {
+        CampaignIndex::entries.insert(it.key(), CampaignIndex::entryFromJson(it.key(), it.value().toObject()));
+    }
+
+    qCDebug(logGame) << "Campaign index loaded:" << CampaignIndex::entries.size() << "entries";
+}
+
+void CampaignIndex::saveIndex()
+{
+    // Check if the index should be bypassed
+    if (LauncherOptions::isSet("no-campaign-index")) {
+        return;
+    }
+
+    // Create the entries
+    // Campaign files that do not exist anymore are dropped
+    QJsonObject entriesObject;
+    for (auto it = CampaignIndex::entries.constBegin(); it != CampaignIndex::entries.constEnd(); ++it) {
+        if (QFileInfo::exists(it.key())) {
+            entriesObject.insert(it.key(), CampaignIndex::entryToJson(it.value()));
+        }
+    }
+
+    QJsonObject indexObject;
+    indexObject["version"] = CAMPAIGN_INDEX_VERSION;
+    indexObject["entries"] = entriesObject;
+
+    // Write the index
+    QSaveFile indexFile(CampaignIndex::getIndexFilePath());
+    if (indexFile.open(QIODevice::WriteOnly) == false) {
+        qCWarning(logGame) << "Failed to open campaign index:" << indexFile.fileName();
+        return;
+    }
+    indexFile.write(QJsonDocument(indexObject).toJson(QJsonDocument::Compact));
+    if (indexFile.commit() == false) {
+        qCWarning(logGame) << "Failed to save campaign index:" << indexFile.fileName();
+    }
+}
+
+CampaignIndex::Entry CampaignIndex::parseFile(const QString &filePath)
+{
+    QFileInfo fileInfo(filePath);
+
+    CampaignIndex::Entry entry;
+    entry.filePath = fileInfo.absoluteFilePath();
+    entry.lastModified = fileInfo.lastModified();
+    entry.fileSize = fileInfo.size();
+
+    // Remember which sections have been found
+    // We stop reading the file once we are past all of them
+    bool hasCommon = false;
+    bool hasSpeech = false;
+    bool hasLandView = false;
+
+    IniReader::tokenizeFile(entry.filePath, [&](QByteArrayView section, QByteArrayView key, QByteArrayView value) {
+        if (section == "common") {
+            hasCommon = true;
+            if (key == "NAME") {
+                entry.name = QString::fromUtf8(value);
+            } else if (key == "SINGLE_LEVELS") {
+                entry.singleLevels = CampaignIndex::parseLevelList(value);
+            } else if (key == "MULTI_LEVELS") {
+                entry.multiLevels = CampaignIndex::parseLevelList(value);
+            }
+        } else if (section == "speech") {
+            // Every key in the speech section is a language
+            hasSpeech = true;
+            entry.speechLanguages << QString::fromUtf8(key);
+        } else if (section == "landview") {
+            hasLandView = true;
+            if (key == "LAND_VIEW_START") {
+                entry.landViewStart = QString::fromUtf8(value);
+            } else if (key == "LAND_VIEW_END") {
+                entry.landViewEnd = QString::fromUtf8(value);
+            }
+        } else if (hasCommon && hasSpeech && hasLandView) {
+            return false;
+        }
+
+        return true;
+    });
+
+    return entry;
+}
+
+QList<int> CampaignIndex::parseLevelList(QByteArrayView value)
+{
+    QList<int> levels;
+
+    // Levels are separated by spaces: '1 2 3 4'
+    for (const QByteArray &levelString : value.toByteArray().simplified().split(' ')) {
+        bool isNumber = false;
+        int level = levelString.toInt(&isNumber);
+        if (isNumber) {
+            levels << level;
+        }
+    }
+
+    return levels;
+}
+
+bool CampaignIndex::isEntryUpToDate(const CampaignIndex::Entry &entry, const QFileInfo &fileInfo)
+{
+    return entry.lastModified == fileInfo.lastModified() && entry.fileSize == fileInfo.size();
+}
+
+QJsonObject CampaignIndex::entryToJson(const CampaignIndex::Entry &entry)
+{
+    QJsonArray singleLevelsArray;
+    for (int level : entry.singleLevels) {
+        singleLevelsArray.append(level);
+    }
+
+    QJsonArray multiLevelsArray;
+    for (int level : entry.multiLevels) {
+        multiLevelsArray.append(level);
+    }
+
+    QJsonObject jsonObject;
+    jsonObject["last_modified"] = entry.lastModified.toMSecsSinceEpoch();
+    jsonObject["file_size"] = entry.fileSize;
+    jsonObject["name"] = entry.name;
+    jsonObject["single_levels"] = singleLevelsArray;
+    jsonObject["multi_levels"] = multiLevelsArray;
+    jsonObject["speech_languages"] = QJsonArray::fromStringList(entry.speechLanguages);
+    jsonObject["land_view_start"] = entry.landViewStart;
+    jsonObject["land_view_end"] = entry.landViewEnd;
+    return jsonObject;
+}
+
+CampaignIndex::Entry CampaignIndex::entryFromJson(const QString &filePath, const QJsonObject &jsonObject)
+{
+    CampaignIndex::Entry entry;
+    entry.filePath = filePath;
+    entry.lastModified = QDateTime::fromMSecsSinceEpoch(jsonObject["last_modified"].toInteger());
+    entry.fileSize = jsonObject["file_size"].toInteger();
+    entry.name = jsonObject["name"].toString();
+    entry.landViewStart = jsonObject["land_view_start"].toString();
+    entry.landViewEnd = jsonObject["land_view_end"].toString();
+
+    for (const QJsonValue &value : jsonObject["single_levels"].toArray()) {
+        entry.singleLevels << value.toInt();
+    }
+    for (const QJsonValue &value : jsonObject["multi_levels"].toArray()) {
+        entry.multiLevels << value.toInt();
+    }
+    for (const QJsonValue &value : jsonObject["speech_languages"].toArray()) {
+        entry.speechLanguages << value.toString();
+    }
+
+    return entry;
+}
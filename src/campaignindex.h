@@ -0,0 +1,48 @@
+#pragma once
+
+#include <QByteArrayView>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonObject>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+
+class CampaignIndex
+{
+public:
+    struct Entry
+    {
+        QString filePath;
+        QDateTime lastModified;
+        qint64 fileSize = 0;
+
+        QString name;
+        QList<int> singleLevels;
+        QList<int> multiLevels;
+        QStringList speechLanguages;
+        QString landViewStart;
+        QString landViewEnd;
+    };
+
+    static Entry getEntry(const QString &filePath);
+    static QList<Entry> getEntries(const QStringList &filePaths);
+
+private:
+    static QHash<QString, Entry> entries;
+    static QMutex entriesMutex;
+    static bool isIndexLoaded;
+
+    static QString getIndexFilePath();
+    static void loadIndex();
+    static void saveIndex();
+
+    static Entry parseFile(const QString &filePath);
+    static QList<int> parseLevelList(QByteArrayView value);
+    static bool isEntryUpToDate(const Entry &entry, const QFileInfo &fileInfo);
+
+    static QJsonObject entryToJson(const Entry &entry);
+    static Entry entryFromJson(const QString &filePath, const QJsonObject &jsonObject);
+};
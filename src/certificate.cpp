@@ -1,4 +1,5 @@
 #include "certificate.h"
+#include "logcategories.h"
 
 #include <QUrl>
 #include <QList>
@@ -28,9 +29,9 @@ void Certificate::loadAll()
         if (certFile.open(QIODevice::ReadOnly)) {
             QByteArray certData = certFile.readAll();
             certList.append(QSslCertificate(certData));
-            qDebug() << "Loaded certificate:" << certFilePath;
+            qCDebug(logUpdate) << "Loaded certificate:" << certFilePath;
         } else {
-            qWarning() << "Failed to open certificate:" << certFilePath;
+            qCWarning(logUpdate) << "Failed to open certificate:" << certFilePath;
             throw std::runtime_error("Failed to load certificates");
         }
     }
@@ -47,19 +48,19 @@ bool Certificate::verify(QFile &file)
 
     // Make sure we have a certificate to use for verification
     if (Certificate::certificateList.isEmpty()) {
-        qWarning() << "No certificates for verification";
+        qCWarning(logUpdate) << "No certificates for verification";
         return false;
     }
 
     // Get filepath
     QString filePath = file.fileName();
-    qDebug() << "Verifying:" << filePath;
+    qCDebug(logUpdate) << "Verifying:" << filePath;
 
     try {
 
         std::unique_ptr<LIEF::PE::Binary> binary = LIEF::PE::Parser::parse(filePath.toStdString());
         if (binary == nullptr) {
-            qWarning() << "Failed to parse PE file:" << filePath;
+            qCWarning(logUpdate) << "Failed to parse PE file:" << filePath;
             return false;
         }
 
@@ -77,7 +78,7 @@ bool Certificate::verify(QFile &file)
                     if (signedCertificate == cert) {
 
                         // Success
-                        qInfo() << "Certificate verified successfully:" << filePath;
+                        qCInfo(logUpdate) << "Certificate verified successfully:" << filePath;
                         return true;
                     }
                 }
@@ -85,11 +86,11 @@ bool Certificate::verify(QFile &file)
         }
 
         // Fail
-        qWarning() << "No matching certificate found:" << filePath;
+        qCWarning(logUpdate) << "No matching certificate found:" << filePath;
         return false;
 
     } catch (const std::exception &e) {
-        qWarning() << "Exception occurred while verifying PE file:" << e.what();
+        qCWarning(logUpdate) << "Exception occurred while verifying PE file:" << e.what();
         return false;
     }
 }
@@ -3,17 +3,32 @@
 
 #include "apiclient.h"
 #include "archiver.h"
+#include "crashsymbolizer.h"
 #include "gzip.h"
 #include "savefile.h"
 #include "version.h"
 #include "settings.h"
 #include "launcheroptions.h"
+#include "taskscheduler.h"
 
 #include <QDir>
+#include <QFutureWatcher>
+#include <QJsonArray>
 #include <QMessageBox>
+#include <QTemporaryFile>
 
 #define COMPRESS_KEEPERFX_LOG_GZIP true
 
+// Bigger logs are cut down to their start and their end
+#define MAX_KEEPERFX_LOG_SIZE (32 * 1024LL * 1024LL)
+#define KEEPERFX_LOG_HEAD_SIZE (1024LL * 1024LL)
+
+// Amount of the log that is processed at once when writing the report
+#define CRASH_LOG_CHUNK_SIZE (1024LL * 1024LL)
+
+// Amount of the end of the log that is searched for the backtrace
+#define CRASH_LOG_BACKTRACE_TAIL_SIZE (256LL * 1024LL)
+
 CrashDialog::CrashDialog(QWidget *parent)
     : QDialog(parent)
     , ui(new Ui::CrashDialog)
@@ -47,10 +62,51 @@ CrashDialog::CrashDialog(QWidget *parent)
     ui->contactInfoDiscordLineEdit->setText(Settings::getLauncherSetting("CRASH_REPORTING_CONTACT_DISCORD").toString());
     ui->contactInfoKfxNetLineEdit->setText(Settings::getLauncherSetting("CRASH_REPORTING_CONTACT_KEEPERFX_NET").toString());
     ui->contactInfoEmailLineEdit->setText(Settings::getLauncherSetting("CRASH_REPORTING_CONTACT_EMAIL").toString());
+
+    // Load the symbols and show the symbolized backtrace in our own log
+    // This way the symbols are ready by the time the report is sent
+    QString logFilePath = QCoreApplication::applicationDirPath() + "/keeperfx.log";
+    QString mapFilePath = CrashSymbolizer::getMapFilePath();
+    backtraceFuture = TaskScheduler::run(TaskScheduler::Pool::IO, [logFilePath, mapFilePath]() {
+        QFile logFile(logFilePath);
+        if (QFile::exists(mapFilePath) == false || logFile.open(QIODevice::ReadOnly) == false) {
+            return;
+        }
+
+        // The backtrace is at the end of the log
+        logFile.seek(qMax(0LL, logFile.size() - CRASH_LOG_BACKTRACE_TAIL_SIZE));
+        QByteArray logTail = logFile.readAll();
+        logTail.remove(0, logTail.indexOf('\n') + 1);
+
+        for (const QByteArray &line : CrashSymbolizer::symbolizeLog(logTail, mapFilePath).split('\n')) {
+            if (line.trimmed().startsWith("[#")) {
+                qInfo().noquote() << "Game backtrace:" << QString::fromUtf8(line.trimmed());
+            }
+        }
+    });
 }
 
 CrashDialog::~CrashDialog()
 {
+    // Stop an upload that is still running
+    // Deleting the reply also closes the body file it is sending
+    if (uploadReply != nullptr) {
+        uploadReply->disconnect(this);
+        uploadReply->abort();
+        delete uploadReply;
+        uploadReply = nullptr;
+    }
+
+    // Stop writing the request body
+    // It checks the cancellation between chunks so this does not take long
+    reportBodyCancellation.cancel();
+    reportBodyFuture.waitForFinished();
+
+    // Remove the temporary body
+    if (reportBodyFilePath.isEmpty() == false) {
+        QFile::remove(reportBodyFilePath);
+    }
+
     delete ui;
 }
 
@@ -61,6 +117,11 @@ void CrashDialog::setStdErrorString(QString stdError)
 
 void CrashDialog::on_cancelButton_clicked()
 {
+    // Stop the upload
+    if (uploadReply != nullptr) {
+        uploadReply->abort();
+    }
+
     this->close();
 }
 
@@ -68,6 +129,7 @@ void CrashDialog::on_sendButton_clicked()
 {
     // Disable the send button
     this->ui->sendButton->setDisabled(true);
+    this->ui->sendButton->setText(tr("Preparing...", "Button"));
 
     // Create post object
     QJsonObject jsonPostObject;
@@ -124,118 +186,342 @@ void CrashDialog::on_sendButton_clicked()
         kfxConfigFile.close();
     }
 
-    // keeperfx.log
-    QFile kfxLogFile(QCoreApplication::applicationDirPath() + "/keeperfx.log");
-    if (kfxLogFile.exists() && kfxLogFile.open(QIODevice::ReadOnly)) {
+    // Game std output
+    if (this->stdErrorString.isEmpty() == false) {
+        jsonPostObject["game_output"] = this->stdErrorString;
+    }
+
+    // Savefile
+    QString saveFilePath;
+    QString saveFileName;
+    int saveFileIndex = ui->saveFileComboBox->currentIndex();
+    if (saveFileIndex > 0) { // -1 = nothing selected, 0 = "None"
+        SaveFile *saveFile = saveFileList.at(saveFileIndex - 1);
+        if (saveFile) {
+            saveFilePath = saveFile->file.fileName();
+            saveFileName = saveFile->fileName + ".7z";
+        }
+    }
 
-        // Check if logfile is reasonable size (<32MiB)
-        if (kfxLogFile.size() > 32 * 1024LL * 1024LL) {
+    // Check if the log should be compressed
+    bool isGzipEnabled = COMPRESS_KEEPERFX_LOG_GZIP;
+    if (LauncherOptions::isSet("disable-gzip-upload") == true) {
+        qDebug() << "--disable-gzip set, sending plain text log";
+        isGzipEnabled = false;
+    }
+
+    // Write the request body to a temporary file in the background
+    // The log and the savefile are streamed into it so they are never fully in memory
+    QString logFilePath = QCoreApplication::applicationDirPath() + "/keeperfx.log";
+    QString mapFilePath = CrashSymbolizer::getMapFilePath();
+    // Every report gets its own file so reports of multiple launchers do not collide
+    QTemporaryFile bodyTemporaryFile(QDir::temp().filePath("crashreport-body-XXXXXX.json"));
+    bodyTemporaryFile.setAutoRemove(false);
+    if (bodyTemporaryFile.open() == false) {
+        qWarning() << "Failed to create crash report body:" << bodyTemporaryFile.errorString();
+        QMessageBox::warning(this, tr("Crash Report", "MessageBox Title"), tr("Failed to submit crash report.", "MessageBox Text"));
+        this->close();
+        return;
+    }
+    QString bodyFilePath = bodyTemporaryFile.fileName();
+    bodyTemporaryFile.close();
+    reportBodyFilePath = bodyFilePath;
+
+    QFutureWatcher<bool> *watcher = new QFutureWatcher<bool>(this);
+    connect(watcher, &QFutureWatcher<bool>::finished, this, [this, watcher, bodyFilePath]() {
+        watcher->deleteLater();
+
+        if (watcher->result() == false) {
             QMessageBox::warning(this, tr("Crash Report", "MessageBox Title"), tr("Failed to submit crash report.", "MessageBox Text"));
-            qWarning() << "Log file too big to be sent with crash report:" << kfxLogFile.fileName() << "Size:" << kfxLogFile.size();
+            QFile::remove(bodyFilePath);
             this->close();
             return;
         }
 
-        // Read logfile
-        QByteArray logData = kfxLogFile.readAll();
-        kfxLogFile.close();
-
-#if COMPRESS_KEEPERFX_LOG_GZIP
+        uploadReport(bodyFilePath);
+    });
+    reportBodyFuture = TaskScheduler::run(TaskScheduler::Pool::IO, &CrashDialog::writeReportBody, jsonPostObject, logFilePath, mapFilePath, isGzipEnabled, saveFilePath, saveFileName, bodyFilePath, reportBodyCancellation);
+    watcher->setFuture(reportBodyFuture);
+}
 
-        // Check command line override
-        if (LauncherOptions::isSet("disable-gzip-upload") != true) {
+QByteArray CrashDialog::toJsonString(const QString &string)
+{
+    // Let Qt handle the escaping: '["string"]' -> '"string"'
+    QByteArray json = QJsonDocument(QJsonArray{string}).toJson(QJsonDocument::Compact);
+    return json.mid(1, json.size() - 2);
+}
 
-            // Compress using gzip
-            QByteArray gzipped = GZip::compress(logData);
+void CrashDialog::readLogLines(QFile &logFile, qint64 start, qint64 end, const std::function<bool(const QByteArray &)> &callback)
+{
+    logFile.seek(start);
+
+    // Lines are only passed on when they are complete
+    // A line that is cut off by the start or the end of the range is dropped
+    QByteArray carry;
+    bool isSkippingFirstLine = start > 0;
+    qint64 pos = start;
+    while (pos < end) {
+        QByteArray chunk = logFile.read(qMin(CRASH_LOG_CHUNK_SIZE, end - pos));
+        if (chunk.isEmpty()) {
+            break;
+        }
+        pos += chunk.size();
 
-            if (!gzipped.isEmpty()) {
-                jsonPostObject["game_log"] = QString(gzipped.toBase64());
-                jsonPostObject["game_log_encoding"] = "gzip+base64";
-            } else {
-                qDebug() << "GZip::Compress failed, sending plain text log";
-                jsonPostObject["game_log"] = QString(logData);
+        if (isSkippingFirstLine) {
+            qsizetype newline = chunk.indexOf('\n');
+            if (newline == -1) {
+                continue;
             }
+            chunk.remove(0, newline + 1);
+            isSkippingFirstLine = false;
+        }
 
-        } else {
-            qDebug() << "--disable-gzip set, sending plain text log";
-            jsonPostObject["game_log"] = QString(logData);
+        carry.append(chunk);
+        qsizetype lastNewline = carry.lastIndexOf('\n');
+        if (lastNewline == -1) {
+            continue;
+        }
+
+        if (callback(carry.first(lastNewline + 1)) == false) {
+            return;
         }
-#else
-        // gzip disabled at compile time
-        jsonPostObject["game_log"] = QString(logData);
-#endif
+        carry.remove(0, lastNewline + 1);
     }
 
-    // Game std output
-    if (this->stdErrorString.isEmpty() == false) {
-        jsonPostObject["game_output"] = this->stdErrorString;
+    // The last line of the file does not need a newline
+    if (end == logFile.size() && carry.isEmpty() == false) {
+        callback(carry);
     }
+}
 
-    // Savefile
-    int saveFileIndex = ui->saveFileComboBox->currentIndex();
-    if (saveFileIndex > 0) { // -1 = nothing selected, 0 = "None"
+bool CrashDialog::writeReportBody(QJsonObject jsonPostObject,
+                                  QString logFilePath,
+                                  QString mapFilePath,
+                                  bool isGzipEnabled,
+                                  QString saveFilePath,
+                                  QString saveFileName,
+                                  QString bodyFilePath,
+                                  CancellationToken cancellation)
+{
+    if (cancellation.isCanceled()) {
+        return false;
+    }
 
-        // Get selected savefile
-        SaveFile *saveFile = saveFileList.at(saveFileIndex - 1);
-        if (saveFile) {
-            // Variables for temporary archive for savefile
-            QString tempArchivePath = QDir::temp().filePath("crashreport-savefile.7z.tmp");
-            QFile tempArchive(tempArchivePath);
+    QFile bodyFile(bodyFilePath);
+    if (bodyFile.open(QIODevice::WriteOnly | QIODevice::Truncate) == false) {
+        qWarning() << "Failed to open crash report body:" << bodyFilePath;
+        return false;
+    }
+
+    // Start with the small fields
+    // The closing bracket is added once the big fields are written
+    QByteArray fieldsJson = QJsonDocument(jsonPostObject).toJson(QJsonDocument::Compact);
+    fieldsJson.chop(1);
+    bodyFile.write(fieldsJson);
+    bool isFirstField = jsonPostObject.isEmpty();
+
+    auto writeFieldName = [&](const char *name) {
+        bodyFile.write(isFirstField ? "\"" : ",\"");
+        bodyFile.write(name);
+        bodyFile.write("\":");
+        isFirstField = false;
+    };
+
+    // Base64 encodes a stream in parts of 3 bytes so the parts can be joined
+    QByteArray base64Carry;
+    auto writeBase64 = [&](QByteArrayView data, bool isLast) {
+        base64Carry.append(data);
+        qsizetype size = isLast ? base64Carry.size() : base64Carry.size() - (base64Carry.size() % 3);
+        bodyFile.write(base64Carry.first(size).toBase64());
+        base64Carry.remove(0, size);
+    };
+
+    // keeperfx.log
+    QFile logFile(logFilePath);
+    if (logFile.exists() && logFile.open(QIODevice::ReadOnly)) {
+        qint64 logSize = logFile.size();
+
+        // Only symbolize when there is a map
+        if (QFile::exists(mapFilePath) == false) {
+            mapFilePath.clear();
+        }
+
+        // Use a level that does not keep the user waiting on big logs
+        // The log is compressed per chunk so only the blocks of one chunk run in parallel
+        GZip::StreamCompressor compressor(GZip::chooseCompressionLevel(qMin<qint64>(logSize, MAX_KEEPERFX_LOG_SIZE), GZIP_DEFAULT_TIME_BUDGET_MS, CRASH_LOG_CHUNK_SIZE));
+        if (isGzipEnabled && compressor.isValid() == false) {
+            qDebug() << "GZip compression failed, sending plain text log";
+            isGzipEnabled = false;
+        }
 
-            // Make sure archive output file does not exist
-            if (tempArchive.exists()) {
-                tempArchive.remove();
+        writeFieldName("game_log");
+        bodyFile.write("\"");
+
+        qint64 compressedSize = 0;
+        auto writeLogData = [&](const QByteArray &data) {
+            if (cancellation.isCanceled()) {
+                return false;
+            }
+
+            QByteArray logData = mapFilePath.isEmpty() ? data : CrashSymbolizer::symbolizeLog(data, mapFilePath);
+            if (isGzipEnabled) {
+                QByteArray compressed = compressor.compress(logData);
+                compressedSize += compressed.size();
+                writeBase64(compressed, false);
+                return compressor.isValid();
             }
 
-            // Compress the save into the archive
-            if (Archiver::compressSingleFile(&saveFile->file, tempArchivePath.toStdString())) {
-                // Make sure archive exists and can be opened
-                if (tempArchive.exists() && tempArchive.open(QIODevice::ReadOnly)) {
-                    // Add savefile data to post object
-                    jsonPostObject["save_file_name"] = saveFile->fileName + ".7z";
-                    jsonPostObject["save_file_data"] = QString(tempArchive.readAll().toBase64());
-                    tempArchive.close();
-                    tempArchive.remove();
-                }
-            } else {
-                qDebug() << "Failed to create temporary savefile archive";
+            // Plain text without the surrounding quotes
+            QByteArray jsonString = toJsonString(QString::fromUtf8(logData));
+            bodyFile.write(jsonString.mid(1, jsonString.size() - 2));
+            return true;
+        };
+
+        if (logSize <= MAX_KEEPERFX_LOG_SIZE) {
+            readLogLines(logFile, 0, logSize, writeLogData);
+        } else {
+            // Keep the start of the log with the system information and the end with the crash
+            qint64 tailStart = logSize - (MAX_KEEPERFX_LOG_SIZE - KEEPERFX_LOG_HEAD_SIZE);
+            qWarning() << "Log file too big to be sent completely:" << logFilePath << "Size:" << logSize;
+
+            readLogLines(logFile, 0, KEEPERFX_LOG_HEAD_SIZE, writeLogData);
+            writeLogData(QString("\n[... %1 bytes of the log were left out by the launcher ...]\n\n").arg(tailStart - KEEPERFX_LOG_HEAD_SIZE).toUtf8());
+            readLogLines(logFile, tailStart, logSize, writeLogData);
+        }
+
+        if (isGzipEnabled) {
+            QByteArray compressed = compressor.finish();
+            compressedSize += compressed.size();
+            writeBase64(compressed, true);
+
+            if (compressor.isValid() == false) {
+                qWarning() << "GZip compression of the game log failed";
+                return false;
             }
+
+            qDebug() << "Game log compressed:" << logSize << "->" << compressedSize << "bytes";
+        }
+
+        bodyFile.write("\"");
+
+        if (cancellation.isCanceled()) {
+            return false;
+        }
+
+        if (isGzipEnabled) {
+            writeFieldName("game_log_encoding");
+            bodyFile.write("\"gzip+base64\"");
         }
     }
 
-    // Make request
-    QJsonDocument jsonDoc = ApiClient::getJsonResponse(QUrl("v1/crash-report"),
-                                                       ApiClient::HttpMethod::POST,
-                                                       jsonPostObject);
+    // Savefile
+    if (saveFilePath.isEmpty() == false && cancellation.isCanceled() == false) {
+        // Compress the save into memory
+        QFile saveFile(saveFilePath);
+        std::vector<bit7z::byte_t> archiveBuffer;
+        if (Archiver::compressSingleFileToMemory(&saveFile, archiveBuffer)) {
+            // Add savefile data to the body
+            QByteArrayView archiveData(reinterpret_cast<const char *>(archiveBuffer.data()), static_cast<qsizetype>(archiveBuffer.size()));
+            writeFieldName("save_file_name");
+            bodyFile.write(toJsonString(saveFileName));
+            writeFieldName("save_file_data");
+            bodyFile.write("\"");
+            for (qsizetype pos = 0; pos < archiveData.size(); pos += CRASH_LOG_CHUNK_SIZE) {
+                writeBase64(archiveData.sliced(pos, qMin<qsizetype>(CRASH_LOG_CHUNK_SIZE, archiveData.size() - pos)), false);
+            }
+            writeBase64(QByteArrayView(), true);
+            bodyFile.write("\"");
+        } else {
+            qDebug() << "Failed to compress savefile";
+        }
+    }
 
-    // Make sure response is an object
-    if (jsonDoc.isObject() == false) {
-        this->close();
-        return;
+    if (cancellation.isCanceled()) {
+        return false;
     }
 
-    // Get object
-    QJsonObject jsonObj = jsonDoc.object();
+    bodyFile.write("}");
+    bodyFile.close();
 
-    // Make sure response was succesful
-    bool success = jsonObj["success"].toBool();
-    if (!success) {
-        QMessageBox::warning(this, tr("Crash Report", "MessageBox Title"), tr("Failed to submit crash report.", "MessageBox Text"));
-        qWarning() << "Crash Report API response:" << jsonObj["error"].toString();
+    if (bodyFile.error() != QFileDevice::NoError) {
+        qWarning() << "Failed to write crash report body:" << bodyFile.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+void CrashDialog::uploadReport(const QString &bodyFilePath)
+{
+    QFile *bodyFile = new QFile(bodyFilePath);
+    if (bodyFile->open(QIODevice::ReadOnly) == false) {
+        qWarning() << "Failed to open crash report body:" << bodyFilePath;
+        delete bodyFile;
         this->close();
         return;
     }
 
-    // Show success and the report ID number
-    QMessageBox::information(this,
-                             tr("Crash Report", "MessageBox Title"),
-                             tr("Your crash report has been successfully submitted!\n\n"
-                                "The KeeperFX team can not guarantee immediate results, "
-                                "but your feedback is very helpful for the developers working on KeeperFX.\n\n"
-                                "Report ID: %1",
-                                "MessageBox Text")
-                                 .arg(QString::number(jsonObj["id"].toInt())));
+    // Make request
+    // The body is read from the file while it is being sent
+    uploadReply = ApiClient::postJson(&networkManager, QUrl("v1/crash-report"), bodyFile);
+    bodyFile->setParent(uploadReply);
+
+    connect(uploadReply, &QNetworkReply::uploadProgress, this, [this](qint64 bytesSent, qint64 bytesTotal) {
+        if (bytesTotal > 0) {
+            ui->sendButton->setText(tr("Sending... %1%", "Button").arg(bytesSent * 100 / bytesTotal));
+        }
+    });
+
+    connect(uploadReply, &QNetworkReply::finished, this, [this, bodyFile, bodyFilePath]() {
+        QNetworkReply *reply = uploadReply;
+        uploadReply = nullptr;
+        reply->deleteLater();
+
+        // Remove the temporary body
+        bodyFile->close();
+        QFile::remove(bodyFilePath);
+
+        // The user canceled the upload
+        if (reply->error() == QNetworkReply::OperationCanceledError) {
+            return;
+        }
+
+        if (reply->error() != QNetworkReply::NoError) {
+            qWarning() << "Crash Report upload failed:" << reply->errorString();
+            this->close();
+            return;
+        }
+
+        // Make sure response is an object
+        QJsonDocument jsonDoc = QJsonDocument::fromJson(reply->readAll());
+        if (jsonDoc.isObject() == false) {
+            this->close();
+            return;
+        }
+
+        // Get object
+        QJsonObject jsonObj = jsonDoc.object();
+
+        // Make sure response was succesful
+        bool success = jsonObj["success"].toBool();
+        if (!success) {
+            QMessageBox::warning(this, tr("Crash Report", "MessageBox Title"), tr("Failed to submit crash report.", "MessageBox Text"));
+            qWarning() << "Crash Report API response:" << jsonObj["error"].toString();
+            this->close();
+            return;
+        }
 
-    // Accept crash dialog (close it)
-    this->accept();
+        // Show success and the report ID number
+        QMessageBox::information(this,
+                                 tr("Crash Report", "MessageBox Title"),
+                                 tr("Your crash report has been successfully submitted!\n\n"
+                                    "The KeeperFX team can not guarantee immediate results, "
+                                    "but your feedback is very helpful for the developers working on KeeperFX.\n\n"
+                                    "Report ID: %1",
+                                    "MessageBox Text")
+                                     .arg(QString::number(jsonObj["id"].toInt())));
+
+        // Accept crash dialog (close it)
+        this->accept();
+    });
 }
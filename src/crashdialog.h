@@ -1,8 +1,16 @@
 #pragma once
 
 #include "savefile.h"
+#include "taskscheduler.h"
 
 #include <QDialog>
+#include <QFile>
+#include <QFuture>
+#include <QJsonObject>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+
+#include <functional>
 
 namespace Ui {
 class CrashDialog;
@@ -26,4 +34,29 @@ private:
     Ui::CrashDialog *ui;
     QList<SaveFile *> saveFileList;
     QString stdErrorString;
+
+    // Logs the symbolized backtrace while the user fills in the dialog
+    QFuture<void> backtraceFuture;
+
+    // Writes the request body to a temporary file
+    // Closing the dialog cancels it and removes the file
+    QFuture<bool> reportBodyFuture;
+    CancellationToken reportBodyCancellation;
+    QString reportBodyFilePath;
+
+    QNetworkAccessManager networkManager;
+    QNetworkReply *uploadReply = nullptr;
+
+    static QByteArray toJsonString(const QString &string);
+    static void readLogLines(QFile &logFile, qint64 start, qint64 end, const std::function<bool(const QByteArray &)> &callback);
+    static bool writeReportBody(QJsonObject jsonPostObject,
+                                QString logFilePath,
+                                QString mapFilePath,
+                                bool isGzipEnabled,
+                                QString saveFilePath,
+                                QString saveFileName,
+                                QString bodyFilePath,
+                                CancellationToken cancellation);
+
+    void uploadReport(const QString &bodyFilePath);
 };
@@ -0,0 +1,291 @@
+#include "crashsymbolizer.h"
+
+#include "settings.h"
+
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QSaveFile>
+
+#include <algorithm>
+#include <cstring>
+
+#define CRASH_SYMBOLS_CACHE_VERSION 1
+
+QString CrashSymbolizer::loadedMapFilePath;
+CrashSymbolizer::SymbolTable CrashSymbolizer::loadedTable;
+QMutex CrashSymbolizer::loadedTableMutex;
+
+QString CrashSymbolizer::getMapFilePath()
+{
+    if (Settings::getLauncherSetting("GAME_HEAVY_LOG_ENABLED").toBool() == true) {
+        return QCoreApplication::applicationDirPath() + "/keeperfx_hvlog.map";
+    }
+
+    return QCoreApplication::applicationDirPath() + "/keeperfx.map";
+}
+
+QString CrashSymbolizer::getCacheFilePath(const QString &mapFilePath)
+{
+    // Every install has its own map so the path is part of the cache name
+    return QDir::temp().filePath(QString("kfx-launcher-symbols-%1.bin").arg(qHash(QFileInfo(mapFilePath).absoluteFilePath()), 0, 16));
+}
+
+bool CrashSymbolizer::loadCache(const QString &mapFilePath, SymbolTable &table)
+{
+    QFile cacheFile(getCacheFilePath(mapFilePath));
+    if (cacheFile.open(QIODevice::ReadOnly) == false) {
+        return false;
+    }
+
+    QDataStream stream(&cacheFile);
+    int version = 0;
+    stream >> version;
+    if (version != CRASH_SYMBOLS_CACHE_VERSION) {
+        return false;
+    }
+
+    // Make sure the cache belongs to the current map file
+    QFileInfo mapFileInfo(mapFilePath);
+    stream >> table.lastModified >> table.fileSize;
+    if (table.lastModified != mapFileInfo.lastModified() || table.fileSize != mapFileInfo.size()) {
+        return false;
+    }
+
+    stream >> table.textStart >> table.textEnd >> table.addresses >> table.nameOffsets >> table.names;
+
+    return stream.status() == QDataStream::Ok && table.addresses.size() == table.nameOffsets.size();
+}
+
+void CrashSymbolizer::saveCache(const QString &mapFilePath, const SymbolTable &table)
+{
+    QSaveFile cacheFile(getCacheFilePath(mapFilePath));
+    if (cacheFile.open(QIODevice::WriteOnly) == false) {
+        qWarning() << "Failed to open symbol cache:" << cacheFile.fileName();
+        return;
+    }
+
+    QDataStream stream(&cacheFile);
+    stream << int(CRASH_SYMBOLS_CACHE_VERSION);
+    stream << table.lastModified << table.fileSize;
+    stream << table.textStart << table.textEnd << table.addresses << table.nameOffsets << table.names;
+
+    if (cacheFile.commit() == false) {
+        qWarning() << "Failed to save symbol cache:" << cacheFile.fileName();
+    }
+}
+
+CrashSymbolizer::SymbolTable CrashSymbolizer::parseMapFile(const QString &mapFilePath)
+{
+    SymbolTable table;
+
+    QFile mapFile(mapFilePath);
+    if (mapFile.open(QIODevice::ReadOnly) == false) {
+        qWarning() << "Failed to open map file:" << mapFilePath;
+        return table;
+    }
+
+    QFileInfo mapFileInfo(mapFilePath);
+    table.lastModified = mapFileInfo.lastModified();
+    table.fileSize = mapFileInfo.size();
+
+    // Read the map file
+    // It is only parsed once so we do not bother mapping it
+    QByteArray mapData = mapFile.readAll();
+    const char *pos = mapData.constData();
+    const char *end = pos + mapData.size();
+
+    // Symbols with their address
+    QList<QPair<quint32, QByteArrayView>> symbols;
+
+    while (pos < end) {
+        // Get the current line
+        const char *newline = static_cast<const char *>(std::memchr(pos, '\n', end - pos));
+        const char *lineEnd = newline ? newline : end;
+        QByteArrayView line(pos, lineEnd - pos);
+        pos = newline ? newline + 1 : end;
+
+        // The output section of the code: '.text  0x00401000  0x2d1000'
+        if (line.startsWith(".text ")) {
+            QList<QByteArray> parts = line.toByteArray().simplified().split(' ');
+            if (parts.size() >= 3) {
+                bool isAddress = false;
+                bool isSize = false;
+                quint32 address = parts.at(1).toUInt(&isAddress, 16);
+                quint32 size = parts.at(2).toUInt(&isSize, 16);
+                if (isAddress && isSize) {
+                    table.textStart = address;
+                    table.textEnd = address + size;
+                }
+            }
+            continue;
+        }
+
+        // Symbol lines only have an address and a name: '   0x00401000   _main'
+        line = line.trimmed();
+        if (line.startsWith("0x") == false) {
+            continue;
+        }
+
+        const char *space = static_cast<const char *>(std::memchr(line.data(), ' ', line.size()));
+        if (space == nullptr) {
+            continue;
+        }
+        QByteArrayView addressString = line.first(space - line.data());
+        QByteArrayView name = line.sliced(addressString.size()).trimmed();
+
+        // Skip object files, assignments and linker statements
+        if (name.isEmpty() || name.contains(' ') || name.contains('=') || name.front() == '.' || name.front() == '*' || name.front() == '(') {
+            continue;
+        }
+
+        bool isAddress = false;
+        quint32 address = addressString.toByteArray().toUInt(&isAddress, 16);
+        if (isAddress == false || address == 0) {
+            continue;
+        }
+
+        symbols.append({address, name});
+    }
+
+    // Sort the symbols on address
+    std::stable_sort(symbols.begin(), symbols.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+
+    // Build the table
+    // Only the first name of an address is kept
+    table.addresses.reserve(symbols.size());
+    table.nameOffsets.reserve(symbols.size());
+    for (const auto &symbol : std::as_const(symbols)) {
+        if (table.addresses.isEmpty() == false && table.addresses.last() == symbol.first) {
+            continue;
+        }
+        table.addresses << symbol.first;
+        table.nameOffsets << static_cast<quint32>(table.names.size());
+        table.names.append(symbol.second);
+        table.names.append('\0');
+    }
+
+    return table;
+}
+
+CrashSymbolizer::SymbolTable CrashSymbolizer::loadSymbolTable(const QString &mapFilePath)
+{
+    QMutexLocker locker(&loadedTableMutex);
+
+    // Use the table in memory when the map file did not change
+    QFileInfo mapFileInfo(mapFilePath);
+    if (loadedMapFilePath == mapFilePath && loadedTable.lastModified == mapFileInfo.lastModified() && loadedTable.fileSize == mapFileInfo.size()) {
+        return loadedTable;
+    }
+
+    SymbolTable table;
+
+    // Use the cached table on disk when the map file did not change
+    if (loadCache(mapFilePath, table) == false) {
+        QElapsedTimer timer;
+        timer.start();
+
+        table = parseMapFile(mapFilePath);
+        if (table.addresses.isEmpty()) {
+            return table;
+        }
+
+        qDebug() << "Symbol table parsed:" << table.addresses.size() << "symbols in" << timer.elapsed() << "ms";
+
+        saveCache(mapFilePath, table);
+    }
+
+    loadedMapFilePath = mapFilePath;
+    loadedTable = table;
+    return table;
+}
+
+QByteArray CrashSymbolizer::lookup(const SymbolTable &table, quint32 address)
+{
+    // Only addresses in the code of the game can be symbolized
+    if (table.textEnd > table.textStart && (address < table.textStart || address >= table.textEnd)) {
+        return QByteArray();
+    }
+
+    // Find the last symbol at or before the address
+    auto it = std::upper_bound(table.addresses.constBegin(), table.addresses.constEnd(), address);
+    if (it == table.addresses.constBegin()) {
+        return QByteArray();
+    }
+    --it;
+
+    qsizetype index = it - table.addresses.constBegin();
+    QByteArray name(table.names.constData() + table.nameOffsets.at(index));
+
+    return name + "+0x" + QByteArray::number(address - *it, 16);
+}
+
+QByteArray CrashSymbolizer::symbolizeLog(const QByteArray &logData, const QString &mapFilePath)
+{
+    if (QFile::exists(mapFilePath) == false) {
+        qDebug() << "No map file found for symbolization:" << mapFilePath;
+        return logData;
+    }
+
+    SymbolTable table = loadSymbolTable(mapFilePath);
+    if (table.addresses.isEmpty()) {
+        return logData;
+    }
+
+    // Addresses in a backtrace line: '0x45a3b0' or '0045a3b0'
+    static const QRegularExpression addressRegex("\\b(?:0x([0-9A-Fa-f]{1,8})|([0-9A-Fa-f]{8}))\\b");
+
+    QByteArray output;
+    output.reserve(logData.size() + 4096);
+
+    int symbolizedCount = 0;
+    qsizetype pos = 0;
+    while (pos < logData.size()) {
+        qsizetype newline = logData.indexOf('\n', pos);
+        qsizetype lineEnd = newline == -1 ? logData.size() : newline;
+        QByteArrayView line(logData.constData() + pos, lineEnd - pos);
+        pos = lineEnd + 1;
+
+        output.append(line);
+
+        // Only the lines of the backtrace are symbolized: '[#0]  in keeperfx.exe at ...'
+        if (line.trimmed().startsWith("[#")) {
+            QStringList symbols;
+            QRegularExpressionMatchIterator it = addressRegex.globalMatch(QString::fromLatin1(line));
+            while (it.hasNext()) {
+                QRegularExpressionMatch match = it.next();
+                QString addressString = match.captured(1).isEmpty() ? match.captured(2) : match.captured(1);
+                QByteArray symbol = lookup(table, addressString.toUInt(nullptr, 16));
+                if (symbol.isEmpty() == false && line.contains(symbol.first(symbol.indexOf('+'))) == false) {
+                    symbols << QString::fromUtf8(symbol);
+                }
+            }
+
+            if (symbols.isEmpty() == false) {
+                // Keep a trailing carriage return at the end of the line
+                if (output.endsWith('\r')) {
+                    output.chop(1);
+                    output.append("  <" + symbols.join(", ").toUtf8() + ">\r");
+                } else {
+                    output.append("  <" + symbols.join(", ").toUtf8() + ">");
+                }
+                symbolizedCount++;
+            }
+        }
+
+        if (newline != -1) {
+            output.append('\n');
+        }
+    }
+
+    if (symbolizedCount > 0) {
+        qDebug() << "Symbolized" << symbolizedCount << "backtrace line(s) using" << QFileInfo(mapFilePath).fileName();
+    }
+
+    return output;
+}
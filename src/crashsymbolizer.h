@@ -0,0 +1,50 @@
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QDateTime>
+#include <QList>
+#include <QMutex>
+#include <QString>
+
+// Adds the names of the game functions to the crash addresses in the game log
+// The symbols come from the linker map that is shipped next to the game binaries
+class CrashSymbolizer
+{
+public:
+    // Path of the map file that belongs to the binary the game was started with
+    static QString getMapFilePath();
+
+    // Returns the log with symbol names added to the lines of the backtrace
+    // The log can be passed in parts as long as they end on a full line
+    static QByteArray symbolizeLog(const QByteArray &logData, const QString &mapFilePath);
+
+private:
+    // Sorted address to symbol table
+    // The names are stored in a single blob to keep the table compact
+    struct SymbolTable
+    {
+        QDateTime lastModified;
+        qint64 fileSize = 0;
+
+        quint32 textStart = 0;
+        quint32 textEnd = 0;
+        QList<quint32> addresses;
+        QList<quint32> nameOffsets;
+        QByteArray names;
+    };
+
+    // The last loaded table so symbolizing a log in parts only loads it once
+    static QString loadedMapFilePath;
+    static SymbolTable loadedTable;
+    static QMutex loadedTableMutex;
+
+    static SymbolTable loadSymbolTable(const QString &mapFilePath);
+    static SymbolTable parseMapFile(const QString &mapFilePath);
+
+    static QString getCacheFilePath(const QString &mapFilePath);
+    static bool loadCache(const QString &mapFilePath, SymbolTable &table);
+    static void saveCache(const QString &mapFilePath, const SymbolTable &table);
+
+    static QByteArray lookup(const SymbolTable &table, quint32 address);
+};
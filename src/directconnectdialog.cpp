@@ -1,5 +1,6 @@
 #include "directconnectdialog.h"
 #include "ui_directconnectdialog.h"
+#include "logcategories.h"
 
 #include <QAbstractSocket>
 #include <QHostAddress>
@@ -7,11 +8,24 @@
 #include <QRegularExpression>
 #include <QRegularExpressionValidator>
 
+#include "enetprotocol.h"
 #include "kfxversion.h"
 
+// Delay between the probes to the addresses of a host
+#define RACE_PROBE_DELAY_MS 100
+
+// Time to wait for a reply after the last probe
+#define RACE_TIMEOUT_MS 1500
+
+// Time the measured RTT is shown before the game starts
+#define RACE_RESULT_SHOW_MS 500
+
 DirectConnectDialog::DirectConnectDialog(QWidget *parent)
     : QDialog(parent)
     , ui(new Ui::DirectConnectDialog)
+    , raceSocket(new QUdpSocket(this))
+    , raceProbeTimer(new QTimer(this))
+    , raceTimeoutTimer(new QTimer(this))
 {
     ui->setupUi(this);
 
@@ -23,16 +37,25 @@ DirectConnectDialog::DirectConnectDialog(QWidget *parent)
     // Port validator: allows only numbers (0-65535)
     ui->portLineEdit->setValidator(new QIntValidator(0, 65535, this));
 
-    // IP validator: allows IPv4 characters, and IPv6 characters if KeeperFX has that functionality
+    // Host validator: allows hostname and IPv4 characters, and IPv6 characters if KeeperFX has that functionality
     ui->ipLineEdit->setValidator(new QRegularExpressionValidator(
         KfxVersion::hasFunctionality("enet_ipv6_support") ?
-        QRegularExpression("^[0-9a-fA-F:.]*$") :
-        QRegularExpression("^[0-9.]*$")
+        QRegularExpression("^[0-9a-zA-Z:.\\-]*$") :
+        QRegularExpression("^[0-9a-zA-Z.\\-]*$")
         , this));
+
+    // Address racing
+    raceProbeTimer->setInterval(RACE_PROBE_DELAY_MS);
+    raceTimeoutTimer->setSingleShot(true);
+    raceTimeoutTimer->setInterval(RACE_TIMEOUT_MS);
+    connect(raceProbeTimer, &QTimer::timeout, this, &DirectConnectDialog::sendNextRaceProbe);
+    connect(raceTimeoutTimer, &QTimer::timeout, this, &DirectConnectDialog::handleRaceTimeout);
+    connect(raceSocket, &QUdpSocket::readyRead, this, &DirectConnectDialog::readRaceReplies);
 }
 
 DirectConnectDialog::~DirectConnectDialog()
 {
+    stopRace();
     delete ui;
 }
 
@@ -44,35 +67,225 @@ int DirectConnectDialog::getPort(){
     return this->port;
 }
 
+void DirectConnectDialog::setBusy(bool busy)
+{
+    ui->ipLineEdit->setDisabled(busy);
+    ui->portLineEdit->setDisabled(busy);
+    ui->sendButton->setDisabled(busy);
+}
+
 void DirectConnectDialog::on_sendButton_clicked()
 {
     // Get variables
-    QString ipString(ui->ipLineEdit->text());
-    int portNumber = ui->portLineEdit->text().toInt();
-    QHostAddress ipHostAddress(ipString);
+    QString hostString(ui->ipLineEdit->text().trimmed());
+    this->port = ui->portLineEdit->text().toInt();
 
-    // Make sure IP is valid
-    if(ipHostAddress.isNull() || ipHostAddress.protocol() == QAbstractSocket::UnknownNetworkLayerProtocol){
+    if (hostString.isEmpty()) {
         QMessageBox::warning(this, tr("Direct Connect", "MessageBox Title"), tr("Invalid IP address", "MessageBox Text"));
         return;
     }
 
     // Check if IP is IPv4 if IPv6 is not supported
-    if(KfxVersion::hasFunctionality("enet_ipv6_support") == false){
-        if(ipHostAddress.protocol() == QAbstractSocket::IPv6Protocol){
+    QHostAddress ipHostAddress(hostString);
+    if (ipHostAddress.isNull() == false && KfxVersion::hasFunctionality("enet_ipv6_support") == false) {
+        if (ipHostAddress.protocol() == QAbstractSocket::IPv6Protocol) {
             QMessageBox::warning(this, tr("Direct Connect", "MessageBox Title"), tr("IPv6 addresses are not supported.", "MessageBox Text"));
             return;
         }
     }
 
+    // Resolve the host without blocking
+    // IP addresses are returned right away
+    setBusy(true);
+    ui->statusLabel->setText(tr("Resolving %1...", "Status Label").arg(hostString));
+    lookupId = QHostInfo::lookupHost(hostString, this, &DirectConnectDialog::handleHostLookup);
+}
+
+void DirectConnectDialog::handleHostLookup(const QHostInfo &hostInfo)
+{
+    lookupId = -1;
+
+    // Get the addresses KeeperFX can connect to
+    bool ipv6Supported = KfxVersion::hasFunctionality("enet_ipv6_support");
+    QList<QHostAddress> addresses;
+    for (const QHostAddress &address : hostInfo.addresses()) {
+        if (address.protocol() == QAbstractSocket::IPv4Protocol || (ipv6Supported && address.protocol() == QAbstractSocket::IPv6Protocol)) {
+            addresses.append(address);
+        }
+    }
+
+    // Make sure we have an address
+    if (hostInfo.error() != QHostInfo::NoError || addresses.isEmpty()) {
+        qCWarning(logNet) << "Failed to resolve host:" << hostInfo.hostName() << hostInfo.errorString();
+        ui->statusLabel->clear();
+        setBusy(false);
+        QMessageBox::warning(this, tr("Direct Connect", "MessageBox Title"), tr("Invalid IP address", "MessageBox Text"));
+        return;
+    }
+
+    startRace(orderRaceAddresses(addresses));
+}
+
+QList<QHostAddress> DirectConnectDialog::orderRaceAddresses(const QList<QHostAddress> &addresses)
+{
+    QList<QHostAddress> ipv6Addresses;
+    QList<QHostAddress> ipv4Addresses;
+    for (const QHostAddress &address : addresses) {
+        if (address.protocol() == QAbstractSocket::IPv6Protocol) {
+            ipv6Addresses.append(address);
+        } else {
+            ipv4Addresses.append(address);
+        }
+    }
+
+    // Alternate the address families starting with IPv6 (happy eyeballs)
+    // A broken IPv6 route then only delays the IPv4 probe a little
+    QList<QHostAddress> orderedAddresses;
+    for (qsizetype i = 0; i < qMax(ipv6Addresses.size(), ipv4Addresses.size()); i++) {
+        if (i < ipv6Addresses.size()) {
+            orderedAddresses.append(ipv6Addresses.at(i));
+        }
+        if (i < ipv4Addresses.size()) {
+            orderedAddresses.append(ipv4Addresses.at(i));
+        }
+    }
+
+    return orderedAddresses;
+}
+
+void DirectConnectDialog::startRace(const QList<QHostAddress> &addresses)
+{
+    raceAddresses = addresses;
+    raceSendTimes = QList<qint64>(addresses.size(), -1);
+    nextRaceIndex = 0;
+
+    // Bind a dual stack socket if possible
+    if (raceSocket->state() != QAbstractSocket::BoundState) {
+        if (raceSocket->bind(QHostAddress::Any, 0) == false && raceSocket->bind(QHostAddress::AnyIPv4, 0) == false) {
+            qCWarning(logNet) << "Failed to bind direct connect probe socket:" << raceSocket->errorString();
+
+            // Simply use the first address
+            finishRace(raceAddresses.first(), -1);
+            return;
+        }
+    }
+
+    qCDebug(logNet) << "Racing direct connect addresses:" << raceAddresses;
+
+    ui->statusLabel->setText(tr("Checking host...", "Status Label"));
+    raceClock.start();
+    sendNextRaceProbe();
+    raceProbeTimer->start();
+}
+
+void DirectConnectDialog::stopRace()
+{
+    raceProbeTimer->stop();
+    raceTimeoutTimer->stop();
+
+    if (lookupId != -1) {
+        QHostInfo::abortHostLookup(lookupId);
+        lookupId = -1;
+    }
+}
+
+void DirectConnectDialog::sendNextRaceProbe()
+{
+    if (nextRaceIndex >= raceAddresses.size()) {
+        return;
+    }
+
+    // Send ENET connect packet
+    raceSendTimes[nextRaceIndex] = raceClock.nsecsElapsed();
+    raceSocket->writeDatagram(EnetProtocol::getConnectPacket(), raceAddresses.at(nextRaceIndex), this->port);
+    nextRaceIndex++;
+
+    // Wait for replies after the last probe
+    if (nextRaceIndex >= raceAddresses.size()) {
+        raceProbeTimer->stop();
+        raceTimeoutTimer->start();
+    }
+}
+
+void DirectConnectDialog::readRaceReplies()
+{
+    while (raceSocket->hasPendingDatagrams()) {
+        QHostAddress sender;
+        quint16 senderPort;
+        QByteArray datagram(raceSocket->pendingDatagramSize(), '\0');
+        qint64 datagramSize = raceSocket->readDatagram(datagram.data(), datagram.size(), &sender, &senderPort);
+        qint64 receivedTime = raceClock.nsecsElapsed();
+        if (datagramSize < 0) {
+            continue;
+        }
+        datagram.resize(datagramSize);
+
+        // Find the probed address
+        // IPv4 replies can arrive as IPv4 mapped IPv6 addresses on a dual stack socket
+        for (qsizetype i = 0; i < raceAddresses.size(); i++) {
+            if (raceSendTimes.at(i) < 0 || raceAddresses.at(i).isEqual(sender, QHostAddress::TolerantConversion) == false) {
+                continue;
+            }
+
+            // Free the player slot our probe takes up
+            quint16 peerId;
+            quint8 sessionId;
+            if (EnetProtocol::parseVerifyConnect(datagram, peerId, sessionId)) {
+                raceSocket->writeDatagram(EnetProtocol::createDisconnectPacket(peerId, sessionId), sender, senderPort);
+            }
+
+            // The first reply wins
+            if (raceProbeTimer->isActive() || raceTimeoutTimer->isActive()) {
+                finishRace(raceAddresses.at(i), (receivedTime - raceSendTimes.at(i)) / 1000000.0);
+            }
+            break;
+        }
+    }
+}
+
+void DirectConnectDialog::handleRaceTimeout()
+{
+    qCWarning(logNet) << "No ENET reply from direct connect host";
+
+    // The host might not have opened the lobby yet
+    int result = QMessageBox::question(this,
+        tr("Direct Connect", "MessageBox Title"),
+        tr("The host did not respond. Make sure the host has opened a lobby.\n\nDo you want to connect anyway?", "MessageBox Text"));
+
+    if (result != QMessageBox::Yes) {
+        ui->statusLabel->clear();
+        setBusy(false);
+        return;
+    }
+
+    finishRace(raceAddresses.first(), -1);
+}
+
+void DirectConnectDialog::finishRace(const QHostAddress &address, double rttMs)
+{
+    stopRace();
+
+    // Return the address without IPv6 scope
+    // Link-local addresses need their scope to know which interface to use
+    QHostAddress gameAddress(address);
+    if (gameAddress.isLinkLocal() == false) {
+        gameAddress.setScopeId(QString());
+    }
+    this->ip = gameAddress.toString();
+
     // Return to main launcher window which will start the game
-    this->ip = ipString;
-    this->port = portNumber;
-    this->accept();
+    if (rttMs < 0) {
+        this->accept();
+        return;
+    }
+
+    // Show the RTT before the game starts
+    qCInfo(logNet) << "Direct connect host" << this->ip << "responded in" << rttMs << "ms";
+    ui->statusLabel->setText(tr("Host %1 responded in %2 ms", "Status Label").arg(this->ip).arg(rttMs, 0, 'f', 1));
+    QTimer::singleShot(RACE_RESULT_SHOW_MS, this, &DirectConnectDialog::accept);
 }
 
 void DirectConnectDialog::on_cancelButton_clicked()
 {
     this->close();
 }
-
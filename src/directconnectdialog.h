@@ -1,6 +1,12 @@
 #pragma once
 
 #include <QDialog>
+#include <QElapsedTimer>
+#include <QHostAddress>
+#include <QHostInfo>
+#include <QList>
+#include <QTimer>
+#include <QUdpSocket>
 
 namespace Ui {
 class DirectConnectDialog;
@@ -21,9 +27,32 @@ private slots:
     void on_sendButton_clicked();
     void on_cancelButton_clicked();
 
+    void handleHostLookup(const QHostInfo &hostInfo);
+    void sendNextRaceProbe();
+    void readRaceReplies();
+    void handleRaceTimeout();
+
 private:
     Ui::DirectConnectDialog *ui;
 
     QString ip;
     int port;
+
+    // Address racing
+    // Probes are sent to all addresses of the host and the first one to reply wins
+    QUdpSocket *raceSocket;
+    QTimer *raceProbeTimer;
+    QTimer *raceTimeoutTimer;
+    QElapsedTimer raceClock;
+    QList<QHostAddress> raceAddresses;
+    QList<qint64> raceSendTimes;
+    qsizetype nextRaceIndex = 0;
+    int lookupId = -1;
+
+    static QList<QHostAddress> orderRaceAddresses(const QList<QHostAddress> &addresses);
+
+    void startRace(const QList<QHostAddress> &addresses);
+    void stopRace();
+    void finishRace(const QHostAddress &address, double rttMs);
+    void setBusy(bool busy);
 };
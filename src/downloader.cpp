@@ -1,4 +1,5 @@
 #include "downloader.h"
+#include "logcategories.h"
 
 #include <QNetworkRequest>
 #include <QDebug>
@@ -24,7 +25,7 @@ Downloader::~Downloader()
 void Downloader::download(const QUrl &url, QFile *file)
 {
     if (reply) {
-        qWarning() << "Download already in progress";
+        qCWarning(logNet) << "Download already in progress";
         return;
     }
 
@@ -33,7 +34,7 @@ void Downloader::download(const QUrl &url, QFile *file)
     bytesTotal   = -1;
 
     if (!localFileOutput || !localFileOutput->open(QIODevice::WriteOnly)) {
-        qWarning() << "Failed to open file for writing:"
+        qCWarning(logNet) << "Failed to open file for writing:"
                    << (localFileOutput ? localFileOutput->errorString() : "null file");
         emit downloadCompleted(false);
         localFileOutput = nullptr;
@@ -85,7 +86,7 @@ void Downloader::onReadyRead()
 
         const qint64 written = localFileOutput->write(chunk);
         if (written < 0) {
-            qWarning() << "Write failed:" << localFileOutput->errorString();
+            qCWarning(logNet) << "Write failed:" << localFileOutput->errorString();
             reply->abort();
             return;
         }
@@ -111,10 +112,10 @@ void Downloader::onFinished()
     const bool success = (reply->error() == QNetworkReply::NoError);
 
     if (!success) {
-        qWarning() << "Download failed:" << reply->errorString();
+        qCWarning(logNet) << "Download failed:" << reply->errorString();
     } else {
         // Debug: confirm gzip usage
-        qDebug() << "Content-Encoding:"
+        qCDebug(logNet) << "Content-Encoding:"
                  << reply->rawHeader("Content-Encoding");
     }
 
@@ -5,13 +5,14 @@
 #include "settings.h"
 #include "ui_downloadmusicdialog.h"
 #include "extractor.h"
+#include "logcategories.h"
+#include "taskscheduler.h"
 
 #include <QCloseEvent>
 #include <QDateTime>
 #include <QMainWindow>
 #include <QMessageBox>
 #include <QScrollBar>
-#include <QThreadPool>
 
 DownloadMusicDialog::DownloadMusicDialog(QWidget *parent)
     : QDialog(parent)
@@ -117,7 +118,7 @@ void DownloadMusicDialog::onDownloadFinished(bool success)
 
     // Test archive
     emit appendLog("Testing music archive...");
-    QThreadPool::globalInstance()->start([this, outputFile]() {
+    TaskScheduler::start(TaskScheduler::Pool::IO, [this, outputFile]() {
         uint64_t archiveSize = Archiver::testArchiveAndGetSize(outputFile);
         QMetaObject::invokeMethod(this, "onArchiveTestComplete", Qt::QueuedConnection, Q_ARG(uint64_t, archiveSize));
     });
@@ -188,7 +189,7 @@ void DownloadMusicDialog::updateProgressBarDownload(qint64 bytesReceived, qint64
 void DownloadMusicDialog::onAppendLog(const QString &string)
 {
     // Log to debug output
-    qDebug() << "Download music log:" << string;
+    qCDebug(logNet) << "Download music log:" << string;
 
     // Set the cursor to the end
     ui->logTextArea->moveCursor(QTextCursor::End);
@@ -0,0 +1,328 @@
+#include "enetlanscanner.h"
+#include "enetprotocol.h"
+#include "hostnameresolver.h"
+#include "logcategories.h"
+
+#include <QDebug>
+#include <QNetworkInterface>
+
+// Interval between probe batches
+#define PROBE_BATCH_INTERVAL_MS 10
+
+// Smallest subnet prefix that is scanned completely
+// Larger networks are limited to the /16 block around our address
+#define MIN_SUBNET_PREFIX_LENGTH 16
+
+// Interval between probes of found servers while browsing
+#define BROWSE_PROBE_INTERVAL_MS 1000
+
+// Missed browse probes before a server is lost
+#define BROWSE_MAX_MISSED_PROBES 3
+
+// RTT samples used for the latency and jitter of a server
+#define BROWSE_RTT_SAMPLES 8
+
+EnetLanScanner::EnetLanScanner(QObject *parent)
+    : QObject(parent)
+    , udpSocket(new QUdpSocket(this))
+    , sendTimer(new QTimer(this))
+    , timeoutTimer(new QTimer(this))
+    , browseTimer(new QTimer(this))
+{
+    // Handle replies as they come in
+    connect(udpSocket, &QUdpSocket::readyRead, this, &EnetLanScanner::readPendingDatagrams);
+
+    // Send probes at a controlled rate
+    sendTimer->setInterval(PROBE_BATCH_INTERVAL_MS);
+    connect(sendTimer, &QTimer::timeout, this, &EnetLanScanner::sendProbes);
+
+    // Complete the scan after the last response window
+    timeoutTimer->setSingleShot(true);
+    connect(timeoutTimer, &QTimer::timeout, this, &EnetLanScanner::finishScan);
+
+    // Keep probing found servers
+    browseTimer->setInterval(BROWSE_PROBE_INTERVAL_MS);
+    connect(browseTimer, &QTimer::timeout, this, &EnetLanScanner::sendBrowseProbes);
+
+    clock.start();
+}
+
+EnetLanScanner::~EnetLanScanner()
+{
+    stopScan();
+}
+
+QList<quint32> EnetLanScanner::getScanTargets()
+{
+    QList<quint32> scanTargets;
+    QSet<quint32> addedTargets;
+
+    // Loop trough all usable interfaces
+    for (const QNetworkInterface &iface : QNetworkInterface::allInterfaces()) {
+        QNetworkInterface::InterfaceFlags flags = iface.flags();
+        if (flags.testFlag(QNetworkInterface::IsUp) == false || flags.testFlag(QNetworkInterface::IsRunning) == false
+            || flags.testFlag(QNetworkInterface::IsLoopBack)) {
+            continue;
+        }
+
+        for (const QNetworkAddressEntry &entry : iface.addressEntries()) {
+            if (entry.ip().protocol() != QAbstractSocket::IPv4Protocol || entry.ip().isLoopback()) {
+                continue;
+            }
+
+            // Limit huge networks
+            int prefixLength = qMax(entry.prefixLength(), MIN_SUBNET_PREFIX_LENGTH);
+            if (prefixLength >= 31) {
+                continue;
+            }
+
+            // Get the network range
+            quint32 ipInt = entry.ip().toIPv4Address();
+            quint32 maskInt = 0xFFFFFFFFu << (32 - prefixLength);
+            quint32 network = ipInt & maskInt;
+            quint32 broadcast = network | ~maskInt;
+
+            qCDebug(logNet) << "Scanning block containing" << entry.ip().toString() << "with prefix length" << prefixLength << "on" << iface.humanReadableName();
+
+            // Add all hosts of this network
+            for (quint32 i = network + 1; i < broadcast; ++i) {
+                if (addedTargets.contains(i) == false) {
+                    addedTargets.insert(i);
+                    scanTargets.append(i);
+                }
+            }
+        }
+    }
+
+    return scanTargets;
+}
+
+void EnetLanScanner::startScan(quint16 port, int timeout, int probesPerSecond)
+{
+    stopScan();
+
+    // Generate list of IPs to scan
+    targets = getScanTargets();
+    pendingProbes.clear();
+    servers.clear();
+    nextTargetIndex = 0;
+
+    // Make sure we found a local network
+    if (targets.isEmpty()) {
+        qCWarning(logNet) << "Could not determine local IP address.";
+        emit scanComplete();
+        return;
+    }
+
+    // Bind the socket so replies are delivered to it
+    if (udpSocket->state() != QAbstractSocket::BoundState && udpSocket->bind(QHostAddress::AnyIPv4, 0) == false) {
+        qCWarning(logNet) << "Failed to bind LAN scan socket:" << udpSocket->errorString();
+        emit scanComplete();
+        return;
+    }
+
+    this->port = port;
+    probesPerBatch = qMax(1, probesPerSecond * PROBE_BATCH_INTERVAL_MS / 1000);
+    timeoutTimer->setInterval(timeout);
+    isScanning = true;
+
+    qCDebug(logNet) << "LAN scan started:" << targets.size() << "hosts";
+
+    // Send the first batch right away
+    sendProbes();
+    if (isScanning && nextTargetIndex < targets.size()) {
+        sendTimer->start();
+    }
+}
+
+void EnetLanScanner::stopScan()
+{
+    isScanning = false;
+    scanGeneration++;
+    sendTimer->stop();
+    timeoutTimer->stop();
+    browseTimer->stop();
+}
+
+void EnetLanScanner::setBrowsing(bool browsing)
+{
+    isBrowsing = browsing;
+
+    // Start or stop browsing right away if the scan is already done
+    if (isBrowsing && isScanning == false && servers.isEmpty() == false) {
+        browseTimer->start();
+    } else if (isBrowsing == false) {
+        browseTimer->stop();
+    }
+}
+
+bool EnetLanScanner::sendProbe(quint32 target)
+{
+    if (udpSocket->writeDatagram(EnetProtocol::getConnectPacket(), QHostAddress(target), port) == -1) {
+        // Try again later if the send buffer is full
+        if (udpSocket->error() == QAbstractSocket::TemporaryError) {
+            return false;
+        }
+        qCDebug(logNet) << "Failed to send LAN probe to" << QHostAddress(target).toString() << udpSocket->errorString();
+        return true;
+    }
+
+    pendingProbes.insert(target, clock.nsecsElapsed());
+    return true;
+}
+
+void EnetLanScanner::sendProbes()
+{
+    // Send a batch of probes
+    int probesSent = 0;
+    while (isScanning && probesSent < probesPerBatch && nextTargetIndex < targets.size()) {
+        if (sendProbe(targets.at(nextTargetIndex)) == false) {
+            break;
+        }
+        nextTargetIndex++;
+        probesSent++;
+    }
+
+    if (isScanning == false) {
+        return;
+    }
+
+    emit scanProgress(nextTargetIndex, targets.size());
+
+    // Wait for the last responses when all probes are sent
+    if (nextTargetIndex >= targets.size()) {
+        sendTimer->stop();
+        timeoutTimer->start();
+    }
+}
+
+void EnetLanScanner::sendBrowseProbes()
+{
+    const QList<quint32> serverAddresses = servers.keys();
+    for (quint32 serverAddress : serverAddresses) {
+        // Check if the last probe was answered
+        if (pendingProbes.contains(serverAddress)) {
+            ServerStats &stats = servers[serverAddress];
+            stats.missedProbes++;
+
+            // Forget servers that stopped responding
+            if (stats.missedProbes >= BROWSE_MAX_MISSED_PROBES) {
+                QString serverIp = QHostAddress(serverAddress).toString();
+                qCDebug(logNet) << "ENET server lost:" << serverIp;
+                servers.remove(serverAddress);
+                pendingProbes.remove(serverAddress);
+                emit serverLost(serverIp);
+                continue;
+            }
+        }
+
+        sendProbe(serverAddress);
+    }
+}
+
+void EnetLanScanner::readPendingDatagrams()
+{
+    while (udpSocket->hasPendingDatagrams()) {
+        QHostAddress sender;
+        QByteArray datagram(udpSocket->pendingDatagramSize(), '\0');
+        qint64 datagramSize = udpSocket->readDatagram(datagram.data(), datagram.size(), &sender);
+        qint64 receivedTime = clock.nsecsElapsed();
+        if (datagramSize < 0) {
+            continue;
+        }
+        datagram.resize(datagramSize);
+
+        // Only handle the first reply to probes we sent
+        // The server keeps resending its reply until it times out
+        bool isIpv4 = false;
+        quint32 senderInt = sender.toIPv4Address(&isIpv4);
+        if (isIpv4 == false || pendingProbes.contains(senderInt) == false) {
+            continue;
+        }
+        double rttMs = (receivedTime - pendingProbes.take(senderInt)) / 1000000.0;
+
+        // Tell the server we are gone so our probe does not take up a player slot
+        quint16 peerId;
+        quint8 sessionId;
+        if (EnetProtocol::parseVerifyConnect(datagram, peerId, sessionId)) {
+            udpSocket->writeDatagram(EnetProtocol::createDisconnectPacket(peerId, sessionId), sender, port);
+        }
+
+        // Ignore replies when not scanning or browsing
+        if (isScanning == false && isBrowsing == false) {
+            continue;
+        }
+
+        handleServerReply(senderInt, rttMs);
+    }
+}
+
+void EnetLanScanner::handleServerReply(quint32 senderInt, double rttMs)
+{
+    // Get IP string
+    QString targetIp = QHostAddress(senderInt).toString();
+
+    // Check if this is a new server
+    if (servers.contains(senderInt) == false) {
+        qCDebug(logNet) << "ENET response from:" << targetIp;
+        servers.insert(senderInt, ServerStats());
+
+        // Show the server right away
+        // The hostname is filled in when it is not cached yet
+        QString cachedHostname = HostnameResolver::getCachedHostname(targetIp);
+        emit serverFound(targetIp, cachedHostname);
+
+        // Resolve the hostname in the background
+        if (cachedHostname.isEmpty()) {
+            quint32 lookupScanGeneration = scanGeneration;
+            HostnameResolver::resolve(targetIp, this, [this, targetIp, lookupScanGeneration](const QString &hostname) {
+                if (lookupScanGeneration == scanGeneration) {
+                    emit hostnameResolved(targetIp, hostname);
+                }
+            });
+        }
+    }
+
+    // Remember the round trip time
+    ServerStats &stats = servers[senderInt];
+    stats.missedProbes = 0;
+    stats.rttSamples.append(rttMs);
+    if (stats.rttSamples.size() > BROWSE_RTT_SAMPLES) {
+        stats.rttSamples.removeFirst();
+    }
+
+    // Calculate the average RTT and the jitter
+    // Jitter is the average difference between consecutive samples
+    double rttTotal = 0;
+    double jitterTotal = 0;
+    for (qsizetype i = 0; i < stats.rttSamples.size(); i++) {
+        rttTotal += stats.rttSamples.at(i);
+        if (i > 0) {
+            jitterTotal += qAbs(stats.rttSamples.at(i) - stats.rttSamples.at(i - 1));
+        }
+    }
+    double rttAverage = rttTotal / stats.rttSamples.size();
+    double jitter = stats.rttSamples.size() > 1 ? jitterTotal / (stats.rttSamples.size() - 1) : 0;
+
+    emit serverLatencyUpdated(targetIp, rttAverage, jitter);
+}
+
+void EnetLanScanner::finishScan()
+{
+    if (isScanning == false) {
+        return;
+    }
+
+    isScanning = false;
+    qCDebug(logNet) << "LAN scan finished:" << servers.size() << "server(s) found";
+
+    // Forget the probes of hosts that did not respond
+    pendingProbes.clear();
+
+    // Keep probing the found servers
+    if (isBrowsing) {
+        browseTimer->start();
+    }
+
+    emit scanComplete();
+}
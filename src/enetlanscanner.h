@@ -1,140 +1,80 @@
 #pragma once
 
-#include <QAtomicInt>
-#include <QDebug>
-#include <QHostInfo>
-#include <QMutex>
-#include <QNetworkInterface>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QHostAddress>
+#include <QList>
 #include <QObject>
-#include <QThreadPool>
+#include <QSet>
+#include <QTimer>
 #include <QUdpSocket>
 
 class EnetLanScanner : public QObject
 {
     Q_OBJECT
 public:
-    explicit EnetLanScanner(QObject *parent = nullptr)
-        : QObject(parent)
-        , udpSocket(new QUdpSocket)
-        , totalTargets(0)
-        , scannedTargets(0)
-        , responseTimeout(500)
-        , stopRequested(0)
-    {}
-
-    ~EnetLanScanner()
-    {
-        stopScan();
-        QThreadPool::globalInstance()->waitForDone(); // Ensure all threads are completed
-    }
+    explicit EnetLanScanner(QObject *parent = nullptr);
+    ~EnetLanScanner();
 
-    void startScan(quint16 port, int threadCount = 32, int timeout = 500)
-    {
-        // Variables
-        responseTimeout = timeout;
-        QHostAddress localAddress;
-        QHostAddress subnetMask;
-
-        // Determine local IP and subnet mask
-        for (const QNetworkInterface &iface : QNetworkInterface::allInterfaces()) {
-            for (const QNetworkAddressEntry &entry : iface.addressEntries()) {
-                if (entry.ip().protocol() == QAbstractSocket::IPv4Protocol && entry.ip() != QHostAddress::LocalHost) {
-                    localAddress = entry.ip();
-                    subnetMask = entry.netmask();
-                    break;
-                }
-            }
-            if (!localAddress.isNull())
-                break;
-        }
-
-        // Make sure we found a local IP
-        if (localAddress.isNull()) {
-            qWarning() << "Could not determine local IP address.";
-            return;
-        }
-
-        // Show some info
-        qDebug() << "Scanning block containing" << localAddress.toString() << "with subnet mask" << subnetMask.toString();
-
-        // Generate list of IPs to scan
-        QList<QHostAddress> targets = getIpsInSubnet(localAddress, subnetMask);
-        totalTargets = targets.size();
-        scannedTargets = 0;
-        QThreadPool::globalInstance()->setMaxThreadCount(threadCount);
-
-        // Reset stop request flag
-        stopRequested.fetchAndStoreOrdered(0);
-
-        // Create threads for each IP
-        for (QHostAddress &ip : targets) {
-            QThreadPool::globalInstance()->start([this, ip, port]() { sendUdpPacket(ip, port); });
-        }
-    }
-
-    void stopScan() { stopRequested.fetchAndStoreOrdered(1); }
+    void startScan(quint16 port, int timeout = 500, int probesPerSecond = 10000);
+    void stopScan();
+
+    // Keep probing the found servers after the scan to measure their latency
+    // Servers that stop responding are reported as lost
+    void setBrowsing(bool browsing);
 
 signals:
     void serverFound(QString ip, QString hostname);
+    void hostnameResolved(QString ip, QString hostname);
+    void serverLatencyUpdated(QString ip, double rttMs, double jitterMs);
+    void serverLost(QString ip);
     void scanProgress(int scanned, int total);
     void scanComplete();
 
 private:
+    // Latency of a found server
+    struct ServerStats
+    {
+        QList<double> rttSamples;
+        int missedProbes = 0;
+    };
+
+    // A single socket is used for all probes and replies
     QUdpSocket *udpSocket;
-    int totalTargets;
-    int scannedTargets;
-    int responseTimeout;
-    QMutex progressMutex;
-    QAtomicInt stopRequested;
 
-    QList<QHostAddress> getIpsInSubnet(const QHostAddress &ip, const QHostAddress &mask)
-    {
-        QList<QHostAddress> ips;
-        quint32 ipInt = ip.toIPv4Address();
-        quint32 maskInt = mask.toIPv4Address();
-        quint32 network = ipInt & maskInt;
-        quint32 broadcast = network | ~maskInt;
-
-        for (quint32 i = network + 1; i < broadcast; ++i) {
-            ips.append(QHostAddress(i));
-        }
-        return ips;
-    }
-
-    void sendUdpPacket(QHostAddress target, quint16 port)
-    {
-        // Check if stop has been requested
-        if (stopRequested.fetchAndAddOrdered(0) == 1) {
-            return;
-        }
-
-        // Get IP string
-        QString targetIp = target.toString();
-
-        // Send ENET packet
-        QUdpSocket socket;
-        QByteArray data = QByteArray::fromHex("8fff864b82ff00010000ffff0000057800010000000000020000000000000000000013880000000200000002ec5093d400000000");
-        socket.writeDatagram(data, target, port);
-
-        // Check for response
-        if (socket.waitForReadyRead(responseTimeout)) {
-            qDebug() << "ENET response from:" << targetIp;
-
-            // Check if stop has been requested
-            if (stopRequested.fetchAndAddOrdered(0) == 1) {
-                return;
-            }
-
-            // Emit signal with hostname
-            emit serverFound(targetIp, QHostInfo::fromName(targetIp).hostName());
-        }
-
-        // Update progress
-        QMutexLocker locker(&progressMutex); // Use QMutexLocker for exception safety
-        scannedTargets++;
-        emit scanProgress(scannedTargets, totalTargets);
-        if (scannedTargets == totalTargets) {
-            emit scanComplete();
-        }
-    }
+    // Sends the probes in small batches to keep a steady rate
+    QTimer *sendTimer;
+
+    // Finishes the scan once the last probe had time to get a response
+    QTimer *timeoutTimer;
+
+    // Probes the found servers while browsing
+    QTimer *browseTimer;
+
+    // Clock for the probe round trip times
+    QElapsedTimer clock;
+
+    QList<quint32> targets;
+    qsizetype nextTargetIndex = 0;
+    int probesPerBatch = 0;
+    quint16 port = 0;
+    bool isScanning = false;
+    bool isBrowsing = false;
+
+    // Probes without a reply yet and when they were sent (nsecs)
+    QHash<quint32, qint64> pendingProbes;
+
+    QHash<quint32, ServerStats> servers;
+
+    // Changes when a scan is stopped so late hostname lookups are ignored
+    quint32 scanGeneration = 0;
+
+    static QList<quint32> getScanTargets();
+
+    bool sendProbe(quint32 target);
+    void sendProbes();
+    void sendBrowseProbes();
+    void readPendingDatagrams();
+    void handleServerReply(quint32 senderInt, double rttMs);
+    void finishScan();
 };
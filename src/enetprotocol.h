@@ -0,0 +1,96 @@
+#pragma once
+
+#include <QByteArray>
+#include <QtEndian>
+
+namespace EnetProtocol {
+
+    // Command numbers and flags
+    constexpr int COMMAND_MASK = 0x0F;
+    constexpr int COMMAND_ACKNOWLEDGE = 1;
+    constexpr int COMMAND_VERIFY_CONNECT = 3;
+    constexpr int COMMAND_DISCONNECT = 4;
+    constexpr int COMMAND_FLAG_UNSEQUENCED = 0x40;
+    constexpr int HEADER_FLAG_SENT_TIME = 0x8000;
+    constexpr int HEADER_SESSION_SHIFT = 12;
+
+    /**
+     * Returns the packet an ENET client sends to start a connection.
+     *
+     * A host with an open lobby answers it with a verify connect command.
+     *
+     * @return ENET connect packet
+     */
+    inline const QByteArray &getConnectPacket()
+    {
+        static const QByteArray packet = QByteArray::fromHex(
+            "8fff864b82ff00010000ffff0000057800010000000000020000000000000000000013880000000200000002ec5093d400000000");
+        return packet;
+    }
+
+    /**
+     * Gets the peer of a verify connect reply to our connect packet.
+     *
+     * @param datagram  Reply of the host
+     * @param peerId    The peer ID the host gave us
+     * @param sessionId The session ID the host expects from us
+     * @return True if the reply contains a verify connect command
+     */
+    inline bool parseVerifyConnect(const QByteArray &datagram, quint16 &peerId, quint8 &sessionId)
+    {
+        const uchar *data = reinterpret_cast<const uchar *>(datagram.constData());
+        qsizetype size = datagram.size();
+
+        // Skip the header
+        if (size < 2) {
+            return false;
+        }
+        qsizetype pos = (qFromBigEndian<quint16>(data) & HEADER_FLAG_SENT_TIME) ? 4 : 2;
+
+        // Loop trough the commands
+        // The acknowledgement of our connect command can come first
+        while (pos + 4 <= size) {
+            int command = data[pos] & COMMAND_MASK;
+
+            if (command == COMMAND_ACKNOWLEDGE) {
+                pos += 8;
+                continue;
+            }
+
+            if (command == COMMAND_VERIFY_CONNECT && pos + 44 <= size) {
+                peerId = qFromBigEndian<quint16>(data + pos + 4);
+                sessionId = data[pos + 7];
+                return true;
+            }
+
+            return false;
+        }
+
+        return false;
+    }
+
+    /**
+     * Creates a packet that disconnects our half open connection.
+     *
+     * Without it a probe takes up a player slot of the host until it times out.
+     *
+     * @param peerId    The peer ID from the verify connect reply
+     * @param sessionId The session ID from the verify connect reply
+     * @return ENET disconnect packet
+     */
+    inline QByteArray createDisconnectPacket(quint16 peerId, quint8 sessionId)
+    {
+        QByteArray packet(10, '\0');
+        uchar *data = reinterpret_cast<uchar *>(packet.data());
+
+        // Header without sent time
+        qToBigEndian<quint16>(quint16((peerId & 0x0FFF) | ((sessionId & 0x03) << HEADER_SESSION_SHIFT)), data);
+
+        // Unsequenced disconnect command
+        data[2] = COMMAND_DISCONNECT | COMMAND_FLAG_UNSEQUENCED;
+        data[3] = 0xFF;
+
+        return packet;
+    }
+
+}
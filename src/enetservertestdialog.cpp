@@ -1,24 +1,49 @@
 #include "enetservertestdialog.h"
+#include "enetprotocol.h"
 #include "kfxversion.h"
 #include "ui_enetservertestdialog.h"
+#include "logcategories.h"
 
 #include <QDateTime>
+#include <QFileDialog>
 #include <QHostAddress>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QMessageBox>
 #include <QNetworkReply>
 #include <QNetworkRequest>
+#include <QSaveFile>
 #include <QScrollBar>
+#include <QTextStream>
+
+#include <algorithm>
+#include <cmath>
+
+// Time to wait for the last latency probe replies
+#define LATENCY_PROBE_TIMEOUT_MS 1000
+
+// Amount of buckets in the latency histogram
+#define LATENCY_HISTOGRAM_BUCKETS 10
+
+// Offsets in a latency probe
+// Probes look like an ENET ping command followed by a launcher marker
+#define LATENCY_PROBE_MARKER "KFXLAT"
+#define LATENCY_PROBE_MARKER_OFFSET 8
+#define LATENCY_PROBE_TYPE_OFFSET 14
+#define LATENCY_PROBE_SIZE 15
 
 EnetServerTestDialog::EnetServerTestDialog(QWidget *parent)
     : QDialog(parent)
     , ui(new Ui::EnetServerTestDialog)
     , udpSocket(nullptr)
     , networkManager(new QNetworkAccessManager(this))
+    , probeTimer(new QTimer(this))
 {
     ui->setupUi(this);
 
+    // Send latency probes at the chosen interval
+    connect(probeTimer, &QTimer::timeout, this, &EnetServerTestDialog::sendLatencyProbe);
+
     if (KfxVersion::hasFunctionality("enet_ipv6_support")) {
         ui->infoLabelIpv4->hide();
     }
@@ -39,6 +64,7 @@ void EnetServerTestDialog::on_testButton_clicked()
 {
     // Disable the button so we don't click it again
     ui->testButton->setDisabled(true);
+    ui->measureButton->setDisabled(true);
 
     // Clear log text area
     ui->logTextArea->clear();
@@ -61,6 +87,7 @@ void EnetServerTestDialog::handleIpReply(QNetworkReply *reply)
         appendLog("Failed to retrieve public IP address");
         QMessageBox::warning(this, tr("IPv6 Detected", "MessageBox Title"), tr("Failed to retrieve public IP address.", "MessageBox Text"));
         ui->testButton->setEnabled(true);
+        ui->measureButton->setEnabled(true);
         return;
     }
 
@@ -77,6 +104,7 @@ void EnetServerTestDialog::handleIpReply(QNetworkReply *reply)
         if (address.protocol() != QAbstractSocket::IPv4Protocol) {
             QMessageBox::warning(this, tr("IPv6 Detected", "MessageBox Title"), tr("This tool only works with IPv4.", "MessageBox Text"));
             ui->testButton->setEnabled(true);
+            ui->measureButton->setEnabled(true);
             return;
         }
     }
@@ -91,10 +119,14 @@ void EnetServerTestDialog::startUdpServer()
     appendLog("Starting spoofed ENET server");
 
     // Try to start server
+    // Listen on IPv4 and IPv6 so peers of both are answered
+    // Systems without IPv6 only get the IPv4 server
     udpSocket = new QUdpSocket(this);
-    if (!udpSocket->bind(QHostAddress::AnyIPv4, 5556)) {
+    if (!udpSocket->bind(QHostAddress::Any, 5556) && !udpSocket->bind(QHostAddress::AnyIPv4, 5556)) {
         appendLog("Failed to start ENET server");
         QMessageBox::warning(this, tr("Portforwarding tool", "MessageBox Title"), tr("Failed to start ENET server.", "MessageBox Text"));
+        udpSocket->deleteLater();
+        udpSocket = nullptr;
         return;
     }
 
@@ -123,8 +155,7 @@ void EnetServerTestDialog::handleUdpDatagram()
 
         // This is the packet we will retrieve from the KeeperFX.net host checker tool
         // It needs to be exactly this because that's what an ENET UDP client sends to start a connection
-        QByteArray expectedData = QByteArray::fromHex(
-            "8fff864b82ff00010000ffff0000057800010000000000020000000000000000000013880000000200000002ec5093d400000000");
+        const QByteArray &expectedData = EnetProtocol::getConnectPacket();
 
         // Check if packet matches with our ENET handshake packet
         if (datagram == expectedData) {
@@ -132,10 +163,251 @@ void EnetServerTestDialog::handleUdpDatagram()
 
             // Send some data back to let the client know we received their packet
             udpSocket->writeDatagram("OK", sender, senderPort);
+            continue;
+        }
+
+        // Handle latency probes
+        if (isLatencyProbe(datagram)) {
+            // Echo probes from other launchers
+            if (datagram.at(LATENCY_PROBE_TYPE_OFFSET) == 'Q') {
+                datagram[LATENCY_PROBE_TYPE_OFFSET] = 'R';
+                udpSocket->writeDatagram(datagram, sender, senderPort);
+                continue;
+            }
+
+            // Remember the round trip time of our own probes
+            quint16 sequence = (quint8(datagram.at(6)) << 8) | quint8(datagram.at(7));
+            if (isMeasuring && probeSendTimes.contains(sequence) && sequence < probeRtts.size()) {
+                probeRtts[sequence] = (probeClock.nsecsElapsed() - probeSendTimes.take(sequence)) / 1000000.0;
+            }
         }
     }
 }
 
+QByteArray EnetServerTestDialog::createLatencyProbe(quint16 sequence)
+{
+    QByteArray probe;
+    probe.reserve(LATENCY_PROBE_SIZE);
+
+    // ENET header without a peer
+    probe.append(QByteArray::fromHex("8fff0000"));
+
+    // ENET ping command with the sequence number as reliable sequence number
+    probe.append(char(0x85));
+    probe.append(char(0xFF));
+    probe.append(char(sequence >> 8));
+    probe.append(char(sequence & 0xFF));
+
+    // Launcher marker and probe type (Q = request, R = reply)
+    probe.append(LATENCY_PROBE_MARKER);
+    probe.append('Q');
+
+    return probe;
+}
+
+bool EnetServerTestDialog::isLatencyProbe(const QByteArray &datagram)
+{
+    return datagram.size() == LATENCY_PROBE_SIZE && datagram.mid(LATENCY_PROBE_MARKER_OFFSET, 6) == LATENCY_PROBE_MARKER;
+}
+
+void EnetServerTestDialog::setLatencyControlsEnabled(bool enabled)
+{
+    ui->testButton->setEnabled(enabled);
+    ui->peerLineEdit->setEnabled(enabled);
+    ui->probeCountSpinBox->setEnabled(enabled);
+    ui->probeIntervalSpinBox->setEnabled(enabled);
+}
+
+void EnetServerTestDialog::on_measureButton_clicked()
+{
+    // Stop answering probes
+    if (isEchoing) {
+        isEchoing = false;
+        stopUdpServer();
+        setLatencyControlsEnabled(true);
+        ui->measureButton->setText(tr("Measure latency", "Button"));
+        return;
+    }
+
+    // Check the peer address
+    QString peerString = ui->peerLineEdit->text().trimmed();
+    if (peerString.isEmpty() == false) {
+        peerAddress = QHostAddress(peerString);
+        if (peerAddress.isNull()) {
+            QMessageBox::warning(this, tr("Latency test", "MessageBox Title"), tr("Invalid peer IP address.", "MessageBox Text"));
+            return;
+        }
+    }
+
+    // Start the spoofed ENET server
+    // It sends our probes and answers the probes of the peer
+    startUdpServer();
+    if (udpSocket == nullptr) {
+        return;
+    }
+
+    // An IPv4 only server can not reach an IPv6 peer
+    if (peerString.isEmpty() == false
+        && peerAddress.protocol() == QAbstractSocket::IPv6Protocol
+        && udpSocket->localAddress().protocol() == QAbstractSocket::IPv4Protocol) {
+        stopUdpServer();
+        QMessageBox::warning(this, tr("Latency test", "MessageBox Title"), tr("IPv6 is not available on this system. Please use the IPv4 address of the peer.", "MessageBox Text"));
+        return;
+    }
+    setLatencyControlsEnabled(false);
+
+    // Only answer probes of others when there is no peer
+    if (peerString.isEmpty()) {
+        isEchoing = true;
+        ui->measureButton->setText(tr("Stop", "Button"));
+        appendLog("Answering latency probes on port 5556");
+        return;
+    }
+
+    // Start measuring
+    isMeasuring = true;
+    probeCount = ui->probeCountSpinBox->value();
+    probesSent = 0;
+    probeSendTimes.clear();
+    probeRtts = QList<double>(probeCount, -1);
+    ui->measureButton->setDisabled(true);
+    ui->exportButton->setDisabled(true);
+    appendLog(QString("Sending %1 latency probes to %2").arg(probeCount).arg(peerAddress.toString()));
+
+    probeClock.start();
+    probeTimer->start(ui->probeIntervalSpinBox->value());
+}
+
+void EnetServerTestDialog::sendLatencyProbe()
+{
+    if (udpSocket == nullptr || probesSent >= probeCount) {
+        probeTimer->stop();
+        return;
+    }
+
+    // Send the next probe
+    quint16 sequence = quint16(probesSent);
+    probeSendTimes.insert(sequence, probeClock.nsecsElapsed());
+    udpSocket->writeDatagram(createLatencyProbe(sequence), peerAddress, 5556);
+    probesSent++;
+
+    // Wait for the last replies
+    if (probesSent >= probeCount) {
+        probeTimer->stop();
+        QTimer::singleShot(LATENCY_PROBE_TIMEOUT_MS, this, &EnetServerTestDialog::finishLatencyMeasurement);
+    }
+}
+
+void EnetServerTestDialog::finishLatencyMeasurement()
+{
+    isMeasuring = false;
+    probeSendTimes.clear();
+    stopUdpServer();
+
+    logLatencyResults();
+
+    setLatencyControlsEnabled(true);
+    ui->measureButton->setEnabled(true);
+    ui->exportButton->setEnabled(true);
+}
+
+void EnetServerTestDialog::logLatencyResults()
+{
+    // Get the received RTTs
+    QList<double> rtts;
+    double jitterTotal = 0;
+    int jitterSamples = 0;
+    double previousRtt = -1;
+    for (double rtt : std::as_const(probeRtts)) {
+        if (rtt < 0) {
+            continue;
+        }
+        rtts.append(rtt);
+
+        // Jitter is the average difference between consecutive replies
+        if (previousRtt >= 0) {
+            jitterTotal += std::abs(rtt - previousRtt);
+            jitterSamples++;
+        }
+        previousRtt = rtt;
+    }
+
+    double loss = 100.0 * (probeRtts.size() - rtts.size()) / probeRtts.size();
+    appendLog(QString("Received %1/%2 replies (%3% loss)").arg(rtts.size()).arg(probeRtts.size()).arg(loss, 0, 'f', 1));
+
+    if (rtts.isEmpty()) {
+        appendLog("No replies received. Make sure the peer is answering probes.");
+        return;
+    }
+
+    // Percentiles
+    std::sort(rtts.begin(), rtts.end());
+    auto percentile = [&rtts](double p) {
+        qsizetype index = qBound<qsizetype>(0, qsizetype(std::ceil(p / 100.0 * rtts.size())) - 1, rtts.size() - 1);
+        return rtts.at(index);
+    };
+    appendLog(QString("RTT min %1 ms, p50 %2 ms, p90 %3 ms, p99 %4 ms, max %5 ms")
+                  .arg(rtts.first(), 0, 'f', 2)
+                  .arg(percentile(50), 0, 'f', 2)
+                  .arg(percentile(90), 0, 'f', 2)
+                  .arg(percentile(99), 0, 'f', 2)
+                  .arg(rtts.last(), 0, 'f', 2));
+    appendLog(QString("Jitter %1 ms").arg(jitterSamples > 0 ? jitterTotal / jitterSamples : 0, 0, 'f', 2));
+
+    // Histogram
+    double bucketWidth = qMax(0.01, (rtts.last() - rtts.first()) / LATENCY_HISTOGRAM_BUCKETS);
+    QList<int> buckets(LATENCY_HISTOGRAM_BUCKETS, 0);
+    for (double rtt : std::as_const(rtts)) {
+        int bucket = qMin(LATENCY_HISTOGRAM_BUCKETS - 1, int((rtt - rtts.first()) / bucketWidth));
+        buckets[bucket]++;
+    }
+    int largestBucket = *std::max_element(buckets.constBegin(), buckets.constEnd());
+    for (int i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++) {
+        double bucketStart = rtts.first() + i * bucketWidth;
+        int barLength = buckets.at(i) * 40 / largestBucket;
+        appendLog(QString("%1 - %2 ms | %3 %4")
+                      .arg(bucketStart, 8, 'f', 2)
+                      .arg(bucketStart + bucketWidth, 8, 'f', 2)
+                      .arg(QString(barLength, '#'), -40)
+                      .arg(buckets.at(i)));
+    }
+}
+
+void EnetServerTestDialog::on_exportButton_clicked()
+{
+    QString filePath = QFileDialog::getSaveFileName(this, tr("Export latency results", "Dialog Title"), "enet-latency.csv", tr("CSV files (*.csv)", "File Filter"));
+    if (filePath.isEmpty()) {
+        return;
+    }
+
+    // Write a row for every probe
+    // Lost probes have an empty RTT
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        QMessageBox::warning(this, tr("Latency test", "MessageBox Title"), tr("Failed to export the results.", "MessageBox Text"));
+        return;
+    }
+
+    QTextStream out(&file);
+    out << "# peer=" << peerAddress.toString() << " interval_ms=" << ui->probeIntervalSpinBox->value() << "\n";
+    out << "sequence,rtt_ms\n";
+    for (qsizetype i = 0; i < probeRtts.size(); i++) {
+        out << i << ",";
+        if (probeRtts.at(i) >= 0) {
+            out << QString::number(probeRtts.at(i), 'f', 3);
+        }
+        out << "\n";
+    }
+    out.flush();
+
+    if (file.commit() == false) {
+        QMessageBox::warning(this, tr("Latency test", "MessageBox Title"), tr("Failed to export the results.", "MessageBox Text"));
+        return;
+    }
+
+    appendLog(QString("Results exported to %1").arg(filePath));
+}
+
 void EnetServerTestDialog::sendPingRequest()
 {
     appendLog("Sending IP to KeeperFX.net ENET host checker tool");
@@ -155,6 +427,7 @@ void EnetServerTestDialog::handlePingReply(QNetworkReply *reply)
 
     // Enable test button again
     ui->testButton->setEnabled(true);
+    ui->measureButton->setEnabled(true);
 
     // Make sure we got a response from the KeeperFX.net host checker tool
     if (reply->error() != QNetworkReply::NoError) {
@@ -182,7 +455,7 @@ void EnetServerTestDialog::handlePingReply(QNetworkReply *reply)
 
 void EnetServerTestDialog::appendLog(const QString &string)
 {
-    qDebug() << "ENET server test log:" << string;
+    qCDebug(logNet) << "ENET server test log:" << string;
     QDateTime currentDateTime = QDateTime::currentDateTime();
     QString timestampString = currentDateTime.toString("HH:mm:ss");
     ui->logTextArea->insertPlainText("[" + timestampString + "] " + string + "\n");
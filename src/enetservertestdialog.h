@@ -1,8 +1,12 @@
 #pragma once
 
 #include <QDialog>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QHostAddress>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
+#include <QTimer>
 #include <QUdpSocket>
 
 namespace Ui { class EnetServerTestDialog; }
@@ -21,6 +25,10 @@ private slots:
     void handleIpReply(QNetworkReply *reply);
     void handlePingReply(QNetworkReply *reply);
     void handleUdpDatagram();
+    void on_measureButton_clicked();
+    void on_exportButton_clicked();
+    void sendLatencyProbe();
+    void finishLatencyMeasurement();
 
 private:
     Ui::EnetServerTestDialog *ui;
@@ -32,4 +40,25 @@ private:
     void startUdpServer();
     void stopUdpServer();
     void sendPingRequest();
+
+    // Latency measurement
+    QTimer *probeTimer;
+    QElapsedTimer probeClock;
+    QHostAddress peerAddress;
+    int probeCount = 0;
+    int probesSent = 0;
+    bool isMeasuring = false;
+    bool isEchoing = false;
+
+    // Send times (nsecs) by probe sequence number
+    QHash<quint16, qint64> probeSendTimes;
+
+    // RTT by probe sequence number, negative if lost
+    QList<double> probeRtts;
+
+    static QByteArray createLatencyProbe(quint16 sequence);
+    static bool isLatencyProbe(const QByteArray &datagram);
+
+    void setLatencyControlsEnabled(bool enabled);
+    void logLatencyResults();
 };
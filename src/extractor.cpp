@@ -1,11 +1,11 @@
 #include "extractor.h"
 #include "archiver.h"
+#include "logcategories.h"
 
 #include <QFileInfo>
 #include <QCoreApplication>
 #include <QJsonObject>
 #include <QDebug>
-#include <QThread>
 
 #include <bit7z/bitextractor.hpp>
 #include <bit7z/bitabstractarchivehandler.hpp>
@@ -16,9 +16,23 @@ Extractor::Extractor(QObject *parent)
 {
 }
 
+Extractor::~Extractor()
+{
+    // The extraction uses this object so it has to stop first
+    cancel();
+    extractFuture.waitForFinished();
+}
+
+void Extractor::cancel()
+{
+    cancellationToken.cancel();
+}
+
 void Extractor::extract(QFile *archiveFile, QString outputDir)
 {
-    QThread::create([this, archiveFile, outputDir]() {
+    CancellationToken token = cancellationToken;
+
+    extractFuture = TaskScheduler::run(TaskScheduler::Pool::IO, [this, archiveFile, outputDir, token]() {
 
         try {
             // Get file info for the archive file
@@ -30,9 +44,9 @@ void Extractor::extract(QFile *archiveFile, QString outputDir)
                 ));
 
             // Set progress callback
-            archive.setProgressCallback([this](uint64_t processedSize) -> bool {
+            archive.setProgressCallback([this, token](uint64_t processedSize) -> bool {
                 emit progress(processedSize);
-                return true; // Continue processing
+                return token.isCanceled() == false; // Stop processing when canceled
             });
 
             // Extract it
@@ -42,9 +56,14 @@ void Extractor::extract(QFile *archiveFile, QString outputDir)
 
         } catch (const bit7z::BitException &ex) {
 
-            qWarning() << "bit7z BitException:" << ex.what();
+            // Nobody is waiting for the result of a canceled extraction
+            if (token.isCanceled()) {
+                qCInfo(logArchive) << "Extraction canceled";
+                return;
+            }
+
+            qCWarning(logArchive) << "bit7z BitException:" << ex.what();
             emit extractFailed(QString::fromStdString(ex.what()));
         }
-
-    })->start();
+    });
 }
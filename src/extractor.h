@@ -2,19 +2,30 @@
 
 #include <QObject>
 #include <QFile>
+#include <QFuture>
 #include <QString>
 
+#include "taskscheduler.h"
+
 class Extractor : public QObject
 {
     Q_OBJECT
 
 public:
     explicit Extractor(QObject *parent = nullptr);
+    ~Extractor();
+
     void extract(QFile *archiveFile, QString outputDir);
 
+    // Stops a running extraction
+    void cancel();
+
 signals:
     void progress(uint64_t processedSize);
     void extractComplete();
     void extractFailed(const QString &error);
 
+private:
+    CancellationToken cancellationToken;
+    QFuture<void> extractFuture;
 };
@@ -1,4 +1,5 @@
 #include "game.h"
+#include "logcategories.h"
 #include <QApplication>
 #include <QDebug>
 #include <QDir>
@@ -6,12 +7,28 @@
 #include <QMessageBox>
 #include "crashdialog.h"
 #include "kfxversion.h"
+#include "launcheroptions.h"
 #include "settings.h"
 
+// Size of the game output kept in memory
+#define GAME_OUTPUT_BUFFER_SIZE (256 * 1024)
+
+// Size at which the game output log file is rotated
+#define GAME_OUTPUT_LOG_MAX_SIZE (4 * 1024 * 1024)
+
+// How long a pre-warmed wineserver stays alive without any clients
+#define WINE_PREWARM_PERSIST_SECONDS 300
+
+// How long we wait for the game window before we stop measuring
+#define LAUNCH_WINDOW_TIMEOUT_MS 60000
+
 Game::Game(QWidget *parent)
     : QObject(parent)
     , process(new QProcess(this))
     , parentWidget(parent)
+    , outputBuffer(GAME_OUTPUT_BUFFER_SIZE)
+    , errorBuffer(GAME_OUTPUT_BUFFER_SIZE)
+    , sessionMonitor(new GameSessionMonitor(this))
 {
     // Setup the process
     process->setWorkingDirectory(QApplication::applicationDirPath());
@@ -21,9 +38,13 @@ Game::Game(QWidget *parent)
             QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
             this,
             &Game::onProcessFinished);
-    /*connect(process, &QProcess::readyReadStandardOutput, this, &Game::handleProcessOutput);
-    connect(process, &QProcess::readyReadStandardError, this, &Game::handleProcessOutput);*/
 
+    // Read the game output while it is running so it does not pile up in the process buffers
+    connect(process, &QProcess::readyReadStandardOutput, this, &Game::handleProcessOutput);
+    connect(process, &QProcess::readyReadStandardError, this, &Game::handleProcessError);
+
+    // The launcher loses focus when the game window shows up
+    connect(qApp, &QGuiApplication::applicationStateChanged, this, &Game::onApplicationStateChanged);
 }
 
 QString Game::getStringFromStartType(StartType startType)
@@ -49,15 +70,25 @@ QString Game::getStringFromStartType(StartType startType)
 
 bool Game::start(StartType startType, QVariant data1, QVariant data2, QVariant data3)
 {
+    // Measure the time it takes for the game to start
+    launchTimer.start();
+    isWaitingForWindow = false;
+
+    // Let everything that holds on to the game files know
+    emit gameStarting();
+
     // Refresh error
     this->errorString = QString();
 
     // Log some stuff
-    qInfo() << "Setting up game for start";
-    qInfo() << "Start type:" << Game::getStringFromStartType(startType);
-    qDebug() << "Data[1]" << data1.toString();
-    qDebug() << "Data[2]" << data2.toString();
-    qDebug() << "Data[3]" << data3.toString();
+    qCInfo(logGame) << "Setting up game for start";
+    qCInfo(logGame) << "Start type:" << Game::getStringFromStartType(startType);
+    qCDebug(logGame) << "Data[1]" << data1.toString();
+    qCDebug(logGame) << "Data[2]" << data2.toString();
+    qCDebug(logGame) << "Data[3]" << data3.toString();
+
+    // Make sure the game reads our latest settings
+    Settings::flush();
 
     // Get the game parameters
     QStringList params = Settings::getGameSettingsParameters();
@@ -68,7 +99,7 @@ bool Game::start(StartType startType, QVariant data1, QVariant data2, QVariant d
         QFileInfo configFileInfo(Settings::getKfxConfigFile());
         params << "-config" << QDir::toNativeSeparators(configFileInfo.absoluteFilePath());
     } else {
-        qWarning() << "Game version too old for custom config path";
+        qCWarning(logGame) << "Game version too old for custom config path";
     }
 
     // Campaign
@@ -93,9 +124,20 @@ bool Game::start(StartType startType, QVariant data1, QVariant data2, QVariant d
 
     // Log parameters
     if (params.count() > 0) {
-        qInfo() << "Game parameters:" << params.join(" ");
+        qCInfo(logGame) << "Game parameters:" << params.join(" ");
     } else {
-        qInfo() << "No game parameters set";
+        qCInfo(logGame) << "No game parameters set";
+    }
+
+    // Start with empty output buffers
+    outputBuffer.clear();
+    errorBuffer.clear();
+    outputDecoder.resetState();
+    errorDecoder.resetState();
+
+    // Copy the game output to a log file if wanted
+    if (LauncherOptions::isSet("game-output-log") == true) {
+        openOutputLogFile();
     }
 
     // Get the game binary
@@ -109,18 +151,18 @@ bool Game::start(StartType startType, QVariant data1, QVariant data2, QVariant d
 
     // Start the process
     #ifdef Q_OS_WINDOWS
-        qInfo() << "Starting game (Windows)";
+        qCInfo(logGame) << "Starting game (Windows)";
         process->start(keeperfxBin, params);
     #else
         if (qEnvironmentVariableIsSet("FLATPAK_ID")) {
-            qInfo() << "Starting game (Linux: Flatpak -> Wine)";
+            qCInfo(logGame) << "Starting game (Linux: Flatpak -> Wine)";
             // Run Wine outside Flatpak
             params.prepend(keeperfxBin);
             params.prepend("wine");
             params.prepend("--host");
             process->start("flatpak-spawn", params);
         } else {
-            qInfo() << "Starting game (Linux: Wine)";
+            qCInfo(logGame) << "Starting game (Linux: Wine)";
             // Normal Wine execution
             params.prepend(keeperfxBin);
             process->start("wine", params);
@@ -128,20 +170,106 @@ bool Game::start(StartType startType, QVariant data1, QVariant data2, QVariant d
     #endif
 
     // Log the full command line
-    qDebug() << "Full command:" << process->program() + " " + process->arguments().join(" ");
+    qCDebug(logGame) << "Full command:" << process->program() + " " + process->arguments().join(" ");
 
     // Wait for process to start and check errors
     if (!process->waitForStarted()) {
         this->errorString = process->errorString();
-        qDebug() << "Error: Process failed to start:" << process->errorString();
+        qCDebug(logGame) << "Error: Process failed to start:" << process->errorString();
+
+        // Close the output log
+        if (outputLogFile.isOpen()) {
+            outputLogFile.close();
+        }
+
         return false;
     }
 
+    // Log the launch latency so different configurations can be compared
+    qCInfo(logGame) << "Launch latency: process started after" << launchTimer.elapsed() << "ms"
+            << (isWineserverPrewarmed() ? "(wineserver pre-warmed)" : "");
+
+    // Wait for the game window to take focus away from the launcher
+    isWaitingForWindow = true;
+
+    // Record the resource usage of this session if wanted
+    if (LauncherOptions::isSet("session-monitor") == true) {
+        sessionMonitor->start(process->processId(), Game::getStringFromStartType(startType));
+    }
+
     return true;
 }
 
+void Game::prewarm()
+{
+#ifndef Q_OS_WINDOWS
+    // Check if pre-warming is enabled
+    if (Settings::getLauncherSetting("WINE_PREWARM_ENABLED").toBool() == false) {
+        return;
+    }
+
+    // No need to start Wine when the game is running or not installed
+    if (process->state() != QProcess::NotRunning || QFile::exists(QApplication::applicationDirPath() + "/keeperfx.exe") == false) {
+        return;
+    }
+
+    // Keep the wineserver running for a while without any clients
+    // When a wineserver is already running for this prefix the new one exits right away
+    QStringList params = {"-p" + QString::number(WINE_PREWARM_PERSIST_SECONDS)};
+
+    bool startStatus;
+    if (qEnvironmentVariableIsSet("FLATPAK_ID")) {
+        // Run the wineserver outside Flatpak
+        params.prepend("wineserver");
+        params.prepend("--host");
+        startStatus = QProcess::startDetached("flatpak-spawn", params, QApplication::applicationDirPath());
+    } else {
+        startStatus = QProcess::startDetached("wineserver", params, QApplication::applicationDirPath());
+    }
+
+    if (startStatus == false) {
+        qCWarning(logGame) << "Failed to pre-warm the wineserver";
+        return;
+    }
+
+    qCDebug(logGame) << "Wineserver pre-warmed for" << WINE_PREWARM_PERSIST_SECONDS << "seconds";
+    prewarmTimer.start();
+#endif
+}
+
+bool Game::isWineserverPrewarmed()
+{
+    return prewarmTimer.isValid() && prewarmTimer.elapsed() < WINE_PREWARM_PERSIST_SECONDS * 1000;
+}
+
+void Game::onApplicationStateChanged(Qt::ApplicationState state)
+{
+    if (isWaitingForWindow == false || state == Qt::ApplicationActive) {
+        return;
+    }
+
+    isWaitingForWindow = false;
+
+    // Ignore it when the user switched to another window a long time after the game started
+    if (launchTimer.elapsed() > LAUNCH_WINDOW_TIMEOUT_MS) {
+        return;
+    }
+
+    qCInfo(logGame) << "Launch latency: game window shown after" << launchTimer.elapsed() << "ms"
+            << (isWineserverPrewarmed() ? "(wineserver pre-warmed)" : "");
+}
+
 void Game::onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
 {
+    isWaitingForWindow = false;
+
+    // Summarize the resource usage of the session
+    sessionMonitor->stop();
+
+    // Read the last output
+    handleProcessOutput();
+    handleProcessError();
+
     // Check for crash
     if (exitStatus == QProcess::ExitStatus::CrashExit || exitCode != 0) {
 
@@ -164,9 +292,10 @@ void Game::onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
                 CrashDialog crashDialog(this->parentWidget);
 
                 // Check if there is process output and add it to the dialog object
-                QString stdErrorString = this->process->readAllStandardError();
+                // The process buffer is already drained so we use our own buffer
+                QString stdErrorString = QString::fromUtf8(errorBuffer.toByteArray());
                 if (stdErrorString.isEmpty() == false) {
-                    qDebug() << "Process StdError:" << stdErrorString;
+                    qCDebug(logGame) << "Process StdError:" << stdErrorString;
                     crashDialog.setStdErrorString(stdErrorString);
                 }
 
@@ -176,9 +305,74 @@ void Game::onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
         }
     }
 
+    // Close the output log
+    if (outputLogFile.isOpen()) {
+        outputLogFile.close();
+    }
+
     emit gameEnded(exitCode, exitStatus);
 }
 
+void Game::handleProcessOutput()
+{
+    QByteArray data = process->readAllStandardOutput();
+    if (data.isEmpty()) {
+        return;
+    }
+
+    outputBuffer.append(data);
+    writeOutputLogFile(data);
+    emit outputReceived(outputDecoder.decode(data));
+}
+
+void Game::handleProcessError()
+{
+    QByteArray data = process->readAllStandardError();
+    if (data.isEmpty()) {
+        return;
+    }
+
+    errorBuffer.append(data);
+    writeOutputLogFile(data);
+    emit outputReceived(errorDecoder.decode(data));
+}
+
+QString Game::getOutputTail()
+{
+    return QString::fromUtf8(outputBuffer.toByteArray() + errorBuffer.toByteArray());
+}
+
+void Game::openOutputLogFile()
+{
+    if (outputLogFile.isOpen()) {
+        outputLogFile.close();
+    }
+
+    outputLogFile.setFileName(QApplication::applicationDirPath() + "/keeperfx-game-output.log");
+
+    if (!outputLogFile.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qCWarning(logGame) << "Failed to open game output log:" << outputLogFile.fileName();
+    }
+}
+
+void Game::writeOutputLogFile(const QByteArray &data)
+{
+    if (outputLogFile.isOpen() == false) {
+        return;
+    }
+
+    // Rotate the log file when it gets too big
+    if (outputLogFile.size() + data.size() > GAME_OUTPUT_LOG_MAX_SIZE) {
+        QString filePath = outputLogFile.fileName();
+        outputLogFile.close();
+        QFile::remove(filePath + ".1");
+        QFile::rename(filePath, filePath + ".1");
+        openOutputLogFile();
+    }
+
+    outputLogFile.write(data);
+}
+
 QString Game::getErrorString()
 {
     return this->errorString;
@@ -4,6 +4,12 @@
 #include <QString>
 #include <QObject>
 #include <QProcess>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QStringDecoder>
+
+#include "gamesessionmonitor.h"
+#include "ringbuffer.h"
 
 class Game : public QObject
 {
@@ -32,14 +38,51 @@ public:
 
     QString getErrorString();
 
+    // The most recent output of the game
+    QString getOutputTail();
+
+    // Start the wineserver ahead of time so launching the game is faster
+    void prewarm();
+
 signals:
+    void gameStarting();
     void gameEnded(int exitCode, QProcess::ExitStatus exitStatus);
+    void outputReceived(const QString &output);
 
 private slots:
     void onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void handleProcessOutput();
+    void handleProcessError();
+    void onApplicationStateChanged(Qt::ApplicationState state);
 
 private:
     QWidget *parentWidget;
     QProcess *process;
     QString errorString;
+
+    // Output of the current game session
+    // Only the end is kept so long sessions do not use more memory
+    RingBuffer outputBuffer;
+    RingBuffer errorBuffer;
+
+    // Each channel keeps its own decoder state
+    // A character that is split over two reads is only decoded once it is complete
+    QStringDecoder outputDecoder{QStringDecoder::Utf8};
+    QStringDecoder errorDecoder{QStringDecoder::Utf8};
+
+    // Optional copy of the output on disk
+    QFile outputLogFile;
+
+    // Optional resource usage record of the session
+    GameSessionMonitor *sessionMonitor;
+
+    // Launch latency measurement
+    QElapsedTimer launchTimer;
+    bool isWaitingForWindow = false;
+    QElapsedTimer prewarmTimer;
+
+    bool isWineserverPrewarmed();
+
+    void openOutputLogFile();
+    void writeOutputLogFile(const QByteArray &data);
 };
@@ -0,0 +1,47 @@
+#include "gameoutputdialog.h"
+#include "ui_gameoutputdialog.h"
+
+#include <QScrollBar>
+
+GameOutputDialog::GameOutputDialog(Game *game, QWidget *parent)
+    : QDialog(parent)
+    , ui(new Ui::GameOutputDialog)
+{
+    ui->setupUi(this);
+
+    // Show the output we already have
+    appendOutput(game->getOutputTail());
+
+    // Follow the output of the game
+    connect(game, &Game::outputReceived, this, &GameOutputDialog::appendOutput);
+}
+
+GameOutputDialog::~GameOutputDialog()
+{
+    delete ui;
+}
+
+void GameOutputDialog::on_closeButton_clicked()
+{
+    this->close();
+}
+
+void GameOutputDialog::appendOutput(const QString &output)
+{
+    if (output.isEmpty()) {
+        return;
+    }
+
+    // Only follow the output if we are already at the bottom
+    QScrollBar *vScrollBar = ui->outputTextArea->verticalScrollBar();
+    bool isAtBottom = vScrollBar->value() == vScrollBar->maximum();
+
+    // Output does not always end on a full line
+    QTextCursor cursor(ui->outputTextArea->document());
+    cursor.movePosition(QTextCursor::End);
+    cursor.insertText(output);
+
+    if (isAtBottom) {
+        vScrollBar->setValue(vScrollBar->maximum());
+    }
+}
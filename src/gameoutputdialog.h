@@ -0,0 +1,23 @@
+#pragma once
+
+#include "game.h"
+
+#include <QDialog>
+
+namespace Ui { class GameOutputDialog; }
+
+class GameOutputDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit GameOutputDialog(Game *game, QWidget *parent = nullptr);
+    ~GameOutputDialog();
+
+private slots:
+    void on_closeButton_clicked();
+    void appendOutput(const QString &output);
+
+private:
+    Ui::GameOutputDialog *ui;
+};
@@ -0,0 +1,312 @@
+#include "gamesessionmonitor.h"
+#include "logcategories.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+
+#include "kfxversion.h"
+
+#ifdef Q_OS_LINUX
+    #include <unistd.h>
+#endif
+
+// Time between samples
+// Kept low so the launcher does not take CPU time away from the game
+#define SESSION_MONITOR_INTERVAL_MS 2000
+
+// Directory in the app dir where the session records are stored
+#define SESSION_MONITOR_DIR "keeperfx-sessions"
+
+GameSessionMonitor::GameSessionMonitor(QObject *parent)
+    : QObject(parent)
+{
+    sampleTimer.setInterval(SESSION_MONITOR_INTERVAL_MS);
+    connect(&sampleTimer, &QTimer::timeout, this, &GameSessionMonitor::sample);
+}
+
+bool GameSessionMonitor::isAvailable()
+{
+#ifdef Q_OS_LINUX
+    // Inside Flatpak the game runs on the host where we can not see its processes
+    return qEnvironmentVariableIsSet("FLATPAK_ID") == false && QFile::exists("/proc/self/stat");
+#else
+    return false;
+#endif
+}
+
+void GameSessionMonitor::start(qint64 rootPid, const QString &startType)
+{
+    if (isAvailable() == false) {
+        qCWarning(logGame) << "Game session monitor is not available on this system";
+        return;
+    }
+
+    this->rootPid = rootPid;
+    this->lastSampleTime = 0;
+    this->lastSamples.clear();
+    this->sampleCount = 0;
+    this->cpuPercentTotal = 0;
+    this->peakCpuPercent = 0;
+    this->peakRssBytes = 0;
+    this->peakThreadCount = 0;
+    this->peakProcessCount = 0;
+    this->totalReadBytes = 0;
+    this->totalWriteBytes = 0;
+
+    // Create the record file for this session
+    QDir appDir(QCoreApplication::applicationDirPath());
+    appDir.mkpath(SESSION_MONITOR_DIR);
+    recordFile.setFileName(appDir.absoluteFilePath(QString(SESSION_MONITOR_DIR) + "/" + QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss") + ".csv"));
+    if (!recordFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCWarning(logGame) << "Failed to open game session record:" << recordFile.fileName();
+        return;
+    }
+
+    // Write the session header
+    recordFile.write(QString("# version: %1\n").arg(KfxVersion::currentVersion.fullString).toUtf8());
+    recordFile.write(QString("# start type: %1\n").arg(startType).toUtf8());
+    recordFile.write("elapsed_ms,processes,threads,cpu_percent,rss_kb,read_kb,write_kb\n");
+
+    qCInfo(logGame) << "Game session monitor started:" << recordFile.fileName();
+
+    sessionTimer.start();
+    sample();
+    sampleTimer.start();
+}
+
+void GameSessionMonitor::stop()
+{
+    if (recordFile.isOpen() == false) {
+        return;
+    }
+
+    sampleTimer.stop();
+
+    // Summarize the session
+    double averageCpuPercent = sampleCount > 1 ? cpuPercentTotal / (sampleCount - 1) : 0;
+    QString summary = QString("duration=%1s avg_cpu=%2% peak_cpu=%3% peak_rss=%4MB peak_threads=%5 peak_processes=%6 read=%7MB written=%8MB")
+                          .arg(sessionTimer.elapsed() / 1000)
+                          .arg(averageCpuPercent, 0, 'f', 1)
+                          .arg(peakCpuPercent, 0, 'f', 1)
+                          .arg(peakRssBytes / (1024 * 1024))
+                          .arg(peakThreadCount)
+                          .arg(peakProcessCount)
+                          .arg(totalReadBytes / (1024 * 1024))
+                          .arg(totalWriteBytes / (1024 * 1024));
+
+    recordFile.write(QString("# summary: %1\n").arg(summary).toUtf8());
+    recordFile.close();
+
+    qCInfo(logGame) << "Game session summary:" << summary;
+}
+
+QList<qint64> GameSessionMonitor::getProcessTree()
+{
+    QList<qint64> pids;
+
+#ifdef Q_OS_LINUX
+    QHash<qint64, qint64> parentPids;
+    QList<qint64> wineserverPids;
+
+    // Get the parent of every process
+    const QStringList procEntries = QDir("/proc").entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const QString &entry : procEntries) {
+        bool isPid = false;
+        qint64 pid = entry.toLongLong(&isPid);
+        if (isPid == false) {
+            continue;
+        }
+
+        QFile statFile("/proc/" + entry + "/stat");
+        if (!statFile.open(QIODevice::ReadOnly)) {
+            continue;
+        }
+
+        // The name can contain spaces and brackets so we look for the last one
+        QByteArray stat = statFile.readAll();
+        qsizetype nameStart = stat.indexOf('(');
+        qsizetype nameEnd = stat.lastIndexOf(')');
+        if (nameStart == -1 || nameEnd == -1) {
+            continue;
+        }
+
+        QList<QByteArray> fields = stat.mid(nameEnd + 2).split(' ');
+        if (fields.size() > 1) {
+            parentPids.insert(pid, fields.at(1).toLongLong());
+        }
+
+        // The wineserver is not a child of the game but it does a lot of the work
+        if (stat.mid(nameStart + 1, nameEnd - nameStart - 1).startsWith("wineserver")) {
+            wineserverPids << pid;
+        }
+    }
+
+    // Add all processes that descend from the game
+    for (auto it = parentPids.constBegin(); it != parentPids.constEnd(); ++it) {
+        qint64 pid = it.key();
+        while (pid > 1 && pid != rootPid) {
+            pid = parentPids.value(pid, 0);
+        }
+        if (pid == rootPid) {
+            pids << it.key();
+        }
+    }
+
+    // Only add the wineserver of the game
+    // Other Wine programs of this or other users have their own wineserver
+    // There is one wineserver per user and prefix, and it keeps the environment it was started with
+    // The first process of the game can be gone already so we also look at its children
+    QString gameWinePrefix = getWinePrefix(rootPid);
+    for (qsizetype i = 0; i < pids.size() && gameWinePrefix.isEmpty(); i++) {
+        gameWinePrefix = getWinePrefix(pids.at(i));
+    }
+    if (gameWinePrefix.isEmpty() == false) {
+        uint userId = getuid();
+        for (qint64 pid : wineserverPids) {
+            if (pids.contains(pid) || QFileInfo("/proc/" + QString::number(pid)).ownerId() != userId) {
+                continue;
+            }
+            if (getWinePrefix(pid) == gameWinePrefix) {
+                pids << pid;
+            }
+        }
+    }
+#endif
+
+    return pids;
+}
+
+QString GameSessionMonitor::getWinePrefix(qint64 pid)
+{
+#ifdef Q_OS_LINUX
+    QFile environFile("/proc/" + QString::number(pid) + "/environ");
+    if (!environFile.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+
+    // The variables are separated by null characters
+    QString winePrefix;
+    QString homeDir;
+    const QList<QByteArray> variables = environFile.readAll().split('\0');
+    for (const QByteArray &variable : variables) {
+        if (variable.startsWith("WINEPREFIX=")) {
+            winePrefix = QString::fromLocal8Bit(variable.mid(11));
+        } else if (variable.startsWith("HOME=")) {
+            homeDir = QString::fromLocal8Bit(variable.mid(5));
+        }
+    }
+
+    // Wine uses '~/.wine' when no prefix is set
+    if (winePrefix.isEmpty()) {
+        if (homeDir.isEmpty()) {
+            return QString();
+        }
+        winePrefix = homeDir + "/.wine";
+    }
+
+    return QDir::cleanPath(winePrefix);
+#else
+    Q_UNUSED(pid);
+    return QString();
+#endif
+}
+
+void GameSessionMonitor::sample()
+{
+#ifdef Q_OS_LINUX
+    static const qint64 ticksPerSecond = sysconf(_SC_CLK_TCK);
+    static const qint64 pageSize = sysconf(_SC_PAGESIZE);
+
+    qint64 sampleTime = sessionTimer.elapsed();
+    qint64 cpuTicks = 0;
+    qint64 readBytes = 0;
+    qint64 writeBytes = 0;
+    qint64 rssBytes = 0;
+    int threadCount = 0;
+
+    QHash<qint64, ProcessSample> samples;
+
+    const QList<qint64> pids = getProcessTree();
+    for (qint64 pid : pids) {
+        QString procDir = "/proc/" + QString::number(pid);
+
+        // The process might be gone already
+        QFile statFile(procDir + "/stat");
+        if (!statFile.open(QIODevice::ReadOnly)) {
+            continue;
+        }
+
+        // Fields after the name, starting at the state (field 3 in 'man proc')
+        QByteArray stat = statFile.readAll();
+        QList<QByteArray> fields = stat.mid(stat.lastIndexOf(')') + 2).split(' ');
+        if (fields.size() < 22) {
+            continue;
+        }
+
+        ProcessSample processSample;
+        processSample.cpuTicks = fields.at(11).toLongLong() + fields.at(12).toLongLong();
+        threadCount += fields.at(17).toInt();
+        rssBytes += fields.at(21).toLongLong() * pageSize;
+
+        // I/O counters are only readable for our own processes
+        QFile ioFile(procDir + "/io");
+        if (ioFile.open(QIODevice::ReadOnly)) {
+            const QList<QByteArray> lines = ioFile.readAll().split('\n');
+            for (const QByteArray &line : lines) {
+                if (line.startsWith("read_bytes:")) {
+                    processSample.readBytes = line.mid(11).trimmed().toLongLong();
+                } else if (line.startsWith("write_bytes:")) {
+                    processSample.writeBytes = line.mid(12).trimmed().toLongLong();
+                }
+            }
+        }
+
+        // Only count what happened since the last sample
+        // Processes that started in between count from zero
+        ProcessSample lastSample = lastSamples.value(pid);
+        cpuTicks += processSample.cpuTicks - lastSample.cpuTicks;
+        readBytes += processSample.readBytes - lastSample.readBytes;
+        writeBytes += processSample.writeBytes - lastSample.writeBytes;
+
+        samples.insert(pid, processSample);
+    }
+
+    // The first sample contains everything from before the monitor started
+    bool isFirstSample = sampleCount == 0;
+    qint64 interval = sampleTime - lastSampleTime;
+    double cpuPercent = 0;
+    if (isFirstSample == false && interval > 0) {
+        cpuPercent = (cpuTicks * 1000.0 / ticksPerSecond) / interval * 100.0;
+    }
+
+    lastSamples = samples;
+    lastSampleTime = sampleTime;
+    sampleCount++;
+
+    // Update the session totals
+    if (isFirstSample == false) {
+        cpuPercentTotal += cpuPercent;
+        totalReadBytes += readBytes;
+        totalWriteBytes += writeBytes;
+    }
+    peakCpuPercent = qMax(peakCpuPercent, cpuPercent);
+    peakRssBytes = qMax(peakRssBytes, rssBytes);
+    peakThreadCount = qMax(peakThreadCount, threadCount);
+    peakProcessCount = qMax(peakProcessCount, static_cast<int>(samples.size()));
+
+    // Add the sample to the record
+    recordFile.write(QString("%1,%2,%3,%4,%5,%6,%7\n")
+                         .arg(sampleTime)
+                         .arg(samples.size())
+                         .arg(threadCount)
+                         .arg(cpuPercent, 0, 'f', 1)
+                         .arg(rssBytes / 1024)
+                         .arg(isFirstSample ? 0 : readBytes / 1024)
+                         .arg(isFirstSample ? 0 : writeBytes / 1024)
+                         .toUtf8());
+    recordFile.flush();
+#endif
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QObject>
+#include <QTimer>
+
+// Samples the resource usage of the game process tree while the game runs
+// Only available on Linux as it reads everything from /proc
+class GameSessionMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit GameSessionMonitor(QObject *parent = nullptr);
+
+    static bool isAvailable();
+
+    void start(qint64 rootPid, const QString &startType);
+    void stop();
+
+private slots:
+    void sample();
+
+private:
+    // Counters of a single process at the time of a sample
+    struct ProcessSample
+    {
+        qint64 cpuTicks = 0;
+        qint64 readBytes = 0;
+        qint64 writeBytes = 0;
+    };
+
+    QTimer sampleTimer;
+    QElapsedTimer sessionTimer;
+    qint64 rootPid = 0;
+    qint64 lastSampleTime = 0;
+    QFile recordFile;
+
+    // Counters of the previous sample so we can calculate the usage in between
+    QHash<qint64, ProcessSample> lastSamples;
+
+    // Session totals and peaks
+    int sampleCount = 0;
+    double cpuPercentTotal = 0;
+    double peakCpuPercent = 0;
+    qint64 peakRssBytes = 0;
+    int peakThreadCount = 0;
+    int peakProcessCount = 0;
+    qint64 totalReadBytes = 0;
+    qint64 totalWriteBytes = 0;
+
+    QList<qint64> getProcessTree();
+
+    // Wine prefix a process uses, empty if we can not read its environment
+    static QString getWinePrefix(qint64 pid);
+};
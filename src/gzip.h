@@ -1,7 +1,15 @@
 #pragma once
 
+#include "taskscheduler.h"
+
 #include <QByteArray>
+#include <QByteArrayView>
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFuture>
+#include <QList>
+#include <QThread>
 
 #ifdef USE_QT_ZLIB
     #include <QtZlib/zlib.h>
@@ -9,6 +17,15 @@
     #include <zlib.h>
 #endif
 
+// Size of the blocks that are compressed in parallel
+#define GZIP_BLOCK_SIZE (256 * 1024)
+
+// Amount of data before a block that is used to prime its compression
+#define GZIP_DICTIONARY_SIZE (32 * 1024)
+
+// Default time we want to spend on compressing
+#define GZIP_DEFAULT_TIME_BUDGET_MS 1000
+
 namespace GZip {
 
     /**
@@ -96,4 +113,330 @@ namespace GZip {
         return output;
     }
 
+    /**
+     * Picks a compression level that is expected to finish within a time budget.
+     *
+     * The estimates use rough deflate speeds for text logs on a single core.
+     * Multiple cores are taken into account because the blocks are compressed in parallel.
+     * Only the blocks of a single compress() call run at the same time, so small chunks use fewer cores.
+     *
+     * @param inputSize    Size of the data that will be compressed
+     * @param timeBudgetMs Time we want to spend on compressing
+     * @param chunkSize    Size of the input passed to each compress() call, 0 if it is passed at once
+     * @return Compression level
+     */
+    inline int chooseCompressionLevel(qint64 inputSize, int timeBudgetMs = GZIP_DEFAULT_TIME_BUDGET_MS, qint64 chunkSize = 0)
+    {
+        // Rough speed in bytes per millisecond per core
+        static const QList<QPair<int, qint64>> levelSpeeds = {
+            {Z_BEST_COMPRESSION, 8 * 1024},
+            {6, 25 * 1024},
+            {Z_BEST_SPEED, 80 * 1024},
+        };
+
+        if (chunkSize <= 0) {
+            chunkSize = inputSize;
+        }
+        qint64 blocksPerChunk = (chunkSize + GZIP_BLOCK_SIZE - 1) / GZIP_BLOCK_SIZE;
+        qint64 cores = qBound<qint64>(1, blocksPerChunk, qMax(1, QThread::idealThreadCount()));
+        for (const auto &levelSpeed : levelSpeeds) {
+            if (inputSize / (levelSpeed.second * cores) <= timeBudgetMs) {
+                return levelSpeed.first;
+            }
+        }
+
+        return Z_BEST_SPEED;
+    }
+
+    /**
+     * Compresses data using gzip in chunks.
+     *
+     * Large inputs can be compressed without having all of the input or output in memory.
+     * Call compress() for every chunk of input and finish() once at the end.
+     *
+     * Like pigz the input is split into blocks that are deflated on worker threads.
+     * Every block is primed with the end of the previous block so the ratio stays close
+     * to a single deflate stream. The blocks are byte aligned using a sync flush which
+     * makes their concatenation a valid deflate stream.
+     */
+    class StreamCompressor
+    {
+    public:
+        explicit StreamCompressor(int level = Z_DEFAULT_COMPRESSION)
+            : level(level)
+        {}
+
+        StreamCompressor(const StreamCompressor &) = delete;
+        StreamCompressor &operator=(const StreamCompressor &) = delete;
+
+        bool isValid() const { return valid; }
+
+        /**
+         * Compresses a chunk of input.
+         *
+         * @param input Raw input data
+         * @return Compressed data that is ready, can be empty
+         */
+        QByteArray compress(QByteArrayView input)
+        {
+            if (!valid || ended) {
+                return {};
+            }
+
+            QByteArray output = takeHeader();
+
+            // Split the input into blocks
+            QList<QByteArrayView> blocks;
+            for (qsizetype pos = 0; pos < input.size(); pos += GZIP_BLOCK_SIZE) {
+                blocks << input.sliced(pos, qMin<qsizetype>(GZIP_BLOCK_SIZE, input.size() - pos));
+            }
+
+            // Deflate the blocks in parallel
+            // Small inputs are done right away as starting a thread would take longer
+            QList<QFuture<Block>> futures;
+            QList<Block> results;
+            for (const QByteArrayView &block : std::as_const(blocks)) {
+                QByteArrayView dictionary = getDictionary(input, block);
+                if (blocks.size() > 1) {
+                    int level = this->level;
+                    futures << TaskScheduler::run(TaskScheduler::Pool::CPU, [block, dictionary, level]() { return deflateBlock(block, dictionary, level); });
+                } else {
+                    results << deflateBlock(block, dictionary, level);
+                }
+            }
+            for (QFuture<Block> &future : futures) {
+                results << future.result();
+            }
+
+            // Join the blocks in order
+            for (int i = 0; i < results.size(); ++i) {
+                const Block &result = results.at(i);
+                if (result.isValid == false) {
+                    qWarning() << "GZip::StreamCompressor: deflate failed";
+                    valid = false;
+                    return {};
+                }
+                output.append(result.data);
+                crc = crc32_combine(crc, result.crc, static_cast<z_off_t>(blocks.at(i).size()));
+                inputSize += blocks.at(i).size();
+            }
+
+            // Remember the end of the input for the first block of the next chunk
+            if (input.size() >= GZIP_DICTIONARY_SIZE) {
+                lastInput = input.last(GZIP_DICTIONARY_SIZE).toByteArray();
+            } else {
+                lastInput = (lastInput + input.toByteArray()).right(GZIP_DICTIONARY_SIZE);
+            }
+
+            return output;
+        }
+
+        /**
+         * Finishes the gzip stream.
+         *
+         * @return The remaining compressed data
+         */
+        QByteArray finish()
+        {
+            if (!valid || ended) {
+                return {};
+            }
+            ended = true;
+
+            QByteArray output = takeHeader();
+
+            // Empty final block
+            output.append("\x03\x00", 2);
+
+            // Trailer: CRC32 and input size (little endian)
+            for (int i = 0; i < 4; ++i) {
+                output.append(static_cast<char>((crc >> (8 * i)) & 0xFF));
+            }
+            for (int i = 0; i < 4; ++i) {
+                output.append(static_cast<char>((inputSize >> (8 * i)) & 0xFF));
+            }
+
+            return output;
+        }
+
+    private:
+        struct Block
+        {
+            bool isValid = false;
+            QByteArray data;
+            uLong crc = 0;
+        };
+
+        int level;
+        bool valid = true;
+        bool ended = false;
+        bool isHeaderWritten = false;
+        uLong crc = crc32(0L, Z_NULL, 0);
+        quint64 inputSize = 0;
+        QByteArray lastInput;
+
+        QByteArray takeHeader()
+        {
+            if (isHeaderWritten) {
+                return {};
+            }
+            isHeaderWritten = true;
+
+            // Minimal gzip header: deflate, no flags, no time, unknown OS
+            return QByteArray("\x1f\x8b\x08\x00\x00\x00\x00\x00\x00\xff", 10);
+        }
+
+        // The data right before a block, used to prime the deflate of that block
+        QByteArrayView getDictionary(QByteArrayView input, QByteArrayView block) const
+        {
+            qsizetype blockStart = block.data() - input.data();
+            if (blockStart > 0) {
+                qsizetype dictionaryStart = qMax<qsizetype>(0, blockStart - GZIP_DICTIONARY_SIZE);
+                return input.sliced(dictionaryStart, blockStart - dictionaryStart);
+            }
+
+            return QByteArrayView(lastInput);
+        }
+
+        static Block deflateBlock(QByteArrayView block, QByteArrayView dictionary, int level)
+        {
+            Block result;
+            result.crc = crc32(crc32(0L, Z_NULL, 0), reinterpret_cast<const Bytef *>(block.data()), static_cast<uInt>(block.size()));
+
+            // Raw deflate without a header
+            z_stream strm{};
+            if (deflateInit2(&strm, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+                return result;
+            }
+
+            if (dictionary.isEmpty() == false) {
+                deflateSetDictionary(&strm, reinterpret_cast<const Bytef *>(dictionary.data()), static_cast<uInt>(dictionary.size()));
+            }
+
+            // The sync flush adds a few bytes on top of the bound
+            result.data.resize(deflateBound(&strm, block.size()) + 16);
+
+            strm.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(block.data()));
+            strm.avail_in = static_cast<uInt>(block.size());
+            strm.next_out = reinterpret_cast<Bytef *>(result.data.data());
+            strm.avail_out = static_cast<uInt>(result.data.size());
+
+            int ret = deflate(&strm, Z_SYNC_FLUSH);
+            result.isValid = ret == Z_OK && strm.avail_in == 0 && strm.avail_out != 0;
+            result.data.resize(strm.total_out);
+
+            deflateEnd(&strm);
+            return result;
+        }
+    };
+
+    /**
+     * Compresses input data using gzip on multiple threads.
+     *
+     * @param input        Raw input data
+     * @param timeBudgetMs Time we want to spend on compressing, used to choose the level
+     * @return Gzipped QByteArray, or empty if compression failed
+     */
+    inline QByteArray compressParallel(const QByteArray &input, int timeBudgetMs = GZIP_DEFAULT_TIME_BUDGET_MS)
+    {
+        if (input.isEmpty()) {
+            qWarning() << "GZip::CompressParallel: input is empty";
+            return {};
+        }
+
+        StreamCompressor compressor(chooseCompressionLevel(input.size(), timeBudgetMs));
+        QByteArray output = compressor.compress(input);
+        output.append(compressor.finish());
+
+        if (compressor.isValid() == false) {
+            return {};
+        }
+
+        return output;
+    }
+
+    /**
+     * Decompresses gzip data.
+     *
+     * @param input Gzipped data
+     * @return Raw data, or empty if decompression failed
+     */
+    inline QByteArray decompress(const QByteArray &input)
+    {
+        z_stream strm{};
+        if (inflateInit2(&strm, 15 + 16) != Z_OK) {
+            qWarning() << "GZip::Decompress: inflateInit2 failed";
+            return {};
+        }
+
+        strm.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(input.constData()));
+        strm.avail_in = static_cast<uInt>(input.size());
+
+        QByteArray output;
+        char buffer[64 * 1024];
+        int ret;
+        do {
+            strm.next_out = reinterpret_cast<Bytef *>(buffer);
+            strm.avail_out = sizeof(buffer);
+            ret = inflate(&strm, Z_NO_FLUSH);
+            if (ret != Z_OK && ret != Z_STREAM_END) {
+                qWarning() << "GZip::Decompress: inflate failed with code" << ret;
+                inflateEnd(&strm);
+                return {};
+            }
+            output.append(buffer, sizeof(buffer) - strm.avail_out);
+        } while (ret != Z_STREAM_END);
+
+        inflateEnd(&strm);
+        return output;
+    }
+
+    /**
+     * Compares the single threaded and the parallel compression of a file.
+     *
+     * The results are written to the log.
+     *
+     * @param filePath File to compress
+     * @return False if the file could not be read or the output is not valid
+     */
+    inline bool benchmark(const QString &filePath)
+    {
+        QFile file(filePath);
+        if (!file.open(QIODevice::ReadOnly)) {
+            qWarning() << "GZip::Benchmark: failed to open" << filePath;
+            return false;
+        }
+        QByteArray input = file.readAll();
+
+        QElapsedTimer timer;
+        bool isValid = true;
+
+        // Single threaded at every level and parallel with the level picked for us
+        for (int level : {Z_BEST_SPEED, 6, Z_BEST_COMPRESSION, -1}) {
+            timer.start();
+            QByteArray output;
+            if (level == -1) {
+                output = compressParallel(input);
+            } else {
+                output = compress(input, level);
+            }
+            qint64 compressTime = timer.elapsed();
+
+            // Make sure the output decompresses to the input again
+            bool isRoundTripValid = decompress(output) == input;
+            isValid = isValid && isRoundTripValid;
+
+            qInfo().noquote() << QString("GZip::Benchmark: %1: %2 -> %3 bytes (%4%) in %5 ms%6")
+                                     .arg(level == -1 ? QString("parallel (level %1, %2 threads)").arg(chooseCompressionLevel(input.size())).arg(QThread::idealThreadCount())
+                                                      : QString("level %1").arg(level))
+                                     .arg(input.size())
+                                     .arg(output.size())
+                                     .arg(input.isEmpty() ? 0.0 : output.size() * 100.0 / input.size(), 0, 'f', 1)
+                                     .arg(compressTime)
+                                     .arg(isRoundTripValid ? "" : " [INVALID]");
+        }
+
+        return isValid;
+    }
+
 }
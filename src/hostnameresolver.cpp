@@ -0,0 +1,46 @@
+#include "hostnameresolver.h"
+#include "logcategories.h"
+
+#include <QDebug>
+#include <QHostInfo>
+
+// How long resolved hostnames are cached
+#define HOSTNAME_CACHE_TTL_MS (5 * 60 * 1000)
+
+// How long failed lookups are cached
+#define HOSTNAME_CACHE_FAILED_TTL_MS (30 * 1000)
+
+QHash<QString, HostnameResolver::CacheEntry> HostnameResolver::cache;
+
+QString HostnameResolver::getCachedHostname(const QString &ip)
+{
+    auto it = cache.constFind(ip);
+    if (it == cache.constEnd() || it->expiry.hasExpired()) {
+        return QString();
+    }
+
+    return it->hostname;
+}
+
+void HostnameResolver::resolve(const QString &ip, QObject *context, std::function<void(const QString &hostname)> callback)
+{
+    // Use the cached hostname
+    auto it = cache.constFind(ip);
+    if (it != cache.constEnd() && it->expiry.hasExpired() == false) {
+        callback(it->hostname);
+        return;
+    }
+
+    // Do a reverse lookup in the background
+    QHostInfo::lookupHost(ip, context, [ip, callback](const QHostInfo &hostInfo) {
+        bool isResolved = hostInfo.error() == QHostInfo::NoError && hostInfo.hostName().isEmpty() == false;
+
+        // Without a hostname we simply show the IP
+        QString hostname = isResolved ? hostInfo.hostName() : ip;
+        cache.insert(ip, {hostname, QDeadlineTimer(isResolved ? HOSTNAME_CACHE_TTL_MS : HOSTNAME_CACHE_FAILED_TTL_MS)});
+
+        qCDebug(logNet) << "Hostname resolved:" << ip << "->" << hostname;
+
+        callback(hostname);
+    });
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <QDeadlineTimer>
+#include <QHash>
+#include <QObject>
+#include <QString>
+
+#include <functional>
+
+class HostnameResolver
+{
+public:
+    // Returns the cached hostname of an IP address or an empty string
+    static QString getCachedHostname(const QString &ip);
+
+    // Resolves the hostname of an IP address without blocking
+    // The callback is called from the event loop of the context object
+    // It is called right away when the hostname is cached
+    static void resolve(const QString &ip, QObject *context, std::function<void(const QString &hostname)> callback);
+
+private:
+    // A resolved hostname and when it should be resolved again
+    struct CacheEntry
+    {
+        QString hostname;
+        QDeadlineTimer expiry;
+    };
+
+    static QHash<QString, CacheEntry> cache;
+};
@@ -1,23 +1,47 @@
 #pragma once
 
 #include "launcheroptions.h"
+#include "logcategories.h"
 
+#include <QBuffer>
+#include <QCache>
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
 #include <QDir>
 #include <QEventLoop>
+#include <QFileInfo>
 #include <QImage>
+#include <QImageReader>
+#include <QImageWriter>
+#include <QMap>
+#include <QMutex>
 #include <QNetworkAccessManager>
 #include <QNetworkReply>
 #include <QNetworkRequest>
 #include <QObject>
-#include <QPainter>
+#include <QPixmap>
 #include <QProcess>
+#include <QSaveFile>
 #include <QString>
 #include <QVariant>
 
+#include <algorithm>
+
+// Maximum size of the images in the disk cache
+#define IMAGE_DISK_CACHE_MAX_SIZE (50 * 1024 * 1024)
+
+// Maximum size of the decoded images in the memory cache
+#define IMAGE_MEMORY_CACHE_MAX_SIZE (32 * 1024 * 1024)
+
+// Version of the disk cache index
+#define IMAGE_DISK_CACHE_INDEX_VERSION 1
+
 class ImageHelper
 {
 public:
-    static QImage download(QUrl url)
+    static QByteArray downloadData(QUrl url)
     {
         // Initialize the network request and manager
         QNetworkRequest request(url);
@@ -33,89 +57,402 @@ public:
 
         // Check for errors
         if (reply->error() != QNetworkReply::NoError) {
-            qWarning() << "Failed to download image from" << url.toString() << ":" << reply->errorString();
+            qCWarning(logNet) << "Failed to download image from" << url.toString() << ":" << reply->errorString();
             reply->deleteLater();
-            return QImage(); // Return an empty image on failure
+            return QByteArray(); // Return empty data on failure
         }
 
-        // Load the image from the reply data
+        // Clean up and return the data
         QByteArray imageData = reply->readAll();
+        reply->deleteLater();
+        return imageData;
+    }
+
+    static QImage download(QUrl url)
+    {
+        QByteArray imageData = downloadData(url);
+        if (imageData.isEmpty()) {
+            return QImage();
+        }
+
+        // Load the image from the data
         QImage image;
         if (!image.loadFromData(imageData)) {
-            qWarning() << "Failed to load image from data";
-            reply->deleteLater();
+            qCWarning(logNet) << "Failed to load image from data";
             return QImage(); // Return an empty image if the loading failed
         }
 
-        // Clean up and return the image
-        reply->deleteLater();
         return image;
     }
 
-    static QPixmap getOnlineScaledPixmap(QUrl url, QSize targetSize)
+    static QImage getOnlineScaledImage(QUrl url, QSize targetSize)
     {
-        QPixmap imagePixmap;
+        // This function is safe to call from worker threads
+        // That's why it returns a QImage instead of a QPixmap
 
-        // Create a dedicated temp directory
-        QString cacheDir = QDir::temp().filePath("kfx-launcher-img-cache");
-        QDir().mkpath(cacheDir); // Ensure the directory exists
+        QString cacheKey = QString("%1|%2x%3").arg(url.toString()).arg(targetSize.width()).arg(targetSize.height());
 
-        // Generate a shorter hash (using first 16 chars of SHA-256) for caching
-        QByteArray urlHash = QCryptographicHash::hash(url.toString().toUtf8(), QCryptographicHash::Sha256).toHex().left(16);
+        // Check if image is in the memory cache
+        QImage image = getFromMemoryCache(cacheKey);
+        if (image.isNull() == false) {
+            return image;
+        }
 
         // Get image file extension
-        QString ext = QFileInfo(url.toString()).suffix();
-        if (ext.isEmpty()) {
+        QString ext = QFileInfo(url.path()).suffix().toLower();
+        if (ext.isEmpty() || QImageWriter::supportedImageFormats().contains(ext.toLatin1()) == false) {
             ext = "png"; // Default to PNG if no extension found
         }
 
-        // Get image cache path
-        QString cachePath = cacheDir + "/" + urlHash + "_" + QString::number(targetSize.width()) + "x" + QString::number(targetSize.height()) + "." + ext;
+        // Get image cache file name
+        // Generate a shorter hash (using first 16 chars of SHA-256) for caching
+        QByteArray urlHash = QCryptographicHash::hash(url.toString().toUtf8(), QCryptographicHash::Sha256).toHex().left(16);
+        QString cacheFileName = urlHash + "_" + QString::number(targetSize.width()) + "x" + QString::number(targetSize.height()) + "." + ext;
 
-        // Check if image is cached
-        if (QFile::exists(cachePath) && LauncherOptions::isSet("no-image-cache") == false) {
-            imagePixmap.load(cachePath);
-            qDebug() << "Image loaded from cache:" << cachePath;
-            return imagePixmap;
+        // Check if image is cached on disk
+        bool useDiskCache = LauncherOptions::isSet("no-image-cache") == false;
+        if (useDiskCache) {
+            image = getFromDiskCache(cacheFileName);
         }
 
-        // Download image
-        QImage image;
-        image = download(url);
+        if (image.isNull()) {
+            // Download image
+            QByteArray imageData = downloadData(url);
+            if (imageData.isEmpty()) {
+                qCWarning(logNet) << "Failed to download image:" << url;
+                return QImage();
+            }
+
+            // Decode the image at its final size
+            QBuffer buffer(&imageData);
+            QImageReader reader(&buffer);
+            image = readScaledImage(reader, targetSize);
+            if (image.isNull()) {
+                qCWarning(logNet) << "Failed to load image:" << url << reader.errorString();
+                return QImage();
+            }
+
+            // Cache the image on disk
+            if (useDiskCache) {
+                addToDiskCache(cacheFileName, image, ext);
+            }
+        }
+
+        addToMemoryCache(cacheKey, image);
+
+        return image;
+    }
+
+    static QImage getLocalScaledImage(const QString &filePath, QSize targetSize)
+    {
+        // This function is safe to call from worker threads
+        // That's why it returns a QImage instead of a QPixmap
+
+        // Get file info
+        QFileInfo fileInfo(filePath);
+        if (fileInfo.exists() == false) {
+            qCWarning(logNet) << "Image does not exist:" << filePath;
+            return QImage();
+        }
+
+        // Create a cache key from the file, its modification time and the target size
+        // A changed file automatically gets a new key
+        QString cacheKey = QString("%1|%2|%3|%4x%5")
+                               .arg(fileInfo.absoluteFilePath())
+                               .arg(fileInfo.lastModified().toMSecsSinceEpoch())
+                               .arg(fileInfo.size())
+                               .arg(targetSize.width())
+                               .arg(targetSize.height());
+
+        // Check if image is in the memory cache
+        QImage image = getFromMemoryCache(cacheKey);
+        if (image.isNull() == false) {
+            return image;
+        }
+
+        // Get image cache file name
+        QByteArray keyHash = QCryptographicHash::hash(cacheKey.toUtf8(), QCryptographicHash::Sha256).toHex().left(16);
+        QString cacheFileName = "local_" + keyHash + ".png";
+
+        // Check if image is cached on disk
+        bool useDiskCache = LauncherOptions::isSet("no-image-cache") == false;
+        if (useDiskCache) {
+            image = getFromDiskCache(cacheFileName);
+        }
+
+        if (image.isNull()) {
+            // Decode the image at its final size
+            QImageReader reader(filePath);
+            image = readScaledImage(reader, targetSize);
+            if (image.isNull()) {
+                qCWarning(logNet) << "Failed to load image:" << filePath << reader.errorString();
+                return QImage();
+            }
+
+            // Cache the image on disk
+            if (useDiskCache) {
+                addToDiskCache(cacheFileName, image, "png");
+            }
+        }
+
+        addToMemoryCache(cacheKey, image);
+
+        return image;
+    }
+
+private:
+    struct DiskCacheEntry
+    {
+        qint64 size = 0;
+        qint64 lastUsed = 0;
+    };
+
+    // Index of the disk cache
+    // Used to remove the least recently used images when the cache gets too big
+    struct DiskCache
+    {
+        bool isLoaded = false;
+        bool isDirty = false;
+        QMap<QString, DiskCacheEntry> entries;
+        qint64 totalSize = 0;
+    };
+
+    static QImage readScaledImage(QImageReader &reader, QSize targetSize)
+    {
+        // Decode the image directly at the size we need
+        // This is a lot faster and uses less memory than decoding at full resolution and scaling afterwards
+        QSize scaledSize;
+        if (reader.size().isValid()) {
+            scaledSize = reader.size().scaled(targetSize, Qt::KeepAspectRatioByExpanding);
+            reader.setScaledSize(scaledSize);
+        }
+
+        QImage scaledImage = reader.read();
+        if (scaledImage.isNull()) {
+            return QImage();
+        }
+
+        // Scale if the image format does not support scaled decoding
+        if (scaledImage.size() != scaledSize) {
+            scaledImage = scaledImage.scaled(targetSize, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
+        }
+
+        // Center-crop the image to the target size
+        return scaledImage.copy((scaledImage.width() - targetSize.width()) / 2,
+            (scaledImage.height() - targetSize.height()) / 2,
+            targetSize.width(),
+            targetSize.height());
+    }
+
+    // Memory cache shared by all widgets
+    // The cost of an image is its size in KB
+    static QCache<QString, QImage> &getMemoryCache()
+    {
+        static QCache<QString, QImage> memoryCache(IMAGE_MEMORY_CACHE_MAX_SIZE / 1024);
+        return memoryCache;
+    }
+
+    static QMutex &getMemoryCacheMutex()
+    {
+        static QMutex memoryCacheMutex;
+        return memoryCacheMutex;
+    }
+
+    static QImage getFromMemoryCache(const QString &cacheKey)
+    {
+        QMutexLocker locker(&getMemoryCacheMutex());
+        if (QImage *cachedImage = getMemoryCache().object(cacheKey)) {
+            return *cachedImage;
+        }
+        return QImage();
+    }
+
+    static void addToMemoryCache(const QString &cacheKey, const QImage &image)
+    {
+        QMutexLocker locker(&getMemoryCacheMutex());
+        getMemoryCache().insert(cacheKey, new QImage(image), qMax<qsizetype>(1, image.sizeInBytes() / 1024));
+    }
+
+    static QString getDiskCacheDir()
+    {
+        return QDir::temp().filePath("kfx-launcher-img-cache");
+    }
 
-        // Get if image was downloaded
-        if (image.isNull() == true) {
-            qWarning() << "Failed to download image:" << url;
-            return QPixmap();
+    static QMutex &getDiskCacheMutex()
+    {
+        static QMutex diskCacheMutex;
+        return diskCacheMutex;
+    }
+
+    static DiskCache &getDiskCache()
+    {
+        static DiskCache diskCache;
+
+        // Load the index the first time we need it
+        // The mutex has to be locked by the caller
+        if (diskCache.isLoaded == false) {
+            diskCache.isLoaded = true;
+            loadDiskCacheIndex(diskCache);
+
+            // Save the last use of the images when the app closes
+            qAddPostRoutine(saveDirtyDiskCacheIndex);
         }
 
-        // Create image pixmap
-        QPixmap scaledPixmap = QPixmap::fromImage(image).scaled(targetSize, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
-        if (scaledPixmap.isNull() == true) {
-            qWarning() << "Failed to convert image to pixmap:" << url;
-            return QPixmap();
+        return diskCache;
+    }
+
+    static void loadDiskCacheIndex(DiskCache &diskCache)
+    {
+        QDir cacheDir(getDiskCacheDir());
+        QDir().mkpath(cacheDir.path());
+
+        // Read the last use of the images from the index
+        QMap<QString, qint64> lastUsedMap;
+        QFile indexFile(cacheDir.filePath("index.dat"));
+        if (indexFile.open(QIODevice::ReadOnly)) {
+            QDataStream stream(&indexFile);
+            int version = 0;
+            stream >> version;
+            if (version == IMAGE_DISK_CACHE_INDEX_VERSION) {
+                stream >> lastUsedMap;
+            }
+            if (stream.status() != QDataStream::Ok) {
+                lastUsedMap.clear();
+            }
         }
 
-        // Create a final pixmap and center-crop it
-        imagePixmap = QPixmap(targetSize);
-        imagePixmap.fill(Qt::transparent); // Optional, use Qt::black or similar for background
+        // Add the files that are actually there
+        // Files from before the index existed are added using their modification time
+        const QFileInfoList fileInfoList = cacheDir.entryInfoList(QDir::Files);
+        for (const QFileInfo &fileInfo : fileInfoList) {
+            if (fileInfo.fileName() == "index.dat") {
+                continue;
+            }
 
-        // Paint the image in the center
-        QPainter painter(&imagePixmap);
-        //painter.setRenderHint(QPainter::SmoothPixmapTransform, true);
-        painter.drawPixmap((targetSize.width() - scaledPixmap.width()) / 2, (targetSize.height() - scaledPixmap.height()) / 2, scaledPixmap);
-        painter.end();
+            DiskCacheEntry entry;
+            entry.size = fileInfo.size();
+            entry.lastUsed = lastUsedMap.value(fileInfo.fileName(), fileInfo.lastModified().toMSecsSinceEpoch());
+            diskCache.entries.insert(fileInfo.fileName(), entry);
+            diskCache.totalSize += entry.size;
+        }
 
-        // Cache the image pixmap
-        if (LauncherOptions::isSet("no-image-cache") == false) {
-            if (imagePixmap.save(cachePath, ext.toUpper().toLatin1().constData())) {
-                qDebug() << "Image saved in cache:" << cachePath;
-            } else {
-                qDebug() << "Failed to cache image pixmap:" << cachePath;
+        if (evictFromDiskCache(diskCache) || diskCache.entries.size() != lastUsedMap.size()) {
+            saveDiskCacheIndex(diskCache);
+        }
+    }
+
+    static void saveDirtyDiskCacheIndex()
+    {
+        QMutexLocker locker(&getDiskCacheMutex());
+        DiskCache &diskCache = getDiskCache();
+        if (diskCache.isDirty) {
+            saveDiskCacheIndex(diskCache);
+        }
+    }
+
+    static void saveDiskCacheIndex(DiskCache &diskCache)
+    {
+        diskCache.isDirty = false;
+
+        QMap<QString, qint64> lastUsedMap;
+        for (auto it = diskCache.entries.cbegin(); it != diskCache.entries.cend(); ++it) {
+            lastUsedMap.insert(it.key(), it.value().lastUsed);
+        }
+
+        QSaveFile indexFile(QDir(getDiskCacheDir()).filePath("index.dat"));
+        if (indexFile.open(QIODevice::WriteOnly) == false) {
+            qCWarning(logNet) << "Failed to open image cache index:" << indexFile.fileName();
+            return;
+        }
+
+        QDataStream stream(&indexFile);
+        stream << int(IMAGE_DISK_CACHE_INDEX_VERSION) << lastUsedMap;
+
+        if (indexFile.commit() == false) {
+            qCWarning(logNet) << "Failed to save image cache index:" << indexFile.fileName();
+        }
+    }
+
+    // Removes the least recently used images until the cache fits
+    static bool evictFromDiskCache(DiskCache &diskCache)
+    {
+        if (diskCache.totalSize <= IMAGE_DISK_CACHE_MAX_SIZE) {
+            return false;
+        }
+
+        // Sort the images by their last use once and remove the oldest first
+        QList<std::pair<qint64, QString>> lastUsedList;
+        lastUsedList.reserve(diskCache.entries.size());
+        for (auto it = diskCache.entries.cbegin(); it != diskCache.entries.cend(); ++it) {
+            lastUsedList.append({it.value().lastUsed, it.key()});
+        }
+        std::sort(lastUsedList.begin(), lastUsedList.end());
+
+        QDir cacheDir(getDiskCacheDir());
+        for (const auto &[lastUsed, cacheFileName] : std::as_const(lastUsedList)) {
+            if (diskCache.totalSize <= IMAGE_DISK_CACHE_MAX_SIZE) {
+                break;
+            }
+
+            QFile::remove(cacheDir.filePath(cacheFileName));
+            qCDebug(logNet) << "Image removed from cache:" << cacheFileName;
+
+            diskCache.totalSize -= diskCache.entries.take(cacheFileName).size;
+        }
+
+        return true;
+    }
+
+    static QImage getFromDiskCache(const QString &cacheFileName)
+    {
+        QString cachePath = QDir(getDiskCacheDir()).filePath(cacheFileName);
+
+        {
+            QMutexLocker locker(&getDiskCacheMutex());
+            DiskCache &diskCache = getDiskCache();
+
+            auto it = diskCache.entries.find(cacheFileName);
+            if (it == diskCache.entries.end()) {
+                return QImage();
             }
+
+            // Mark the image as recently used
+            // This is only saved with the next change to the cache or when the app closes
+            it.value().lastUsed = QDateTime::currentMSecsSinceEpoch();
+            diskCache.isDirty = true;
         }
 
-        // Return the image pixmap
-        return imagePixmap;
+        QImage image;
+        if (image.load(cachePath) == false) {
+            return QImage();
+        }
+
+        qCDebug(logNet) << "Image loaded from cache:" << cachePath;
+        return image;
+    }
+
+    static void addToDiskCache(const QString &cacheFileName, const QImage &image, const QString &format)
+    {
+        QString cachePath = QDir(getDiskCacheDir()).filePath(cacheFileName);
+
+        QMutexLocker locker(&getDiskCacheMutex());
+        DiskCache &diskCache = getDiskCache();
+
+        if (image.save(cachePath, format.toUpper().toLatin1().constData()) == false) {
+            qCDebug(logNet) << "Failed to cache image:" << cachePath;
+            return;
+        }
+
+        qCDebug(logNet) << "Image saved in cache:" << cachePath;
+
+        // Add the image to the index
+        DiskCacheEntry &entry = diskCache.entries[cacheFileName];
+        diskCache.totalSize -= entry.size;
+        entry.size = QFileInfo(cachePath).size();
+        entry.lastUsed = QDateTime::currentMSecsSinceEpoch();
+        diskCache.totalSize += entry.size;
+
+        evictFromDiskCache(diskCache);
+        saveDiskCacheIndex(diskCache);
     }
 };
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QDebug>
+#include <QFile>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+#include <cstring>
+
+namespace IniReader {
+
+    /**
+     * Tokenizes INI data without allocating.
+     *
+     * The callback is called for every 'key = value' pair with views into the given data:
+     * bool callback(QByteArrayView section, QByteArrayView key, QByteArrayView value)
+     * Tokenizing stops as soon as the callback returns false.
+     *
+     * @param data     Raw INI data
+     * @param callback Callback for every key value pair
+     */
+    template<typename Callback>
+    inline void tokenize(QByteArrayView data, Callback &&callback)
+    {
+        const char *pos = data.data();
+        const char *end = pos + data.size();
+
+        // Skip UTF-8 BOM
+        if (data.startsWith("\xEF\xBB\xBF")) {
+            pos += 3;
+        }
+
+        QByteArrayView section;
+
+        while (pos < end) {
+            // Get the current line
+            const char *newline = static_cast<const char *>(std::memchr(pos, '\n', end - pos));
+            const char *lineEnd = newline ? newline : end;
+            QByteArrayView line = QByteArrayView(pos, lineEnd - pos).trimmed();
+            pos = newline ? newline + 1 : end;
+
+            // Skip empty lines or comments
+            if (line.isEmpty() || line.front() == ';' || line.front() == '#') {
+                continue;
+            }
+
+            // Section
+            if (line.front() == '[') {
+                if (line.back() == ']') {
+                    section = line.sliced(1, line.size() - 2).trimmed();
+                }
+                continue;
+            }
+
+            // Split the line into key and value
+            const char *equals = static_cast<const char *>(std::memchr(line.data(), '=', line.size()));
+            if (equals == nullptr || equals == line.data()) {
+                continue;
+            }
+            qsizetype equalsIndex = equals - line.data();
+            QByteArrayView key = line.first(equalsIndex).trimmed();
+            QByteArrayView value = line.sliced(equalsIndex + 1).trimmed();
+
+            // Remove surrounding quotes
+            if (value.size() >= 2 && value.front() == '"' && value.back() == '"') {
+                value = value.sliced(1, value.size() - 2);
+            }
+
+            if (callback(section, key, value) == false) {
+                return;
+            }
+        }
+    }
+
+    /**
+     * Tokenizes an INI file.
+     *
+     * The file is memory mapped when possible so only the part of the file
+     * that is tokenized before the callback stops has to be read from disk.
+     *
+     * @param filePath Path to the INI file
+     * @param callback Callback for every key value pair (see tokenize())
+     * @return False if the file could not be opened
+     */
+    template<typename Callback>
+    inline bool tokenizeFile(const QString &filePath, Callback &&callback)
+    {
+        QFile file(filePath);
+        if (!file.open(QIODevice::ReadOnly)) {
+            qWarning() << "IniReader: failed to open:" << filePath;
+            return false;
+        }
+
+        // Empty files can not be mapped
+        if (file.size() == 0) {
+            return true;
+        }
+
+        // Map the file into memory
+        uchar *mappedData = file.map(0, file.size());
+        if (mappedData) {
+            tokenize(QByteArrayView(reinterpret_cast<const char *>(mappedData), file.size()), callback);
+            file.unmap(mappedData);
+            return true;
+        }
+
+        // Fallback for files that can not be mapped (like resources)
+        QByteArray data = file.readAll();
+        tokenize(QByteArrayView(data), callback);
+        return true;
+    }
+
+    /**
+     * Reads the values of the given keys from an INI file.
+     *
+     * Keys are given as 'section/KEY', just like QSettings does.
+     * Reading stops as soon as all keys are found.
+     *
+     * @param filePath Path to the INI file
+     * @param keys     The keys to read
+     * @return Map of the keys that were found and their values
+     */
+    inline QHash<QString, QString> readValues(const QString &filePath, const QStringList &keys)
+    {
+        QHash<QString, QString> values;
+
+        // Split the keys into sections and key names once
+        QList<QByteArray> sections;
+        QList<QByteArray> keyNames;
+        for (const QString &key : keys) {
+            QByteArray keyUtf8 = key.toUtf8();
+            qsizetype slashIndex = keyUtf8.indexOf('/');
+            sections << (slashIndex == -1 ? QByteArray() : keyUtf8.left(slashIndex));
+            keyNames << (slashIndex == -1 ? keyUtf8 : keyUtf8.mid(slashIndex + 1));
+        }
+
+        tokenizeFile(filePath, [&](QByteArrayView section, QByteArrayView key, QByteArrayView value) {
+            for (qsizetype i = 0; i < keys.size(); ++i) {
+                if (key == QByteArrayView(keyNames.at(i)) && section == QByteArrayView(sections.at(i)) && values.contains(keys.at(i)) == false) {
+                    values.insert(keys.at(i), QString::fromUtf8(value));
+                }
+            }
+
+            // Stop when all keys are found
+            return values.size() < keys.size();
+        });
+
+        return values;
+    }
+
+}
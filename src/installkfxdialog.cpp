@@ -1,5 +1,7 @@
 #include "installkfxdialog.h"
 #include "ui_installkfxdialog.h"
+#include "logcategories.h"
+#include "taskscheduler.h"
 
 #include <QDateTime>
 #include <QFileInfo>
@@ -147,7 +149,7 @@ void InstallKfxDialog::onStableDownloadFinished(bool success)
 
     // Test archive
     emit appendLog("Testing stable release archive...");
-    QThreadPool::globalInstance()->start([this]() {
+    TaskScheduler::start(TaskScheduler::Pool::IO, [this]() {
         uint64_t archiveSize = Archiver::testArchiveAndGetSize(this->tempArchiveStable);
         QMetaObject::invokeMethod(this, "onStableArchiveTestComplete", Qt::QueuedConnection, Q_ARG(uint64_t, archiveSize));
     });
@@ -271,7 +273,7 @@ void InstallKfxDialog::onAlphaDownloadFinished(bool success)
 
     // Test archive
     emit appendLog("Testing alpha patch archive...");
-    QThreadPool::globalInstance()->start([this]() {
+    TaskScheduler::start(TaskScheduler::Pool::IO, [this]() {
         uint64_t archiveSize = Archiver::testArchiveAndGetSize(this->tempArchiveAlpha);
         QMetaObject::invokeMethod(this, "onAlphaArchiveTestComplete", Qt::QueuedConnection, Q_ARG(uint64_t, archiveSize));
     });
@@ -362,7 +364,7 @@ void InstallKfxDialog::updateProgressBarDownload(qint64 bytesReceived, qint64 by
 void InstallKfxDialog::onAppendLog(const QString &string)
 {
     // Log to debug output
-    qDebug() << "Install log:" << string;
+    qCDebug(logUpdate) << "Install log:" << string;
 
     // Set the cursor to the end
     ui->logTextArea->moveCursor(QTextCursor::End);
@@ -500,7 +502,7 @@ bool InstallKfxDialog::moveTempFilesToAppDir(QDir sourceDir)
     QDir appDir(QCoreApplication::applicationDirPath());
     int copiedFiles = 0;
 
-    qDebug() << "Source copy dir:" << sourceDir.absolutePath();
+    qCDebug(logUpdate) << "Source copy dir:" << sourceDir.absolutePath();
 
     // Iterate recursively
     QDirIterator it(sourceDir.absolutePath(), QDir::Files, QDirIterator::Subdirectories);
@@ -515,7 +517,7 @@ bool InstallKfxDialog::moveTempFilesToAppDir(QDir sourceDir)
         // Apply rename rule
         QString destRelPath = renameRules.value(relPath, relPath);
         if (destRelPath != relPath) {
-            qDebug() << QString("Renaming file during copy: %1 -> %2").arg(relPath, destRelPath);
+            qCDebug(logUpdate) << QString("Renaming file during copy: %1 -> %2").arg(relPath, destRelPath);
         }
 
         QString destFilePath = appDir.absoluteFilePath(destRelPath);
@@ -531,7 +533,7 @@ bool InstallKfxDialog::moveTempFilesToAppDir(QDir sourceDir)
         // Remove existing destination
         QFile destFile(destFilePath);
         if (destFile.exists()){
-            qDebug() << "Removing existing file in appdir:" << destFilePath;
+            qCDebug(logUpdate) << "Removing existing file in appdir:" << destFilePath;
             destFile.remove();
         }
 
@@ -567,10 +569,10 @@ void InstallKfxDialog::completeInstall()
     if (KfxVersion::hasFunctionality("max_frames_per_second") == true) {
         emit appendLog("Setting max FPS to screen refresh rate");
         if(Settings::autoSetMaxFpsToScreenRefreshRate() == true){
-            emit appendLog(QString("Max FPS set to: %1").arg(Settings::getKfxSetting("FRAMES_PER_SECOND").toString()));
+            emit appendLog(QString("Max FPS set to: %1").arg(Settings::get<KfxKey::FRAMES_PER_SECOND>()));
         } else {
             if (KfxVersion::hasFunctionality("auto_determine_monitor_refresh_rate") == true) {
-                Settings::setKfxSetting("FRAMES_PER_SECOND", "AUTO 0");
+                Settings::set<KfxKey::FRAMES_PER_SECOND>("AUTO 0");
                 emit appendLog(QString("Max FPS set to: AUTO 0"));
             }
         }
@@ -1,5 +1,6 @@
 #include "kfxversion.h"
 #include "apiclient.h"
+#include "logcategories.h"
 
 #include <QCoreApplication>
 #include <QRegularExpression>
@@ -54,7 +55,7 @@ QString KfxVersion::getVersionString(const QFile& binary){
 
     // Get filepath
     QString filePath = binary.fileName();
-    qDebug() << "Checking app version for file:" << filePath;
+    qCDebug(logUpdate) << "Checking app version for file:" << filePath;
 
     // Parse the PE file using LIEF
     // We use a library here instead of Windows calls to be consistent accross platforms
@@ -64,27 +65,27 @@ QString KfxVersion::getVersionString(const QFile& binary){
 
     // Check if PE file parser is made
     if (!peFile) {
-        qDebug() << "Error: Unable to parse PE file:" << filePath;
+        qCDebug(logUpdate) << "Error: Unable to parse PE file:" << filePath;
         return QString();
     }
 
     // Check if the PE file has resources
     if (!peFile->has_resources()) {
-        qDebug() << "Error: No resources found in the PE file.";
+        qCDebug(logUpdate) << "Error: No resources found in the PE file.";
         return QString();
     }
 
     // Get the resource manager
     auto manager = peFile->resources_manager();
     if(!manager){
-        qDebug() << "Error: Failed to get PE file resource manager.";
+        qCDebug(logUpdate) << "Error: Failed to get PE file resource manager.";
         return QString();
     }
 
     // Get the versions
     auto versions = manager->version();
     if (versions.empty()) {
-        qDebug() << "Error: No version information found in resources.";
+        qCDebug(logUpdate) << "Error: No version information found in resources.";
         return QString();
     }
 
@@ -106,10 +107,10 @@ QString KfxVersion::getVersionString(const QFile& binary){
 
     // Get regex match
     if (match.hasMatch()) {
-        qDebug() << "Grabbed ProductVersion" << match.captured(1) << "from" << filePath;
+        qCDebug(logUpdate) << "Grabbed ProductVersion" << match.captured(1) << "from" << filePath;
         return match.captured(1);
     } else {
-        qWarning() << "Error: Version not found in PE file";
+        qCWarning(logUpdate) << "Error: Version not found in PE file";
     }
 
     return QString();
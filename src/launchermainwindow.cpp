@@ -28,11 +28,14 @@
 #include "fileremover.h"
 #include "fileremoverdialog.h"
 #include "game.h"
+#include "gameoutputdialog.h"
 #include "helper.h"
 #include "imagehelper.h"
 #include "installkfxdialog.h"
 #include "kfxversion.h"
 #include "launcheroptions.h"
+#include "logcategories.h"
+#include "logviewerdialog.h"
 #include "modmanager.h"
 #include "modmanagerdialog.h"
 #include "newsarticlewidget.h"
@@ -41,12 +44,14 @@
 #include "scannetworkdialog.h"
 #include "settings.h"
 #include "settingsdialog.h"
+#include "taskscheduler.h"
 #include "updatedialog.h"
 #include "version.h"
 #include "workshopitemwidget.h"
 
 #define MAX_WORKSHOP_ITEMS_SHOWN 4
 #define MAX_NEWS_ARTICLES_SHOWN 3
+#define WINE_PREWARM_DELAY_MS 2000
 
 LauncherMainWindow::LauncherMainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -131,7 +136,7 @@ LauncherMainWindow::LauncherMainWindow(QWidget *parent)
 
         // Set launcher to same screen as game
         if (Settings::getLauncherSetting("OPEN_ON_GAME_SCREEN").toBool() == true) {
-            screenIndex = Settings::getKfxSetting("DISPLAY_NUMBER").toInt() - 1;
+            screenIndex = Settings::get<KfxKey::DISPLAY_NUMBER>().toInt() - 1;
             if (screenIndex >= screens.size()) {
                 screenIndex = 0;
             }
@@ -161,7 +166,7 @@ LauncherMainWindow::LauncherMainWindow(QWidget *parent)
     // the Dungeon Keeper directory which might cause problems.
     // It's also possible for the user to surpress the messagebox.
     if (DkFiles::isOriginalDkExecutableFound() && Settings::getLauncherSetting("SUPPRESS_ORIGINAL_DK_FOUND_MESSAGEBOX").toBool() == false) {
-        qDebug() << "Original DK executable(s) found: Asking if user is wants to ignore or abort";
+        qCDebug(logUpdate) << "Original DK executable(s) found: Asking if user is wants to ignore or abort";
 
         // Create messagebox
         QMessageBox msgBox;
@@ -185,14 +190,14 @@ LauncherMainWindow::LauncherMainWindow(QWidget *parent)
 
         // Handle the result
         if (result == QMessageBox::Abort) {
-            qDebug() << "Original DK executable(s) found: User chose to abort";
+            qCDebug(logUpdate) << "Original DK executable(s) found: User chose to abort";
 
             // Exit the application
             this->hide();
             QTimer::singleShot(0, []() { QCoreApplication::exit(1); });
             return;
         } else {
-            qDebug() << "Original DK executable(s) found: User chose to ignore";
+            qCDebug(logUpdate) << "Original DK executable(s) found: User chose to ignore";
 
             // Check if user wants to not show the dialog again
             if (dontShowAgain.isChecked()) {
@@ -222,9 +227,9 @@ LauncherMainWindow::LauncherMainWindow(QWidget *parent)
     } else {
         // If '--install' is not forced we check if we need to install
         if (Helper::isKeeperFxInstalled() == false) {
-            qDebug() << "'keeperfx.exe' seems to be missing, asking if user wants a fresh install";
+            qCDebug(logUpdate) << "'keeperfx.exe' seems to be missing, asking if user wants a fresh install";
             if (askForKeeperFxInstall() == true) {
-                qDebug() << "User wants fresh install, opening kfx install dialog";
+                qCDebug(logUpdate) << "User wants fresh install, opening kfx install dialog";
                 InstallKfxDialog installKfxDialog(this);
                 installKfxDialog.exec();
             }
@@ -234,7 +239,7 @@ LauncherMainWindow::LauncherMainWindow(QWidget *parent)
     // Check if we need to copy over DK files
     // Only do this if keeperfx is installed
     if (Helper::isKeeperFxInstalled() == true && DkFiles::isCurrentAppDirValidDkDir() == false) {
-        qDebug() << "One or more original DK files not found, opening copy dialog";
+        qCDebug(logUpdate) << "One or more original DK files not found, opening copy dialog";
         CopyDkFilesDialog copyDkFilesWindow(this);
         copyDkFilesWindow.exec();
     }
@@ -248,7 +253,7 @@ LauncherMainWindow::LauncherMainWindow(QWidget *parent)
         } else {
             // Failed to get KeeperFX version
             // Asking the user if they want to reinstall
-            qDebug() << "Failed to load KeeperFX version";
+            qCDebug(logUpdate) << "Failed to load KeeperFX version";
             int result = QMessageBox::question(this,
                                                tr("KeeperFX Error", "MessageBox Title"),
                                                tr("The launcher failed to determine the version of KeeperFX. "
@@ -258,7 +263,7 @@ LauncherMainWindow::LauncherMainWindow(QWidget *parent)
 
             if (result == QMessageBox::Yes) {
                 // Start Automatic KeeperFX (web) installation
-                qDebug() << "User wants to reinstall KeeperFX";
+                qCDebug(logUpdate) << "User wants to reinstall KeeperFX";
                 InstallKfxDialog installKfxDialog(this);
                 installKfxDialog.exec();
 
@@ -305,6 +310,9 @@ LauncherMainWindow::LauncherMainWindow(QWidget *parent)
         // We do this if we're not checking for updates because when checking for updates we do this as well
         checkForFileRemoval();
     }
+
+    // Get Wine ready while the user is looking at the launcher
+    QTimer::singleShot(WINE_PREWARM_DELAY_MS, game, &Game::prewarm);
 }
 
 LauncherMainWindow::~LauncherMainWindow()
@@ -360,7 +368,7 @@ void LauncherMainWindow::setupPlayExtraMenu()
     /*menu->addAction(tr("Play map"),
                     [this]() {
                         // Handle play map logic here
-                        qDebug() << "Play map selected!";
+                        qCDebug(logGame) << "Play map selected!";
                     })
         ->setDisabled(true); // TODO: disabled until implemented*/
 
@@ -382,7 +390,7 @@ void LauncherMainWindow::setupPlayExtraMenu()
     // Direct connect (MP) action
     if (KfxVersion::hasFunctionality("direct_enet_connect") == true) {
         menu->addAction(tr("Direct connect (MP)", "Menu"), [this]() {
-            qDebug() << "Direct connect (MP) selected!";
+            qCDebug(logGame) << "Direct connect (MP) selected!";
             // Open the dialog
             DirectConnectDialog dialog(this);
             if (dialog.exec() == QDialog::Accepted) {
@@ -393,7 +401,7 @@ void LauncherMainWindow::setupPlayExtraMenu()
 
     // Scan local network (MP)
     menu->addAction(tr("Scan local network (MP)", "Menu"), [this]() {
-        qDebug() << "Scan local network (MP) selected!";
+        qCDebug(logGame) << "Scan local network (MP) selected!";
         // Open the scan dialog
         ScanNetworkDialog dialog(this);
         if (dialog.exec() == QDialog::Accepted) {
@@ -404,7 +412,7 @@ void LauncherMainWindow::setupPlayExtraMenu()
 
     // Scan local network (MP)
     menu->addAction(tr("Test internet lobby (MP)", "Menu"), [this]() {
-        qDebug() << "Test internet lobby (MP) selected!";
+        qCDebug(logGame) << "Test internet lobby (MP) selected!";
         // Open the dialog
         EnetServerTestDialog dialog(this);
         dialog.exec();
@@ -412,7 +420,7 @@ void LauncherMainWindow::setupPlayExtraMenu()
 
     // Run packetsave action
     menu->addAction(tr("Run packetfile", "Menu"), [this]() {
-        qDebug() << "Run packetsave selected!";
+        qCDebug(logGame) << "Run packetsave selected!";
         // Open the dialog
         RunPacketFileDialog dialog(this);
         if (dialog.exec() == QDialog::Accepted) {
@@ -424,12 +432,21 @@ void LauncherMainWindow::setupPlayExtraMenu()
     // Start without mods action
     if (KfxVersion::hasFunctionality("start_without_mods_param") == true) {
         menu->addAction(tr("Start without mods", "Menu"), [this]() {
-            qDebug() << "Start without mods selected!";
+            qCDebug(logGame) << "Start without mods selected!";
             // Start the game
             startGame(Game::StartType::START_WITHOUT_MODS);
         });
     }
 
+    // Game output
+    menu->addAction(tr("Show game output", "Menu"), [this]() {
+        qCDebug(logGame) << "Show game output selected!";
+        // Open the dialog without blocking so it can be kept open while playing
+        GameOutputDialog *dialog = new GameOutputDialog(game, this);
+        dialog->setAttribute(Qt::WA_DeleteOnClose);
+        dialog->show();
+    });
+
     // Heavylog toggle
     QFile heavyLogBin(QCoreApplication::applicationDirPath() + "/keeperfx_hvlog.exe");
     if (heavyLogBin.exists()) {
@@ -473,7 +490,7 @@ void LauncherMainWindow::refreshSaveFilesMenu()
         for (auto &saveFile : saveFileList) {
             this->saveFilesMenu->addAction(saveFile->toString(), [this, saveFile]() {
                 // Handle loading the save file
-                qDebug() << "Loading save file:" << saveFile;
+                qCDebug(logGame) << "Loading save file:" << saveFile;
                 // TODO: startGame(Game::StartType::LOAD_SAVE, saveFile->saveName);
             });
         }
@@ -498,7 +515,7 @@ void LauncherMainWindow::refreshCampaignMenu()
         for (auto &campaign : campaignList) {
             this->campaignMenu->addAction(campaign->toString(), [this, campaign]() {
                 // Start campaign
-                qDebug() << "Starting campaign:" << campaign->toString();
+                qCDebug(logGame) << "Starting campaign:" << campaign->toString();
                 startGame(Game::StartType::CAMPAIGN, campaign->campaignShortName);
             });
         }
@@ -545,13 +562,16 @@ void LauncherMainWindow::refreshLogfileButton() {
 
 void LauncherMainWindow::on_logFileButton_clicked()
 {
-    // Use default text editor to open keeperfx.log file
+    // Open keeperfx.log file in the built-in viewer
+    // Heavylog files can be hundreds of MB which most text editors do not handle well
     QString logFilePath = QCoreApplication::applicationDirPath() + "/keeperfx.log";
     QFile logFile(logFilePath);
     if (logFile.exists()) {
-        QDesktopServices::openUrl(QUrl::fromLocalFile(logFilePath));
+        LogViewerDialog *dialog = new LogViewerDialog(game, logFilePath, this);
+        dialog->setAttribute(Qt::WA_DeleteOnClose);
+        dialog->show();
     } else {
-        qWarning() << "File does not exist: " << logFilePath;
+        qCWarning(logGame) << "File does not exist: " << logFilePath;
     }
 }
 
@@ -603,13 +623,13 @@ void LauncherMainWindow::on_settingsButton_clicked() {
     if(oldLauncherLanguage != Settings::getLauncherSetting("LAUNCHER_LANGUAGE").toString()){
 
         // Ask user if they want to restart their launcher
-        qDebug() << "Launcher language has changed so asking for launcher restart";
+        qCDebug(logSettings) << "Launcher language has changed so asking for launcher restart";
         int result = QMessageBox::question(this,
                                            tr("Language has changed", "MessageBox Title"),
                                            tr("The launcher has to restart to change its language. Do you want to do that now?", "MessageBox Text"));
         if (result == QMessageBox::Yes) {
 
-            qDebug() << "Restarting launcher to change the language";
+            qCDebug(logSettings) << "Restarting launcher to change the language";
 
             // Remove possible --language parameter because it would be weird if it were still active after changing the language
             LauncherOptions::removeArgumentOption("language");
@@ -617,6 +637,10 @@ void LauncherMainWindow::on_settingsButton_clicked() {
             // Hide this launcher's window and pipe the exit code from the new launcher process to the exit of this one
             // We do this because we want to allow users to keep a handle on the original process
             this->hide();
+
+            // Make sure the new launcher reads our latest settings
+            Settings::flush();
+
             QCoreApplication::exit(QProcess::execute(QCoreApplication::applicationFilePath(), LauncherOptions::getArguments()));
             return;
         }
@@ -629,7 +653,7 @@ void LauncherMainWindow::on_settingsButton_clicked() {
             // Version has changed
             oldReleaseVersion != Settings::getLauncherSetting("CHECK_FOR_UPDATES_RELEASE").toString()
     )){
-        qDebug() << "Settings regarding updates have been enabled or changed so asking for update";
+        qCDebug(logUpdate) << "Settings regarding updates have been enabled or changed so asking for update";
         checkForKfxUpdate(true);
     }
 
@@ -682,118 +706,108 @@ void LauncherMainWindow::loadLatestFromKfxNet()
     // Clear the existing data in the lists
     clearLatestFromKfxNet();
 
-    // Create thread so we don't block the main thread
-    QThread::create([this]() {
-        // Get latest workshop items and news from the website
-        // We use QtConcurrent so they are loaded in separate threads
-        auto fetchWorkshopItems = QtConcurrent::run([this]() { return ApiClient::getJsonResponse(QUrl("/v1/workshop/latest")); });
-        auto fetchLatestNews = QtConcurrent::run([this]() { return ApiClient::getJsonResponse(QUrl("/v1/news/latest")); });
-
-        // Wait for both threads to finish
-        fetchWorkshopItems.waitForFinished();
-        fetchLatestNews.waitForFinished();
-
-        // Emit a signal to pass the data to the main thread
-        QMetaObject::invokeMethod(
-            this, [this, fetchWorkshopItems, fetchLatestNews]() { emit kfxNetRetrieval(fetchWorkshopItems.result(), fetchLatestNews.result()); }, Qt::QueuedConnection);
-        
-    })->start();
+    // Get latest workshop items and news from the website
+    // They are loaded at the same time in the network pool so we don't block the main thread
+    QList<QFuture<QJsonDocument>> fetches = {
+        TaskScheduler::run(TaskScheduler::Pool::NETWORK, []() { return ApiClient::getJsonResponse(QUrl("/v1/workshop/latest")); }),
+        TaskScheduler::run(TaskScheduler::Pool::NETWORK, []() { return ApiClient::getJsonResponse(QUrl("/v1/news/latest")); }),
+    };
+
+    // Pass the data to the main thread when both are done
+    QtFuture::whenAll(fetches.begin(), fetches.end()).then(this, [this](const QList<QFuture<QJsonDocument>> &results) {
+        emit kfxNetRetrieval(results.at(0).result(), results.at(1).result());
+    });
 }
 
 void LauncherMainWindow::onKfxNetRetrieval(QJsonDocument workshopItems, QJsonDocument latestNews)
 {
-    // Create a thread so we don't lock the main thread while grabbing the images
-    QThread::create([this, workshopItems, latestNews]() {
-        QMutex mapMutex;
-        QThreadPool *threadPool = QThreadPool::globalInstance();
-
-        QList<QJsonObject> workshopItemList;
-        QList<QJsonObject> newsArticleList;
+    // The images are grabbed in the network pool so we don't lock the main thread
+    // The JSON is small enough to handle here
+    QStringList thumbnailUrls;
+    QList<QFuture<QImage>> thumbnailFutures;
 
-        QMap<QString, QPixmap> pixmapMap;
+    QList<QJsonObject> workshopItemList;
+    QList<QJsonObject> newsArticleList;
 
-        QSize workshopItemThumbnailSize(80, 80);
-        QSize newsArticleThumbnailSize(100, 100);
+    QSize workshopItemThumbnailSize(80, 80);
+    QSize newsArticleThumbnailSize(100, 100);
 
-        if (workshopItems.isEmpty() == false) {
-            QJsonObject workshopItemsObj = workshopItems.object();
-            QJsonArray workshopItemsArray = workshopItemsObj["workshop_items"].toArray();
+    if (workshopItems.isEmpty() == false) {
+        QJsonObject workshopItemsObj = workshopItems.object();
+        QJsonArray workshopItemsArray = workshopItemsObj["workshop_items"].toArray();
 
-            // Loop trough workshop items
-            int currentLoopCount = 0;
-            for (int i = 0; i < workshopItemsArray.size(); ++i) {
+        // Loop trough workshop items
+        int currentLoopCount = 0;
+        for (int i = 0; i < workshopItemsArray.size(); ++i) {
 
-                const QJsonValue workshopItemValue = workshopItemsArray[i];
-
-                // Only allow the max amount of items
-                if (currentLoopCount++ >= MAX_WORKSHOP_ITEMS_SHOWN) {
-                    break;
-                }
+            const QJsonValue workshopItemValue = workshopItemsArray[i];
 
-                // Get workshop item as object
-                QJsonObject workshopItem = workshopItemValue.toObject();
-                workshopItemList.append(workshopItem);
-
-                // Get thumbnail URL
-                QString thumbnailUrl;
-                if (workshopItem["thumbnail"].isNull() == false) {
-                    thumbnailUrl = workshopItem["thumbnail"].toString();
-                } else {
-                    // The API returns a default image for items without one so we can just use it
-                    thumbnailUrl = workshopItem["image"].toString();
-                }
+            // Only allow the max amount of items
+            if (currentLoopCount++ >= MAX_WORKSHOP_ITEMS_SHOWN) {
+                break;
+            }
 
-                // Start a thread to get the pixmap and convert it to an image
-                threadPool->start([thumbnailUrl, workshopItemThumbnailSize, &pixmapMap, &mapMutex]() {
-                    QPixmap pixmap = ImageHelper::getOnlineScaledPixmap(QUrl(thumbnailUrl), workshopItemThumbnailSize);
+            // Get workshop item as object
+            QJsonObject workshopItem = workshopItemValue.toObject();
+            workshopItemList.append(workshopItem);
 
-                    // Use a mutex to protect shared access to the QMap
-                    QMutexLocker locker(&mapMutex);
-                    pixmapMap[thumbnailUrl] = pixmap;
-                });
+            // Get thumbnail URL
+            QString thumbnailUrl;
+            if (workshopItem["thumbnail"].isNull() == false) {
+                thumbnailUrl = workshopItem["thumbnail"].toString();
+            } else {
+                // The API returns a default image for items without one so we can just use it
+                thumbnailUrl = workshopItem["image"].toString();
             }
+
+            // Start a task to get the image
+            thumbnailUrls << thumbnailUrl;
+            thumbnailFutures << TaskScheduler::run(TaskScheduler::Pool::NETWORK, [thumbnailUrl, workshopItemThumbnailSize]() {
+                return ImageHelper::getOnlineScaledImage(QUrl(thumbnailUrl), workshopItemThumbnailSize);
+            });
         }
+    }
 
-        if (latestNews.isEmpty() == false) {
-            QJsonObject latestNewsArticleObj = latestNews.object();
-            QJsonArray newsArticlesArray = latestNewsArticleObj["articles"].toArray();
+    if (latestNews.isEmpty() == false) {
+        QJsonObject latestNewsArticleObj = latestNews.object();
+        QJsonArray newsArticlesArray = latestNewsArticleObj["articles"].toArray();
 
-            // Loop trough news articles
-            int currentLoopCount = 0;
-            for (int i = 0; i < newsArticlesArray.size(); ++i) {
+        // Loop trough news articles
+        int currentLoopCount = 0;
+        for (int i = 0; i < newsArticlesArray.size(); ++i) {
 
-                const QJsonValue newsArticleValue = newsArticlesArray[i];
+            const QJsonValue newsArticleValue = newsArticlesArray[i];
 
-                // Only allow the max amount of items
-                if (currentLoopCount++ >= MAX_NEWS_ARTICLES_SHOWN) {
-                    break;
-                }
-
-                // Get workshop item as object
-                QJsonObject newsArticle = newsArticleValue.toObject();
-                newsArticleList.append(newsArticle);
+            // Only allow the max amount of items
+            if (currentLoopCount++ >= MAX_NEWS_ARTICLES_SHOWN) {
+                break;
+            }
 
-                // Get thumbnail URL
-                QString thumbnailUrl = newsArticle["image"].toString();
+            // Get workshop item as object
+            QJsonObject newsArticle = newsArticleValue.toObject();
+            newsArticleList.append(newsArticle);
 
-                // Start a thread to get the pixmap and convert it to an image
-                threadPool->start([thumbnailUrl, newsArticleThumbnailSize, &pixmapMap, &mapMutex]() {
-                    QPixmap pixmap = ImageHelper::getOnlineScaledPixmap(QUrl(thumbnailUrl), newsArticleThumbnailSize);
+            // Get thumbnail URL
+            QString thumbnailUrl = newsArticle["image"].toString();
 
-                    // Use a mutex to protect shared access to the QMap
-                    QMutexLocker locker(&mapMutex);
-                    pixmapMap[thumbnailUrl] = pixmap;
-                });
-            }
+            // Start a task to get the image
+            thumbnailUrls << thumbnailUrl;
+            thumbnailFutures << TaskScheduler::run(TaskScheduler::Pool::NETWORK, [thumbnailUrl, newsArticleThumbnailSize]() {
+                return ImageHelper::getOnlineScaledImage(QUrl(thumbnailUrl), newsArticleThumbnailSize);
+            });
         }
+    }
 
-        // Wait for all tasks to finish
-        threadPool->waitForDone();
-
-        // Emit signal so we can update the GUI
-        QMetaObject::invokeMethod(
-            this, [this, workshopItemList, newsArticleList, pixmapMap]() { emit kfxNetImagesLoaded(workshopItemList, newsArticleList, pixmapMap); }, Qt::QueuedConnection);
-    })->start();
+    // Emit signal so we can update the GUI when all images are loaded
+    // Pixmaps are only created on the main thread
+    QtFuture::whenAll(thumbnailFutures.begin(), thumbnailFutures.end())
+        .then(this, [this, workshopItemList, newsArticleList, thumbnailUrls](const QList<QFuture<QImage>> &results) {
+            QMap<QString, QPixmap> pixmapMap;
+            for (int i = 0; i < results.size(); ++i) {
+                pixmapMap[thumbnailUrls.at(i)] = QPixmap::fromImage(results.at(i).result());
+            }
+            emit kfxNetImagesLoaded(workshopItemList, newsArticleList, pixmapMap);
+        });
 }
 
 void LauncherMainWindow::onKfxNetImagesLoaded(QList<QJsonObject> workshopItemList, QList<QJsonObject> newsArticleList, QMap<QString, QPixmap> pixmapMap)
@@ -881,7 +895,7 @@ void LauncherMainWindow::checkForFileRemoval()
 {
     // Check if we need to skip leftover file removal
     if (LauncherOptions::isSet("skip-file-removal") == true) {
-        qDebug() << "Skipping leftover file removal (skip-file-removal)";
+        qCDebug(logUpdate) << "Skipping leftover file removal (skip-file-removal)";
         return;
     }
 
@@ -892,33 +906,35 @@ void LauncherMainWindow::checkForFileRemoval()
         saveDeleteMeFile.remove();
     }
 
-    // Spawn a thread for the file removal
-    // We do this in a thread so we can already show the launcher main window in the meanwhile
-    QThread::create([this]() {
+    // Check for the file removal in the IO pool
+    // We do this in the background so we can already show the launcher main window in the meanwhile
+    // The task does not touch the window, the result is handled on the main thread while the window still exists
+    TaskScheduler::run(TaskScheduler::Pool::IO, []() {
 
         // Check if file exists that contains files that should be removed
         QString fileRemovalFilename = QString("launcher-auto-file-removal.txt");
         QFile fileRemovalFile(QCoreApplication::applicationDirPath() + "/" + fileRemovalFilename);
-        if (fileRemovalFile.exists()) {
+        if (fileRemovalFile.exists() == false) {
+            qCInfo(logUpdate) << "File-removal file not found:" << fileRemovalFilename;
+            return QStringList();
+        }
 
-            // Get files to remove based on KfxVersion
-            QStringList filesToRemove = FileRemover::processFile(fileRemovalFile, KfxVersion::currentVersion.version);
+        // Get files to remove based on KfxVersion
+        return FileRemover::processFile(fileRemovalFile, KfxVersion::currentVersion.version);
 
-            // If there are files that should be removed
-            if(filesToRemove.length() > 0){
-                qDebug() << "Files found that should be removed:" << filesToRemove;
+    }).then(this, [this](const QStringList &filesToRemove) {
 
-                // Emit signal for file removal
-                emit this->filesToRemoveFound(filesToRemove);
+        // If there are files that should be removed
+        if (filesToRemove.length() > 0) {
+            qCDebug(logUpdate) << "Files found that should be removed:" << filesToRemove;
+
+            // Emit signal for file removal
+            emit this->filesToRemoveFound(filesToRemove);
 
-            } else {
-                qDebug() << "No files to remove found.";
-            }
         } else {
-            qInfo() << "File-removal file not found:" << fileRemovalFilename;
+            qCDebug(logUpdate) << "No files to remove found.";
         }
-
-    })->start();
+    });
 }
 
 void LauncherMainWindow::onFilesToRemoveFound(QStringList filesToRemove)
@@ -933,7 +949,7 @@ void LauncherMainWindow::onFilesToRemoveFound(QStringList filesToRemove)
 
     // Check if user wants to remove leftover files automatically (silently)
     if(Settings::getLauncherSetting("AUTO_REMOVE_LEFTOVER_FILES") == true){
-        qDebug() << "Removing leftover files automatically without user interaction";
+        qCDebug(logUpdate) << "Removing leftover files automatically without user interaction";
 
         // Loop through the list of files
         for (const QString &filePath : std::as_const(filesToRemove)) {
@@ -944,11 +960,11 @@ void LauncherMainWindow::onFilesToRemoveFound(QStringList filesToRemove)
 
                 // Remove the file
                 if (file.remove()) {
-                    qDebug() << "Removed leftover file:" << filePath;
+                    qCDebug(logUpdate) << "Removed leftover file:" << filePath;
                 } else {
                     // There isn't really a need to tell the user here
                     // If they get into trouble the logs will tell us there's a problem here
-                    qWarning() << "Failed to remove leftover file:" << filePath;
+                    qCWarning(logUpdate) << "Failed to remove leftover file:" << filePath;
                 }
             }
         }
@@ -993,8 +1009,8 @@ void LauncherMainWindow::onUpdateFound(KfxVersion::VersionInfo versionInfo)
         QString newLauncherVersion = KfxVersion::getVersionString(newAppBin);
         if(newLauncherVersion.isEmpty()){
 
-            qDebug() << "A new launcher binary was found but we failed to grab its version";
-            qDebug() << "We'll start it just in case";
+            qCDebug(logUpdate) << "A new launcher binary was found but we failed to grab its version";
+            qCDebug(logUpdate) << "We'll start it just in case";
 
             // Start the new launcher
             // This needs to be detached because we are going the remove the current running launcher
@@ -1004,13 +1020,13 @@ void LauncherMainWindow::onUpdateFound(KfxVersion::VersionInfo versionInfo)
 
         } else {
 
-            qDebug() << "New launcher found:" << newAppBinString << QString("v" + newLauncherVersion);
-            qDebug() << "Current launcher version:" << LAUNCHER_VERSION;
+            qCDebug(logUpdate) << "New launcher found:" << newAppBinString << QString("v" + newLauncherVersion);
+            qCDebug(logUpdate) << "Current launcher version:" << LAUNCHER_VERSION;
 
             // Check if new launcher is newer
             if(KfxVersion::isNewerVersion(newLauncherVersion, LAUNCHER_VERSION)){
 
-                qDebug() << "Starting new launcher because it is newer";
+                qCDebug(logUpdate) << "Starting new launcher because it is newer";
                 // Start the new launcher
                 // This needs to be detached because we are going the remove the current running launcher
                 QProcess::startDetached(newAppBinString, LauncherOptions::getArguments());
@@ -1021,7 +1037,7 @@ void LauncherMainWindow::onUpdateFound(KfxVersion::VersionInfo versionInfo)
 
                 // The new launcher can be removed because it is not newer than our one
                 newAppBin.remove();
-                qDebug() << "New launcher is removed because it is older";
+                qCDebug(logUpdate) << "New launcher is removed because it is older";
             }
         }
     }
@@ -1034,7 +1050,7 @@ void LauncherMainWindow::onUpdateFound(KfxVersion::VersionInfo versionInfo)
     QFile newAppBin(newAppBinString);
     if (newAppBin.exists()) {
 
-        qDebug() << "New launcher found. Starting it now";
+        qCDebug(logUpdate) << "New launcher found. Starting it now";
 
         // Start the new launcher
         // This needs to be detached because we are going the remove the current running launcher
@@ -1087,12 +1103,12 @@ void LauncherMainWindow::forceKfxUpdateCheck() {
 
 void LauncherMainWindow::checkForKfxUpdate(bool ignoreInterval)
 {
-    qDebug() << "Checking for KeeperFX update";
+    qCDebug(logUpdate) << "Checking for KeeperFX update";
 
     // Only update from stable and alpha
     if (KfxVersion::currentVersion.type != KfxVersion::ReleaseType::STABLE &&
         KfxVersion::currentVersion.type != KfxVersion::ReleaseType::ALPHA) {
-        qDebug() << "Not updating because we are not on stable or alpha version";
+        qCDebug(logUpdate) << "Not updating because we are not on stable or alpha version";
         checkForFileRemoval(); // Check if there are any files that should be removed
         return;
     }
@@ -1115,45 +1131,46 @@ void LauncherMainWindow::checkForKfxUpdate(bool ignoreInterval)
 
             // Make sure timestamp is valid
             if(lastTimestamp.isValid() == false){
-                qWarning() << "Invalid timestamp for 'CHECK_FOR_UPDATES_LAST_TIMESTAMP' launcher setting:" << lastTimestampString;
+                qCWarning(logUpdate) << "Invalid timestamp for 'CHECK_FOR_UPDATES_LAST_TIMESTAMP' launcher setting:" << lastTimestampString;
                 return;
             }
 
             // Check if we need to update
             if(lastTimestamp.addDays(intervalDays) > currentTimestamp) {
-                qDebug() << "Not updating because we have not passed the interval for updates yet:" << QString(QString::number(intervalDays) + " day");
+                qCDebug(logUpdate) << "Not updating because we have not passed the interval for updates yet:" << QString(QString::number(intervalDays) + " day");
                 checkForFileRemoval(); // Check if there are any files that should be removed
                 return;
             } else {
-                qDebug() << "Update interval is passed, checking for update";
+                qCDebug(logUpdate) << "Update interval is passed, checking for update";
             }
         } else {
-            qDebug() << "Interval is disabled for this update check";
+            qCDebug(logUpdate) << "Interval is disabled for this update check";
         }
     } else {
-        qDebug() << "Bypassing possible interval for this update check";
+        qCDebug(logUpdate) << "Bypassing possible interval for this update check";
     }
 
     // Remember current timestamp for interval checks
     Settings::setLauncherSetting("CHECK_FOR_UPDATES_LAST_TIMESTAMP", currentTimestamp.toString(Qt::ISODate));
 
-    // Spawn a thread
-    // We don't want any slow internet connections block our main thread
-    QThread::create([this]() {
+    // Get release type
+    QString typeString = Settings::getLauncherSetting("CHECK_FOR_UPDATES_RELEASE").toString();
+    KfxVersion::ReleaseType type = KfxVersion::getReleaseTypefromString(typeString);
 
-        // Get release type
-        QString typeString = Settings::getLauncherSetting("CHECK_FOR_UPDATES_RELEASE").toString();
-        KfxVersion::ReleaseType type = KfxVersion::getReleaseTypefromString(typeString);
+    // Only update to stable and alpha
+    if (type != KfxVersion::ReleaseType::STABLE && type != KfxVersion::ReleaseType::ALPHA) {
+        qCDebug(logUpdate) << "Invalid auto update release type:" << typeString;
+        checkForFileRemoval(); // Check if there are any files that should be removed
+        return;
+    }
 
-        // Only update to stable and alpha
-        if (type != KfxVersion::ReleaseType::STABLE && type != KfxVersion::ReleaseType::ALPHA) {
-            qDebug() << "Invalid auto update release type:" << typeString;
-            checkForFileRemoval(); // Check if there are any files that should be removed
-            return;
-        }
+    // Show update icon
+    emit this->showUpdateIcon(true);
 
-        // Show update icon
-        emit this->showUpdateIcon(true);
+    // Check for updates in the network pool
+    // We don't want any slow internet connections block our main thread
+    // The task does not touch the window, the result is handled on the main thread while the window still exists
+    TaskScheduler::run(TaskScheduler::Pool::NETWORK, [type]() -> std::optional<KfxVersion::VersionInfo> {
 
         // Get latest version for this release type
         auto latestVersionInfo = KfxVersion::getLatestVersion(type);
@@ -1163,24 +1180,30 @@ void LauncherMainWindow::checkForKfxUpdate(bool ignoreInterval)
             if (type != KfxVersion::currentVersion.type
                 || KfxVersion::isNewerVersion(latestVersionInfo->version,
                                               KfxVersion::currentVersion.version)) {
-                qDebug() << "Update found:" << latestVersionInfo->version;
-
-                // Emit signal for update
-                emit this->updateFound(latestVersionInfo.value());
-                return;
+                qCDebug(logUpdate) << "Update found:" << latestVersionInfo->version;
+                return latestVersionInfo;
 
             } else {
-                qDebug() << "No updates found";
+                qCDebug(logUpdate) << "No updates found";
             }
         }
 
+        return std::nullopt;
+
+    }).then(this, [this](const std::optional<KfxVersion::VersionInfo> &updateVersionInfo) {
+
+        // Emit signal for update
+        if (updateVersionInfo) {
+            emit this->updateFound(updateVersionInfo.value());
+            return;
+        }
+
         // Hide update icon
         emit this->showUpdateIcon(false);
 
         // Check if there are any files that should be removed
         checkForFileRemoval();
-
-    })->start();
+    });
 }
 
 void LauncherMainWindow::verifyBinaryCertificates()
@@ -1246,7 +1269,7 @@ void LauncherMainWindow::startGame(Game::StartType startType, QVariant data1, QV
 
     // Make sure game is started
     if (startStatus == false) {
-        qDebug() << "Game failed to start";
+        qCDebug(logGame) << "Game failed to start";
 
         // Refresh the installation-aware and logfile buttons
         refreshInstallationAwareButtons();
@@ -1257,7 +1280,7 @@ void LauncherMainWindow::startGame(Game::StartType startType, QVariant data1, QV
 
         // Show messagebox alerting the user
         if (errorString.isEmpty() == false) {
-            qDebug() << "Game start error:" << errorString;
+            qCDebug(logGame) << "Game start error:" << errorString;
             QMessageBox::warning(this,
                                  tr("KeeperFX Error", "MessageBox Title"),
                                  tr("Failed to start KeeperFX.\n\n"
@@ -1283,6 +1306,9 @@ void LauncherMainWindow::onGameEnded(int exitCode, QProcess::ExitStatus exitStat
 
     // Not really required but good to occasionally refresh
     refreshCampaignMenu();
+
+    // Keep Wine ready for the next launch
+    game->prewarm();
 }
 
 void LauncherMainWindow::refreshKfxVersionInGui()
@@ -45,10 +45,13 @@ void LauncherOptions::processApp(QApplication &app)
         {"skip-launcher-update",        "Do not update the launcher itself"},
         {"log-missing-translations",    "Log missing translations to debug"},
         {"no-image-cache",              "Bypass image caching"},
+        {"no-campaign-index",           "Bypass the campaign index cache"},
         {"download-music",              "Start the music download procedure"},
         {"skip-file-removal",           "Do not ask for the removal of leftover files"},
         {"disable-gzip-upload",         "Disable GZip compression of uploads"},
         {"crash-report",                "Force a crash report dialog"},
+        {"game-output-log",             "Write the output of the game to 'keeperfx-game-output.log'"},
+        {"session-monitor",             "Record the resource usage of the game in 'keeperfx-sessions' (Linux)"},
         {"disable-tls-verification",    "Disable certificate validation for web requests"},
 
         // Parameters
@@ -56,6 +59,8 @@ void LauncherOptions::processApp(QApplication &app)
         {"translation-file",            "Force a PO translation file to be loaded",    "filepath"},
         {"language-file",               "Force a PO translation file to be loaded",    "filepath"}, // same as 'translation-file'
         {"language",                    "Force a language to be loaded",               "language code"},
+        {"log-rules",                   "Set the logging rules, e.g. 'launcher.net.debug=false;launcher.game.info=false'", "rules"},
+        {"benchmark-gzip",              "Benchmark the GZip compression of a file",    "filepath"},
     };
     // clang-format on
 
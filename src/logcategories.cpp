@@ -0,0 +1,7 @@
+#include "logcategories.h"
+
+Q_LOGGING_CATEGORY(logUpdate, "launcher.update")
+Q_LOGGING_CATEGORY(logNet, "launcher.net")
+Q_LOGGING_CATEGORY(logArchive, "launcher.archive")
+Q_LOGGING_CATEGORY(logSettings, "launcher.settings")
+Q_LOGGING_CATEGORY(logGame, "launcher.game")
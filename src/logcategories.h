@@ -0,0 +1,13 @@
+#pragma once
+
+#include <QLoggingCategory>
+
+// Logging categories for the subsystems of the launcher
+// They can be filtered with the '--log-rules' launcher option, for example:
+//   --log-rules="launcher.net.debug=false;launcher.game.info=false"
+// Arguments of a disabled message are never evaluated
+Q_DECLARE_LOGGING_CATEGORY(logUpdate)
+Q_DECLARE_LOGGING_CATEGORY(logNet)
+Q_DECLARE_LOGGING_CATEGORY(logArchive)
+Q_DECLARE_LOGGING_CATEGORY(logSettings)
+Q_DECLARE_LOGGING_CATEGORY(logGame)
@@ -0,0 +1,378 @@
+#include "logfilemodel.h"
+#include "taskscheduler.h"
+
+#include <QByteArrayMatcher>
+#include <QDebug>
+#include <QFileInfo>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <algorithm>
+#include <cstring>
+
+// Amount of the file that is indexed per background task
+// The view is updated between chunks so the first lines show up right away
+#define LOG_INDEX_CHUNK_SIZE (16 * 1024 * 1024)
+
+// Lines per search task
+#define LOG_SEARCH_LINES_PER_TASK 100000
+
+// Search results are capped to keep the memory usage in check
+#define LOG_SEARCH_MAX_MATCHES 100000
+
+// Lines longer than this are cut off in the view
+#define LOG_MAX_LINE_LENGTH 4096
+
+LogFileModel::MappedFile::~MappedFile()
+{
+    if (data != nullptr) {
+        file.unmap(reinterpret_cast<uchar *>(const_cast<char *>(data)));
+    }
+}
+
+LogFileModel::LogFileModel(QObject *parent)
+    : QAbstractListModel(parent)
+    , searchPool(std::make_shared<QThreadPool>())
+{
+    connect(&indexWatcher, &QFutureWatcher<IndexResult>::finished, this, &LogFileModel::handleIndexResult);
+    connect(&searchWatcher, &QFutureWatcher<SearchResult>::finished, this, &LogFileModel::handleSearchResult);
+}
+
+LogFileModel::~LogFileModel()
+{
+    // Running tasks keep their own references so we only have to stop the search
+    cancelSearch();
+}
+
+std::shared_ptr<LogFileModel::MappedFile> LogFileModel::mapFile(const QString &filePath)
+{
+    auto mappedFile = std::make_shared<MappedFile>();
+    mappedFile->file.setFileName(filePath);
+
+    if (!mappedFile->file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Failed to open log file:" << filePath;
+        return nullptr;
+    }
+
+    // Empty files can not be mapped
+    mappedFile->size = mappedFile->file.size();
+    if (mappedFile->size == 0) {
+        return mappedFile;
+    }
+
+    uchar *data = mappedFile->file.map(0, mappedFile->size);
+    if (data == nullptr) {
+        qWarning() << "Failed to map log file:" << filePath;
+        return nullptr;
+    }
+    mappedFile->data = reinterpret_cast<const char *>(data);
+
+    return mappedFile;
+}
+
+bool LogFileModel::open(const QString &filePath)
+{
+    close();
+
+    std::shared_ptr<MappedFile> newMappedFile = mapFile(filePath);
+    if (newMappedFile == nullptr) {
+        return false;
+    }
+
+    this->filePath = filePath;
+    setMappedFile(newMappedFile, QFileInfo(filePath).lastModified());
+    return true;
+}
+
+void LogFileModel::setMappedFile(const std::shared_ptr<MappedFile> &newMappedFile, const QDateTime &lastModified)
+{
+    beginResetModel();
+    mappedFile = newMappedFile;
+    fileLastModified = lastModified;
+    lineOffsets.clear();
+    indexedOffset = 0;
+    if (mappedFile->size > 0) {
+        lineOffsets << 0;
+    }
+    endResetModel();
+
+    indexNextChunk();
+}
+
+void LogFileModel::close()
+{
+    cancelSearch();
+
+    // The result of a running chunk is thrown away
+    indexSequence++;
+    isIndexPending = false;
+
+    // Running tasks keep a reference to the mapping
+    // Wait for them so the file is really released when we return
+    // The search stops at its next line and a chunk is small so this is quick
+    searchWatcher.waitForFinished();
+    searchPool->waitForDone();
+    indexWatcher.waitForFinished();
+
+    beginResetModel();
+    filePath.clear();
+    mappedFile.reset();
+    lineOffsets.clear();
+    indexedOffset = 0;
+    endResetModel();
+}
+
+bool LogFileModel::isOpen() const
+{
+    return mappedFile != nullptr;
+}
+
+bool LogFileModel::isIndexing() const
+{
+    return isIndexPending;
+}
+
+qint64 LogFileModel::getFileSize() const
+{
+    return mappedFile ? mappedFile->size : 0;
+}
+
+int LogFileModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+
+    return static_cast<int>(lineOffsets.size());
+}
+
+QByteArrayView LogFileModel::getLine(const MappedFile &mappedFile, const QList<qint64> &lineOffsets, qsizetype row)
+{
+    qint64 start = lineOffsets.at(row);
+    qint64 end = row + 1 < lineOffsets.size() ? lineOffsets.at(row + 1) : mappedFile.size;
+
+    // Strip the line ending
+    while (end > start && (mappedFile.data[end - 1] == '\n' || mappedFile.data[end - 1] == '\r')) {
+        end--;
+    }
+
+    return QByteArrayView(mappedFile.data + start, end - start);
+}
+
+QVariant LogFileModel::data(const QModelIndex &index, int role) const
+{
+    if (index.isValid() == false || index.row() >= lineOffsets.size() || mappedFile == nullptr) {
+        return QVariant();
+    }
+
+    if (role == Qt::DisplayRole) {
+        QByteArrayView line = getLine(*mappedFile, lineOffsets, index.row());
+        return QString::fromUtf8(line.first(qMin(line.size(), qsizetype(LOG_MAX_LINE_LENGTH))));
+    }
+
+    return QVariant();
+}
+
+void LogFileModel::indexNextChunk()
+{
+    if (mappedFile == nullptr || isIndexPending || indexedOffset >= mappedFile->size) {
+        return;
+    }
+
+    std::shared_ptr<MappedFile> chunkFile = mappedFile;
+    qint64 chunkStart = indexedOffset;
+    qint64 chunkEnd = qMin(chunkFile->size, chunkStart + LOG_INDEX_CHUNK_SIZE);
+    int sequence = ++indexSequence;
+
+    // Find the start of every line in this chunk
+    isIndexPending = true;
+    indexWatcher.setFuture(TaskScheduler::run(TaskScheduler::Pool::IO, [chunkFile, chunkStart, chunkEnd, sequence]() {
+        IndexResult result = {sequence, {}};
+        const char *pos = chunkFile->data + chunkStart;
+        const char *end = chunkFile->data + chunkEnd;
+        while (pos < end) {
+            const char *newline = static_cast<const char *>(std::memchr(pos, '\n', end - pos));
+            if (newline == nullptr) {
+                break;
+            }
+
+            // A line only starts after a newline when there is data after it
+            qint64 lineStart = (newline - chunkFile->data) + 1;
+            if (lineStart < chunkFile->size) {
+                result.lineOffsets << lineStart;
+            }
+            pos = newline + 1;
+        }
+        return result;
+    }));
+
+    indexedOffset = chunkEnd;
+}
+
+void LogFileModel::handleIndexResult()
+{
+    IndexResult result = indexWatcher.result();
+    if (isIndexPending == false || result.sequence != indexSequence) {
+        return;
+    }
+    isIndexPending = false;
+
+    if (result.lineOffsets.isEmpty() == false) {
+        beginInsertRows(QModelIndex(), lineOffsets.size(), lineOffsets.size() + result.lineOffsets.size() - 1);
+        lineOffsets.append(result.lineOffsets);
+        endInsertRows();
+    }
+
+    if (indexedOffset < mappedFile->size) {
+        indexNextChunk();
+    } else {
+        emit indexingFinished();
+    }
+}
+
+void LogFileModel::refresh()
+{
+    if (filePath.isEmpty() || isIndexPending) {
+        return;
+    }
+
+    QFileInfo fileInfo(filePath);
+    if (fileInfo.exists() == false) {
+        return;
+    }
+
+    // Nothing changed
+    qint64 oldSize = mappedFile ? mappedFile->size : 0;
+    if (fileInfo.size() == oldSize && fileInfo.lastModified() == fileLastModified) {
+        return;
+    }
+
+    // Start over when the file got smaller or was rewritten
+    // Running tasks keep their own reference to the old mapping so we do not wait for them
+    if (fileInfo.size() <= oldSize) {
+        std::shared_ptr<MappedFile> newMappedFile = mapFile(filePath);
+        if (newMappedFile == nullptr) {
+            return;
+        }
+
+        cancelSearch();
+        indexSequence++;
+        setMappedFile(newMappedFile, fileInfo.lastModified());
+        return;
+    }
+
+    // Map the file again to include the new data
+    std::shared_ptr<MappedFile> newMappedFile = mapFile(filePath);
+    if (newMappedFile == nullptr) {
+        return;
+    }
+    mappedFile = newMappedFile;
+    fileLastModified = fileInfo.lastModified();
+
+    // The last line might have been completed
+    if (lineOffsets.isEmpty() == false) {
+        QModelIndex lastIndex = index(lineOffsets.size() - 1);
+        emit dataChanged(lastIndex, lastIndex);
+    }
+
+    // The old data ended on a newline so the new data starts a new line
+    if (oldSize == 0 || mappedFile->data[oldSize - 1] == '\n') {
+        beginInsertRows(QModelIndex(), lineOffsets.size(), lineOffsets.size());
+        lineOffsets << oldSize;
+        endInsertRows();
+    }
+
+    indexNextChunk();
+}
+
+void LogFileModel::search(const QRegularExpression &regex)
+{
+    cancelSearch();
+
+    if (mappedFile == nullptr || lineOffsets.isEmpty()) {
+        emit searchFinished({});
+        return;
+    }
+
+    // The tasks work on a copy of the index and their own reference to the mapping
+    std::shared_ptr<MappedFile> searchFile = mappedFile;
+    QList<qint64> searchOffsets = lineOffsets;
+    std::shared_ptr<std::atomic<bool>> canceled = std::make_shared<std::atomic<bool>>(false);
+    std::shared_ptr<QThreadPool> pool = searchPool;
+    int sequence = ++searchSequence;
+
+    // Plain text is matched on the bytes of the lines so they do not have to be decoded
+    // Ignoring the case this way only works for ASCII text
+    static const QRegularExpression specialCharacterRegex(R"([\\^$.|?*+()\[\]{}])");
+    QString pattern = regex.pattern();
+    bool isCaseInsensitive = regex.patternOptions().testFlag(QRegularExpression::CaseInsensitiveOption);
+    bool isPlainText = pattern.contains(specialCharacterRegex) == false
+                       && (isCaseInsensitive == false || std::all_of(pattern.cbegin(), pattern.cend(), [](QChar c) { return c.unicode() < 0x80; }));
+    QByteArray plainText = pattern.toUtf8();
+
+    searchCanceled = canceled;
+    isSearchPending = true;
+
+    searchWatcher.setFuture(TaskScheduler::run(TaskScheduler::Pool::CPU, [pool, searchFile, searchOffsets, regex, isPlainText, isCaseInsensitive, plainText, canceled, sequence]() {
+        // Split the lines over multiple tasks
+        QList<QFuture<QList<int>>> futures;
+        for (qsizetype first = 0; first < searchOffsets.size(); first += LOG_SEARCH_LINES_PER_TASK) {
+            qsizetype last = qMin(searchOffsets.size(), first + LOG_SEARCH_LINES_PER_TASK);
+            futures << QtConcurrent::run(pool.get(), [searchFile, searchOffsets, regex, isPlainText, isCaseInsensitive, plainText, canceled, first, last]() {
+                QByteArrayMatcher plainTextMatcher(plainText);
+                QLatin1String plainTextLatin1(plainText.constData(), plainText.size());
+                QList<int> rows;
+                for (qsizetype row = first; row < last && canceled->load() == false; ++row) {
+                    QByteArrayView line = getLine(*searchFile, searchOffsets, row);
+
+                    bool isMatch;
+                    if (isPlainText == false) {
+                        isMatch = regex.match(QString::fromUtf8(line)).hasMatch();
+                    } else if (isCaseInsensitive) {
+                        isMatch = QLatin1String(line.data(), line.size()).contains(plainTextLatin1, Qt::CaseInsensitive);
+                    } else {
+                        isMatch = plainTextMatcher.indexIn(line.data(), line.size()) != -1;
+                    }
+
+                    if (isMatch) {
+                        rows << static_cast<int>(row);
+                    }
+                }
+                return rows;
+            });
+        }
+
+        // Combine the results in order
+        SearchResult result = {sequence, {}};
+        for (QFuture<QList<int>> &future : futures) {
+            QList<int> rows = future.result();
+            if (result.matchingRows.size() < LOG_SEARCH_MAX_MATCHES) {
+                result.matchingRows.append(rows.first(qMin(rows.size(), LOG_SEARCH_MAX_MATCHES - result.matchingRows.size())));
+            }
+        }
+
+        return result;
+    }));
+}
+
+void LogFileModel::handleSearchResult()
+{
+    SearchResult result = searchWatcher.result();
+    if (isSearchPending == false || result.sequence != searchSequence) {
+        return;
+    }
+    isSearchPending = false;
+    searchCanceled.reset();
+
+    emit searchFinished(result.matchingRows);
+}
+
+void LogFileModel::cancelSearch()
+{
+    searchSequence++;
+    isSearchPending = false;
+
+    if (searchCanceled) {
+        searchCanceled->store(true);
+        searchCanceled.reset();
+    }
+}
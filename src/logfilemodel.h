@@ -0,0 +1,98 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QDateTime>
+#include <QFile>
+#include <QFutureWatcher>
+#include <QList>
+#include <QRegularExpression>
+#include <QThreadPool>
+
+#include <atomic>
+#include <memory>
+
+// List model of the lines of a (huge) log file
+// The file is memory mapped and the lines are only decoded when they are shown
+class LogFileModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    explicit LogFileModel(QObject *parent = nullptr);
+    ~LogFileModel();
+
+    bool open(const QString &filePath);
+    void close();
+
+    bool isOpen() const;
+    bool isIndexing() const;
+    qint64 getFileSize() const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    // Searches all lines in the background and emits searchFinished()
+    void search(const QRegularExpression &regex);
+    void cancelSearch();
+
+public slots:
+    // Picks up lines that were added to the file since the last refresh
+    void refresh();
+
+signals:
+    void indexingFinished();
+    void searchFinished(const QList<int> &matchingRows);
+
+private:
+    // A read-only mapping of the file
+    // Background tasks keep their own reference so the file can be remapped while they run
+    struct MappedFile
+    {
+        QFile file;
+        const char *data = nullptr;
+        qint64 size = 0;
+
+        ~MappedFile();
+    };
+
+    QString filePath;
+    QDateTime fileLastModified;
+    std::shared_ptr<MappedFile> mappedFile;
+
+    // Start offset of every line
+    QList<qint64> lineOffsets;
+    qint64 indexedOffset = 0;
+
+    // Results of the background tasks
+    // The sequence is used to ignore results of tasks that are no longer wanted
+    struct IndexResult
+    {
+        int sequence;
+        QList<qint64> lineOffsets;
+    };
+    struct SearchResult
+    {
+        int sequence;
+        QList<int> matchingRows;
+    };
+
+    QFutureWatcher<IndexResult> indexWatcher;
+    int indexSequence = 0;
+    bool isIndexPending = false;
+
+    QFutureWatcher<SearchResult> searchWatcher;
+    int searchSequence = 0;
+    bool isSearchPending = false;
+    std::shared_ptr<std::atomic<bool>> searchCanceled;
+
+    // Pool for the search tasks so they can be waited on from the global pool
+    std::shared_ptr<QThreadPool> searchPool;
+
+    static std::shared_ptr<MappedFile> mapFile(const QString &filePath);
+    void setMappedFile(const std::shared_ptr<MappedFile> &newMappedFile, const QDateTime &lastModified);
+    static QByteArrayView getLine(const MappedFile &mappedFile, const QList<qint64> &lineOffsets, qsizetype row);
+
+    void indexNextChunk();
+    void handleIndexResult();
+    void handleSearchResult();
+};
@@ -1,53 +1,213 @@
 #include "logger.h"
+#include "gzip.h"
 #include "launcheroptions.h"
 
 #include <QDateTime>
 #include <QDir>
-#include <QTextStream>
 #include <QCoreApplication>
 #include <QFileInfo>
 #include <QMutex>
+#include <QSaveFile>
+
+#include <cstdio>
+
+// How often the writer thread writes and flushes the queued messages
+#define LOG_FLUSH_INTERVAL_MS 250
+
+// Amount of queued messages that makes the writer thread start right away
+#define LOG_QUEUE_FLUSH_SIZE 1000
+
+// Size at which the launcher log is rotated
+#define LOG_MAX_FILE_SIZE (10 * 1024 * 1024)
+
+// Amount of compressed old logs we keep
+#define LOG_ROTATED_FILE_COUNT 3
 
 QFile *Logger::logFile = nullptr;
-QMutex Logger::logMutex;
+QString Logger::logFileBasePath;
+
+QList<Logger::Entry> Logger::queue;
+QMutex Logger::queueMutex;
+QWaitCondition Logger::queueCondition;
+bool Logger::isFlushRequested = false;
+bool Logger::isStopping = false;
+
+QRecursiveMutex Logger::writeMutex;
+
+QThread *Logger::writerThread = nullptr;
 
 void Logger::handler(QtMsgType type,
     const QMessageLogContext &context,
     const QString &msg)
 {
-    Q_UNUSED(context);
+    // Messages of the default category are shown without a category
+    QString category;
+    if (context.category && qstrcmp(context.category, "default") != 0) {
+        category = QString::fromLatin1(context.category);
+    }
+
+    Entry entry{type, QDateTime::currentDateTime(), category, msg};
+
+    // Write everything right away as we are about to abort
+    if (type == QtFatalMsg) {
+        Logger::writeNow(entry);
+
+        if (Logger::logFile && Logger::logFile->isOpen()) {
+            Logger::logFile->close();
+        }
+        abort();
+    }
+
+    QMutexLocker locker(&Logger::queueMutex);
+
+    // Write it ourselves when there is no writer thread
+    if (Logger::writerThread == nullptr || Logger::isStopping) {
+        locker.unlock();
+        Logger::writeNow(entry);
+        return;
+    }
 
-    QMutexLocker locker(&Logger::logMutex);
+    Logger::queue << entry;
 
-    const QString typeStr = Logger::getMessageTypeString(type);
-    const QString timeStamp =
-        QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss");
+    // Do not let warnings and errors wait for the next interval
+    if ((type != QtDebugMsg && type != QtInfoMsg) || Logger::queue.size() >= LOG_QUEUE_FLUSH_SIZE) {
+        Logger::isFlushRequested = true;
+        Logger::queueCondition.wakeOne();
+    }
+}
+
+void Logger::writeNow(const Entry &entry)
+{
+    QMutexLocker writeLocker(&Logger::writeMutex);
 
-    // Console output
+    // Messages that are still queued go first
+    QList<Entry> entries;
     {
+        QMutexLocker locker(&Logger::queueMutex);
+        entries.swap(Logger::queue);
+    }
+    entries << entry;
+
+    Logger::writeEntries(entries);
+}
+
+void Logger::runWriter()
+{
+    // Keep the log of the last run
+    if (Logger::logFile) {
+        QMutexLocker writeLocker(&Logger::writeMutex);
+        Logger::rotateLogFile();
+        Logger::openLogFile();
+    }
+
+    bool isDone = false;
+    while (isDone == false) {
+
+        // Wait for the interval or until something urgent comes in
+        {
+            QMutexLocker locker(&Logger::queueMutex);
+            if (Logger::isFlushRequested == false && Logger::isStopping == false) {
+                Logger::queueCondition.wait(&Logger::queueMutex, LOG_FLUSH_INTERVAL_MS);
+            }
+            Logger::isFlushRequested = false;
+            isDone = Logger::isStopping;
+        }
+
+        QMutexLocker writeLocker(&Logger::writeMutex);
+
+        QList<Entry> entries;
+        {
+            QMutexLocker locker(&Logger::queueMutex);
+            entries.swap(Logger::queue);
+        }
+
+        Logger::writeEntries(entries);
+
+        // Rotate when the log gets too big
+        if (Logger::logFile && Logger::logFile->isOpen() && Logger::logFile->size() > LOG_MAX_FILE_SIZE) {
+            Logger::rotateLogFile();
+            Logger::openLogFile();
+        }
+    }
+}
+
+void Logger::writeEntries(const QList<Entry> &entries)
+{
+    if (entries.isEmpty()) {
+        return;
+    }
+
+    QByteArray fileData;
+
+    for (const Entry &entry : entries) {
+        const QByteArray line = (entry.time.toString("yyyy-MM-dd HH:mm:ss") + " "
+                                 + Logger::getMessageTypeString(entry.type)
+                                 + (entry.category.isEmpty() ? "" : " " + entry.category) + ": "
+                                 + entry.message + "\n").toUtf8();
+
+        // Console output
         FILE *stream =
-            (type == QtDebugMsg || type == QtInfoMsg)
+            (entry.type == QtDebugMsg || entry.type == QtInfoMsg)
                 ? stdout
                 : stderr;
+        fwrite(line.constData(), 1, line.size(), stream);
 
-        QTextStream consoleOut(stream);
-        consoleOut << timeStamp << " " << typeStr << ": " << msg << Qt::endl;
-        consoleOut.flush();
+        fileData.append(line);
     }
 
+    fflush(stdout);
+    fflush(stderr);
+
     // File output
     if (Logger::logFile && Logger::logFile->isOpen()) {
-        QTextStream out(Logger::logFile);
-        out << timeStamp << " " << typeStr << ": " << msg << Qt::endl;
-        out.flush();
+        Logger::logFile->write(fileData);
+        Logger::logFile->flush();
     }
+}
 
-    if (type == QtFatalMsg) {
-        if (Logger::logFile && Logger::logFile->isOpen()) {
-            Logger::logFile->close();
-        }
-        abort();
+void Logger::openLogFile()
+{
+    if (Logger::logFile->isOpen()) {
+        Logger::logFile->close();
+    }
+
+    if (!Logger::logFile->open(QIODevice::Truncate | QIODevice::Append | QIODevice::Text)) {
+        qWarning() << "Failed to open log output file";
+    }
+}
+
+void Logger::rotateLogFile()
+{
+    if (Logger::logFile->isOpen()) {
+        Logger::logFile->close();
+    }
+
+    QFile currentFile(Logger::logFile->fileName());
+    if (currentFile.size() == 0 || !currentFile.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    // Shift the older logs
+    QFile::remove(Logger::getRotatedLogFilePath(LOG_ROTATED_FILE_COUNT));
+    for (int i = LOG_ROTATED_FILE_COUNT - 1; i >= 1; i--) {
+        QFile::rename(Logger::getRotatedLogFilePath(i), Logger::getRotatedLogFilePath(i + 1));
+    }
+
+    // Compress the current log
+    QByteArray compressedData = GZip::compress(currentFile.readAll(), Z_DEFAULT_COMPRESSION);
+    currentFile.close();
+
+    QSaveFile rotatedFile(Logger::getRotatedLogFilePath(1));
+    if (compressedData.isEmpty() || !rotatedFile.open(QIODevice::WriteOnly)) {
+        return;
     }
+    rotatedFile.write(compressedData);
+    rotatedFile.commit();
+}
+
+QString Logger::getRotatedLogFilePath(int index)
+{
+    return Logger::logFileBasePath + "." + QString::number(index) + ".log.gz";
 }
 
 void Logger::setupHandler()
@@ -57,21 +217,40 @@ void Logger::setupHandler()
 
     } else {
 
-        Logger::logFile = new QFile(
-            QCoreApplication::applicationDirPath()
-            + QDir::separator()
-            + QFileInfo(QCoreApplication::applicationFilePath()).baseName()
-            + ".log"
-        );
-
-        if (!Logger::logFile->open(QIODevice::Truncate | QIODevice::Append | QIODevice::Text)) {
-            delete Logger::logFile;
-            Logger::logFile = nullptr;
-            qWarning() << "Failed to open log output file";
-        }
+        Logger::logFileBasePath = QCoreApplication::applicationDirPath()
+                                  + QDir::separator()
+                                  + QFileInfo(QCoreApplication::applicationFilePath()).baseName();
+
+        // The file is opened by the writer thread
+        Logger::logFile = new QFile(Logger::logFileBasePath + ".log");
     }
 
     qInstallMessageHandler(Logger::handler);
+
+    // Write the messages on a background thread so logging does not wait for the disk
+    Logger::writerThread = QThread::create(&Logger::runWriter);
+    Logger::writerThread->start();
+
+    // Make sure everything is written when the app closes
+    qAddPostRoutine(Logger::stop);
+}
+
+void Logger::stop()
+{
+    {
+        QMutexLocker locker(&Logger::queueMutex);
+        if (Logger::writerThread == nullptr || Logger::isStopping) {
+            return;
+        }
+        Logger::isStopping = true;
+        Logger::queueCondition.wakeOne();
+    }
+
+    Logger::writerThread->wait();
+
+    QMutexLocker locker(&Logger::queueMutex);
+    delete Logger::writerThread;
+    Logger::writerThread = nullptr;
 }
 
 QString Logger::getMessageTypeString(QtMsgType type)
@@ -1,7 +1,12 @@
 #pragma once
 
+#include <QDateTime>
 #include <QFile>
+#include <QList>
 #include <QMutex>
+#include <QRecursiveMutex>
+#include <QThread>
+#include <QWaitCondition>
 #include <QtGlobal>
 
 class Logger
@@ -9,13 +14,45 @@ class Logger
 public:
     static void setupHandler();
 
+    // Writes the remaining messages and stops the writer thread
+    static void stop();
+
 private:
+    struct Entry
+    {
+        QtMsgType type;
+        QDateTime time;
+        QString category;
+        QString message;
+    };
+
     static QFile *logFile;
-    static QMutex logMutex;
+    static QString logFileBasePath;
+
+    // Messages waiting for the writer thread
+    // The lock is only held to add or take messages
+    static QList<Entry> queue;
+    static QMutex queueMutex;
+    static QWaitCondition queueCondition;
+    static bool isFlushRequested;
+    static bool isStopping;
+
+    // Held while writing so the output of different threads does not get mixed up
+    static QRecursiveMutex writeMutex;
+
+    static QThread *writerThread;
 
     static void handler(QtMsgType type,
         const QMessageLogContext &context,
         const QString &msg);
 
+    static void runWriter();
+    static void writeNow(const Entry &entry);
+    static void writeEntries(const QList<Entry> &entries);
+
+    static void openLogFile();
+    static void rotateLogFile();
+    static QString getRotatedLogFilePath(int index);
+
     static QString getMessageTypeString(QtMsgType type);
 };
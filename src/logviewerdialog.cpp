@@ -0,0 +1,236 @@
+#include "logviewerdialog.h"
+#include "ui_logviewerdialog.h"
+
+#include <QDesktopServices>
+#include <QFileInfo>
+#include <QFontDatabase>
+#include <QRegularExpression>
+#include <QUrl>
+
+#include <algorithm>
+
+// Time between checks for new lines in the log
+#define LOG_VIEWER_TAIL_INTERVAL_MS 1000
+
+// Maximum time to wait for the game to start a new log
+#define LOG_VIEWER_GAME_START_TIMEOUT_MS 10000
+
+LogViewerDialog::LogViewerDialog(Game *game, const QString &filePath, QWidget *parent)
+    : QDialog(parent)
+    , ui(new Ui::LogViewerDialog)
+    , filePath(filePath)
+    , model(new LogFileModel(this))
+{
+    ui->setupUi(this);
+
+    // Show the log file name in the title
+    setWindowTitle(windowTitle() + " - " + QFileInfo(filePath).fileName());
+
+    // Only the visible lines are read from the file
+    ui->listView->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    ui->listView->setModel(model);
+
+    connect(model, &QAbstractItemModel::rowsInserted, this, &LogViewerDialog::onRowsInserted);
+    connect(model, &QAbstractItemModel::modelReset, this, &LogViewerDialog::updateStatus);
+    connect(model, &LogFileModel::indexingFinished, this, &LogViewerDialog::updateStatus);
+    connect(model, &LogFileModel::searchFinished, this, &LogViewerDialog::onSearchFinished);
+
+    // Release the log when the game starts
+    connect(game, &Game::gameStarting, this, &LogViewerDialog::onGameStarting);
+
+    // Open the log
+    if (model->open(filePath) == false) {
+        ui->statusLabel->setText(tr("Failed to open the log file", "Status Label"));
+    }
+
+    // Follow the log while the game is writing to it
+    tailTimer.setInterval(LOG_VIEWER_TAIL_INTERVAL_MS);
+    connect(&tailTimer, &QTimer::timeout, this, &LogViewerDialog::onTailTimer);
+    tailTimer.start();
+
+    updateStatus();
+}
+
+LogViewerDialog::~LogViewerDialog()
+{
+    delete ui;
+}
+
+void LogViewerDialog::on_closeButton_clicked()
+{
+    this->close();
+}
+
+void LogViewerDialog::on_openExternallyButton_clicked()
+{
+    QDesktopServices::openUrl(QUrl::fromLocalFile(filePath));
+}
+
+void LogViewerDialog::onTailTimer()
+{
+    if (isWaitingForGame == false) {
+        model->refresh();
+        return;
+    }
+
+    // Open the log again once the game has started a new one
+    QFileInfo fileInfo(filePath);
+    if ((fileInfo.exists() && fileInfo.lastModified() != releasedLastModified) || waitForGameTimer.elapsed() > LOG_VIEWER_GAME_START_TIMEOUT_MS) {
+        isWaitingForGame = false;
+        model->open(filePath);
+        updateStatus();
+    }
+}
+
+void LogViewerDialog::onGameStarting()
+{
+    // The game truncates the log when it starts
+    // A mapped file can not be truncated on Windows and reading it afterwards crashes on Linux
+    releasedLastModified = QFileInfo(filePath).lastModified();
+    waitForGameTimer.start();
+    isWaitingForGame = true;
+
+    model->close();
+    matchingRows.clear();
+    currentMatch = -1;
+    isSearching = false;
+    searchedPattern.clear();
+
+    updateStatus();
+}
+
+void LogViewerDialog::onRowsInserted()
+{
+    if (ui->followCheckBox->isChecked()) {
+        ui->listView->scrollToBottom();
+    }
+
+    updateStatus();
+}
+
+bool LogViewerDialog::startSearchIfChanged()
+{
+    QString pattern = ui->searchLineEdit->text();
+    Qt::CaseSensitivity caseSensitivity = ui->caseSensitiveCheckBox->isChecked() ? Qt::CaseSensitive : Qt::CaseInsensitive;
+
+    // Nothing to search for
+    if (pattern.isEmpty()) {
+        model->cancelSearch();
+        searchedPattern.clear();
+        matchingRows.clear();
+        currentMatch = -1;
+        isSearching = false;
+        updateStatus();
+        return true;
+    }
+
+    // Same search as before
+    if (pattern == searchedPattern && caseSensitivity == searchedCaseSensitivity) {
+        return isSearching;
+    }
+
+    QRegularExpression regex(pattern, caseSensitivity == Qt::CaseSensitive ? QRegularExpression::NoPatternOption : QRegularExpression::CaseInsensitiveOption);
+    if (regex.isValid() == false) {
+        ui->statusLabel->setText(tr("Invalid regular expression: %1", "Status Label").arg(regex.errorString()));
+        return true;
+    }
+
+    // Compile the pattern once before it is copied to the search tasks
+    regex.optimize();
+
+    searchedPattern = pattern;
+    searchedCaseSensitivity = caseSensitivity;
+    matchingRows.clear();
+    currentMatch = -1;
+    isSearching = true;
+
+    model->search(regex);
+    updateStatus();
+    return true;
+}
+
+void LogViewerDialog::on_searchLineEdit_returnPressed()
+{
+    on_nextButton_clicked();
+}
+
+void LogViewerDialog::on_nextButton_clicked()
+{
+    // A new search shows the first match when it is done
+    if (startSearchIfChanged() || matchingRows.isEmpty()) {
+        return;
+    }
+
+    showMatch((currentMatch + 1) % matchingRows.size());
+}
+
+void LogViewerDialog::on_previousButton_clicked()
+{
+    if (startSearchIfChanged() || matchingRows.isEmpty()) {
+        return;
+    }
+
+    showMatch((currentMatch - 1 + matchingRows.size()) % matchingRows.size());
+}
+
+void LogViewerDialog::onSearchFinished(const QList<int> &matchingRows)
+{
+    this->isSearching = false;
+    this->matchingRows = matchingRows;
+    this->currentMatch = -1;
+
+    // Jump to the first match after the current position
+    if (matchingRows.isEmpty() == false) {
+        int currentRow = ui->listView->currentIndex().isValid() ? ui->listView->currentIndex().row() : 0;
+        auto it = std::lower_bound(matchingRows.constBegin(), matchingRows.constEnd(), currentRow);
+        showMatch(it == matchingRows.constEnd() ? 0 : static_cast<int>(it - matchingRows.constBegin()));
+    }
+
+    updateStatus();
+}
+
+void LogViewerDialog::showMatch(int match)
+{
+    currentMatch = match;
+
+    // Stop following so the match stays in view
+    ui->followCheckBox->setChecked(false);
+
+    QModelIndex index = model->index(matchingRows.at(match));
+    ui->listView->setCurrentIndex(index);
+    ui->listView->scrollTo(index, QAbstractItemView::PositionAtCenter);
+
+    updateStatus();
+}
+
+void LogViewerDialog::updateStatus()
+{
+    if (isWaitingForGame) {
+        ui->statusLabel->setText(tr("Waiting for the game to start a new log...", "Status Label"));
+        return;
+    }
+
+    if (model->isOpen() == false) {
+        return;
+    }
+
+    QString status = tr("%1 lines (%2 MB)", "Status Label")
+                         .arg(model->rowCount())
+                         .arg(model->getFileSize() / (1024.0 * 1024.0), 0, 'f', 1);
+
+    if (model->isIndexing()) {
+        status += " - " + tr("Indexing...", "Status Label");
+    }
+
+    if (isSearching) {
+        status += " - " + tr("Searching...", "Status Label");
+    } else if (searchedPattern.isEmpty() == false) {
+        if (matchingRows.isEmpty()) {
+            status += " - " + tr("No matches", "Status Label");
+        } else {
+            status += " - " + tr("Match %1 of %2", "Status Label").arg(currentMatch + 1).arg(matchingRows.size());
+        }
+    }
+
+    ui->statusLabel->setText(status);
+}
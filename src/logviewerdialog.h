@@ -0,0 +1,55 @@
+#pragma once
+
+#include "game.h"
+#include "logfilemodel.h"
+
+#include <QDateTime>
+#include <QDialog>
+#include <QElapsedTimer>
+#include <QTimer>
+
+namespace Ui { class LogViewerDialog; }
+
+class LogViewerDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit LogViewerDialog(Game *game, const QString &filePath, QWidget *parent = nullptr);
+    ~LogViewerDialog();
+
+private slots:
+    void on_closeButton_clicked();
+    void on_openExternallyButton_clicked();
+    void on_nextButton_clicked();
+    void on_previousButton_clicked();
+    void on_searchLineEdit_returnPressed();
+
+    void onTailTimer();
+    void onGameStarting();
+    void onRowsInserted();
+    void onSearchFinished(const QList<int> &matchingRows);
+
+private:
+    Ui::LogViewerDialog *ui;
+
+    QString filePath;
+    LogFileModel *model;
+    QTimer tailTimer;
+
+    // Search state
+    QString searchedPattern;
+    Qt::CaseSensitivity searchedCaseSensitivity = Qt::CaseInsensitive;
+    QList<int> matchingRows;
+    int currentMatch = -1;
+    bool isSearching = false;
+
+    // The log is released while the game starts so the game can overwrite it
+    bool isWaitingForGame = false;
+    QDateTime releasedLastModified;
+    QElapsedTimer waitForGameTimer;
+
+    bool startSearchIfChanged();
+    void showMatch(int match);
+    void updateStatus();
+};
@@ -1,6 +1,7 @@
 #include <QApplication>
 #include <QFileInfo>
 #include <QGuiApplication>
+#include <QLoggingCategory>
 #include <QProcess>
 #include <QSettings>
 #include <QSslConfiguration>
@@ -14,11 +15,13 @@
 using namespace Qt::StringLiterals;
 
 #include "crashdialog.h"
+#include "gzip.h"
 #include "helper.h"
 #include "launchermainwindow.h"
 #include "launcheroptions.h"
 #include "logger.h"
 #include "settings.h"
+#include "taskscheduler.h"
 #include "translator.h"
 #include "version.h"
 
@@ -65,9 +68,19 @@ int main(int argc, char *argv[])
     // Parse launcher options
     LauncherOptions::processApp(app);
 
+    // Apply the logging rules of the user
+    // Multiple rules are separated by a ';'
+    if (LauncherOptions::isSet("log-rules") == true) {
+        QLoggingCategory::setFilterRules(LauncherOptions::getValue("log-rules").replace(';', '\n'));
+    }
+
     // Check if we need to write debug logs to a logfile
     Logger::setupHandler();
 
+    // Stop the background tasks when the app closes
+    // This runs before the logger stops so its messages are still written
+    qAddPostRoutine(TaskScheduler::shutdown);
+
     // Start the log
     qInfo().noquote() << "KeeperFX Launcher " << LAUNCHER_VERSION;
 
@@ -307,6 +320,12 @@ int main(int argc, char *argv[])
         return 0;
     }
 
+    // Compare the single threaded and parallel GZip compression
+    if (LauncherOptions::isSet("benchmark-gzip") == true) {
+        qDebug() << "Benchmarking GZip compression (benchmark-gzip)";
+        return GZip::benchmark(LauncherOptions::getValue("benchmark-gzip")) ? 0 : 1;
+    }
+
     // Create the main window and show it
     LauncherMainWindow mainWindow;
     mainWindow.show();
@@ -1,10 +1,18 @@
 #include "map.h"
+#include "logcategories.h"
 
 #include <QCoreApplication>
 #include <QDir>
+#include <QFileInfo>
+#include <QFuture>
+#include <QMap>
 #include <QRegularExpression>
-#include <QSettings>
+#include <QSet>
 #include <QString>
+#include <QtConcurrent/QtConcurrentRun>
+
+QHash<QString, Map::CatalogCacheEntry> Map::catalogCache;
+QMutex Map::catalogCacheMutex;
 
 // Constructor
 Map::Map(const Map::Type type, const QString campaignOrMapPackName, const int mapNumber)
@@ -14,6 +22,49 @@ Map::Map(const Map::Type type, const QString campaignOrMapPackName, const int ma
     this->mapNumber = mapNumber;
     this->format = Map::Format::UNKNOWN;
 
+    // Get the campaign/levels dir of this map
+    QString campaignOrMapPackDirString = Map::getMapDirString(type, campaignOrMapPackName);
+    if (campaignOrMapPackDirString.isEmpty()) {
+        return;
+    }
+
+    // Map number string
+    // Creates a 5 digit number string of the number
+    // Ex: 123 -> "00123", 12345 -> "12345"
+    QString mapNumberString = QString("%1").arg(this->mapNumber, 5, 10, QChar('0'));
+
+    // Create the filename filter
+    QStringList mapFileFilter;
+    mapFileFilter << QString("*" + mapNumberString + ".*");
+
+    // Collect the map files
+    // We only list the directory once and let the loader pick the file to use
+    Map::MapFiles mapFiles;
+    QDir campaignOrMapPackDir(campaignOrMapPackDirString);
+    for (const QString &mapFileNameString : campaignOrMapPackDir.entryList(mapFileFilter, QDir::Files)) {
+        Map::addMapFile(mapFiles, campaignOrMapPackDirString + "/" + mapFileNameString);
+    }
+
+    // Load the map
+    this->mapDirString = campaignOrMapPackDirString;
+    this->loadFiles(mapFiles);
+}
+
+// Constructor for maps of which the files are already known
+// This is used by the catalog scanner so the map dir does not have to be listed for every map
+Map::Map(const Map::Type type, const QString campaignOrMapPackName, const int mapNumber, const Map::MapFiles &mapFiles)
+{
+    this->type = type;
+    this->campaignOrMapPackName = campaignOrMapPackName;
+    this->mapNumber = mapNumber;
+    this->format = Map::Format::UNKNOWN;
+    this->mapDirString = Map::getMapDirString(type, campaignOrMapPackName);
+
+    this->loadFiles(mapFiles);
+}
+
+QString Map::getMapDirString(const Map::Type type, const QString campaignOrMapPackName)
+{
     // Get base directory
     QString baseDirString = QCoreApplication::applicationDirPath() + "/";
     if (type == Map::Type::CAMPAIGN) {
@@ -21,66 +72,71 @@ Map::Map(const Map::Type type, const QString campaignOrMapPackName, const int ma
     } else if (type == Map::Type::STANDALONE) {
         baseDirString.append("levels");
     } else {
-        qWarning() << "Map type not implemented";
-        return;
+        qCWarning(logGame) << "Map type not implemented";
+        return QString();
     }
 
     // Make sure campaign/levels base directory exists
     QDir baseDir(baseDirString);
     if (baseDir.exists() == false) {
-        qWarning() << "Map directory does not exist:" << baseDirString;
-        return;
+        qCWarning(logGame) << "Map directory does not exist:" << baseDirString;
+        return QString();
     }
 
     // Get specific campaign/levels dir
     QString campaignOrMapPackDirString = baseDirString + "/" + campaignOrMapPackName;
     QDir campaignOrMapPackDir(campaignOrMapPackDirString);
     if (campaignOrMapPackDir.exists() == false) {
-        qWarning() << "Campaign or map pack does not exist:" << campaignOrMapPackDirString;
-        return;
+        qCWarning(logGame) << "Campaign or map pack does not exist:" << campaignOrMapPackDirString;
+        return QString();
     }
 
-    // Remember map base dir
-    this->mapDirString = campaignOrMapPackDirString;
-
-    // Map number string
-    // Creates a 5 digit number string of the number
-    // Ex: 123 -> "00123", 12345 -> "12345"
-    QString mapNumberString = QString("%1").arg(this->mapNumber, 5, 10, QChar('0'));
-
-    // Create the filename filter
-    QStringList mapFileFilter;
-    mapFileFilter << QString("*" + mapNumberString + ".*");
+    return campaignOrMapPackDirString;
+}
 
-    // Loop trough map files
-    for (QString &mapFileNameString : campaignOrMapPackDir.entryList(mapFileFilter, QDir::Files)) {
-        QString mapFileNameStringLowerCase = mapFileNameString.toLower();
+void Map::addMapFile(Map::MapFiles &mapFiles, const QString &filePath)
+{
+    QString filePathLowerCase = filePath.toLower();
 
-        // Check for LOF file
-        if (mapFileNameStringLowerCase.endsWith("lof")) {
-            QFile mapFile(campaignOrMapPackDirString + "/" + mapFileNameString);
-            loadLof(mapFile);
-            return;
+    // Only remember the first file of every type
+    // This matches the order in which the directory listing returns them
+    if (filePathLowerCase.endsWith("lof")) {
+        if (mapFiles.lofFilePath.isEmpty()) {
+            mapFiles.lofFilePath = filePath;
         }
-
-        // Check for LIF file
-        if (mapFileNameStringLowerCase.endsWith("lif")) {
-            QFile mapFile(campaignOrMapPackDirString + "/" + mapFileNameString);
-            loadLif(mapFile);
-            return;
+    } else if (filePathLowerCase.endsWith("lif")) {
+        if (mapFiles.lifFilePath.isEmpty()) {
+            mapFiles.lifFilePath = filePath;
+        }
+    } else if (filePathLowerCase.endsWith("txt")) {
+        if (mapFiles.txtFilePath.isEmpty()) {
+            mapFiles.txtFilePath = filePath;
         }
     }
+}
 
-    // Loop trough map files again for .txt level name workaround
-    for (QString &mapFileNameString : campaignOrMapPackDir.entryList(mapFileFilter, QDir::Files)) {
-        QString mapFileNameStringLowerCase = mapFileNameString.toLower();
+void Map::loadFiles(const Map::MapFiles &mapFiles)
+{
+    // Check for LIF file
+    // A directory listing is sorted by name so the LIF file was always found before the LOF file
+    if (mapFiles.lifFilePath.isEmpty() == false) {
+        QFile mapFile(mapFiles.lifFilePath);
+        loadLif(mapFile);
+        return;
+    }
 
-        // Check for LOF file
-        if (mapFileNameStringLowerCase.endsWith("txt")) {
-            QFile mapFile(campaignOrMapPackDirString + "/" + mapFileNameString);
-            loadTxtWorkaround(mapFile);
-            return;
-        }
+    // Check for LOF file
+    if (mapFiles.lofFilePath.isEmpty() == false) {
+        QFile mapFile(mapFiles.lofFilePath);
+        loadLof(mapFile);
+        return;
+    }
+
+    // Check for the .txt level name workaround
+    if (mapFiles.txtFilePath.isEmpty() == false) {
+        QFile mapFile(mapFiles.txtFilePath);
+        loadTxtWorkaround(mapFile);
+        return;
     }
 }
 
@@ -90,29 +146,31 @@ void Map::loadLof(QFile &file)
 
     // Make sure lof file is opened
     if (!file.open(QIODevice::ReadOnly)) {
-        qWarning() << "Failed to open:" << file.fileName();
+        qCWarning(logGame) << "Failed to open:" << file.fileName();
         return;
     }
 
-    // Read file
-    QString fileDataString = file.readAll();
-    file.close();
-
     // Find map name in LOF file
     // We use a regex instead of QSettings here for performance
     // and because QSettings does not always work. (No idea why)
-    QRegularExpression regex(R"(^NAME_TEXT\s*=\s*([^\r\n]+))", QRegularExpression::MultilineOption);
-    QRegularExpressionMatch match = regex.match(fileDataString);
+    static const QRegularExpression regex(R"(^NAME_TEXT\s*=\s*([^\r\n]+))");
 
-    // Make sure map name is found
-    if (match.hasMatch() == false) {
-        qWarning() << "Failed to load 'NAME_TEXT' from LOF file:" << file.fileName();
-        return;
+    // Read the file line by line until we find the map name
+    while (!file.atEnd()) {
+        QRegularExpressionMatch match = regex.match(QString::fromUtf8(file.readLine()));
+        if (match.hasMatch()) {
+            file.close();
+
+            // Load map into class
+            this->mapName = match.captured(1);
+            this->format = Map::Format::DK;
+            return;
+        }
     }
 
-    // Load map into class
-    this->mapName = match.captured(1);
-    this->format = Map::Format::DK;
+    file.close();
+
+    qCWarning(logGame) << "Failed to load 'NAME_TEXT' from LOF file:" << file.fileName();
 }
 
 void Map::loadLif(QFile &file)
@@ -121,29 +179,46 @@ void Map::loadLif(QFile &file)
 
     // Make sure file can be opened
     if (!file.open(QIODevice::ReadOnly)) {
-        qWarning() << "Failed to open LIF file:" << file.fileName();
+        qCWarning(logGame) << "Failed to open LIF file:" << file.fileName();
         return;
     }
 
-    // Read the file
-    QString data = file.readAll(); // Read entire file
-    file.close();
+    // Read the file line by line
+    // Most LIF files are a single line so this stops almost immediately
+    QString firstLine;
+    int lineCount = 0;
+    while (!file.atEnd()) {
+        QByteArray lineData = file.readLine();
+        QString line = QString::fromUtf8(lineData);
+
+        // Get mapname from a format that a translation ID
+        // This format is only used by files that have more than a single line
+        int semicolonIndex = line.indexOf(";");
+        if (semicolonIndex != -1 && (lineCount > 0 || lineData.endsWith('\n'))) {
+            file.close();
+            this->mapName = line.mid(semicolonIndex + 1).split("\r")[0].split("\n")[0];
+            this->format = Map::Format::DK;
+            return;
+        }
 
-    // Make sure some data is read
-    if (data.isEmpty() == true) {
-        return;
+        // Remember the first line
+        if (lineCount == 0) {
+            firstLine = line;
+        }
+
+        lineCount++;
     }
 
-    // Get mapname from a format that a translation ID
-    if (data.contains("\n") && data.contains(";")) {
-        this->mapName = data.mid(data.indexOf(";") + 1).split("\r")[0].split("\n")[0];
-        this->format = Map::Format::DK;
+    file.close();
+
+    // Make sure some data is read
+    if (firstLine.isEmpty() == true) {
         return;
     }
 
     // Get map name from the first line
     // We do some string splits that are crossplatform
-    QString firstLineMapName = data.split("\r")[0].split("\n")[0].split(", ")[1];
+    QString firstLineMapName = firstLine.split("\r")[0].split("\n")[0].split(", ").value(1);
     if (firstLineMapName.isEmpty() == false) {
         this->mapName = firstLineMapName;
         this->format = Map::Format::DK;
@@ -152,7 +227,7 @@ void Map::loadLif(QFile &file)
 
     // Unknown format
     // If this happens it should be fixed
-    qWarning() << "Unknown .lif format";
+    qCWarning(logGame) << "Unknown .lif format";
 }
 
 void Map::loadTxtWorkaround(QFile &file)
@@ -162,28 +237,30 @@ void Map::loadTxtWorkaround(QFile &file)
 
     // Make sure lof file is opened
     if (!file.open(QIODevice::ReadOnly)) {
-        qWarning() << "Failed to open:" << file.fileName();
+        qCWarning(logGame) << "Failed to open:" << file.fileName();
         return;
     }
 
-    // Read file
-    QString fileDataString = file.readAll();
-    file.close();
-
-    // Find map name in LOF file
+    // Find map name in the map script
     // We use a regex instead of QSettings here for performance
     // and because QSettings does not always work. (No idea why)
-    QRegularExpression regex(R"(^REM  Script for (?:Level )?([^\r\n]+))", QRegularExpression::MultilineOption);
-    QRegularExpressionMatch match = regex.match(fileDataString);
-
-    // Check if map name is found
-    if (match.hasMatch() == true) {
-        this->mapName = match.captured(1);
-        this->format = Map::Format::DK;
-        return;
+    static const QRegularExpression regex(R"(^REM  Script for (?:Level )?([^\r\n]+))");
+
+    // Read the file line by line until we find the map name
+    // The name is in the header of the script so we can skip the rest of it
+    while (!file.atEnd()) {
+        QRegularExpressionMatch match = regex.match(QString::fromUtf8(file.readLine()));
+        if (match.hasMatch() == true) {
+            file.close();
+            this->mapName = match.captured(1);
+            this->format = Map::Format::DK;
+            return;
+        }
     }
 
-    qWarning() << "Failed to load 'Script for Level' from map script:" << file.fileName();
+    file.close();
+
+    qCWarning(logGame) << "Failed to load 'Script for Level' from map script:" << file.fileName();
 }
 
 QString Map::getMapName()
@@ -211,56 +288,95 @@ QList<Map *> Map::getAll(const Map::Type type, const QString campaignOrMapPackNa
     // List to return
     QList<Map *> list;
 
-    // Get base directory
-    QString baseDirString = QCoreApplication::applicationDirPath() + "/";
-    if (type == Map::Type::CAMPAIGN) {
-        baseDirString.append("campgns");
-    } else if (type == Map::Type::STANDALONE) {
-        baseDirString.append("levels");
-    } else {
-        qWarning() << "Map type not implemented";
+    // Get the campaign/levels dir
+    QString campaignOrMapPackDirString = Map::getMapDirString(type, campaignOrMapPackName);
+    if (campaignOrMapPackDirString.isEmpty()) {
         return list; // Empty list
     }
 
-    // Make sure campaign/levels base directory exists
-    QDir baseDir(baseDirString);
-    if (baseDir.exists() == false) {
-        qWarning() << "Map directory does not exist:" << baseDirString;
-        return list; // Empty list
+    // Get the last modification time of the dir
+    // This changes whenever a file is added, removed or renamed
+    QDateTime lastModified = QFileInfo(campaignOrMapPackDirString).lastModified();
+
+    // Return copies of the cached maps if the dir did not change since the last scan
+    {
+        QMutexLocker locker(&Map::catalogCacheMutex);
+        auto it = Map::catalogCache.constFind(campaignOrMapPackDirString);
+        if (it != Map::catalogCache.constEnd() && it->lastModified == lastModified) {
+            for (const Map *map : std::as_const(it->maps)) {
+                list << new Map(*map);
+            }
+            qCDebug(logGame) << "Maps loaded from cache:" << campaignOrMapPackDirString << "->" << list.count();
+            return list;
+        }
     }
 
-    // Get specific campaign/levels dir
-    QString campaignOrMapPackDirString = baseDirString + "/" + campaignOrMapPackName;
+    // Loop trough the files once and group them by map number
+    QSet<int> datMapNumbers;
+    QMap<int, Map::MapFiles> mapFilesMap;
     QDir campaignOrMapPackDir(campaignOrMapPackDirString);
-    if (campaignOrMapPackDir.exists() == false) {
-        qWarning() << "Campaign or map pack does not exist:" << campaignOrMapPackDirString;
-        return list; // Empty list
-    }
-
-    // Loop trough the files
-    for (QString &fileNameString : campaignOrMapPackDir.entryList(QDir::Filter::Files)) {
+    for (const QString &fileNameString : campaignOrMapPackDir.entryList(QDir::Filter::Files)) {
         QString fileNameStringLowerCase = fileNameString.toLower();
 
-        // Check if this is a mapXXXXX.dat file
-        // We first check for .dat to decrease the amount of checking
-        if (fileNameStringLowerCase.endsWith(".dat") == false || fileNameStringLowerCase.startsWith("map") == false) {
+        // Get the part before the extension
+        // Map files always end with a 5 digit map number: 'map00001.dat', 'map00001.lif', ...
+        QString baseNameString = fileNameStringLowerCase.section('.', 0, 0);
+        if (baseNameString.length() < 5 || baseNameString.length() == fileNameStringLowerCase.length()) {
             continue;
         }
 
         // Get mapnumber
-        QString mapNumberString = fileNameStringLowerCase.mid(3, 5);
-        int mapNumber = mapNumberString.toInt();
+        bool isNumber = false;
+        int mapNumber = baseNameString.right(5).toInt(&isNumber);
+        if (isNumber == false) {
+            continue;
+        }
+
+        // Check if this is a mapXXXXX.dat file
+        if (fileNameStringLowerCase.endsWith(".dat") && fileNameStringLowerCase.startsWith("map")) {
+            datMapNumbers.insert(mapNumber);
+            continue;
+        }
 
-        // Try to load this map
-        Map *map = new Map(type, campaignOrMapPackName, mapNumber);
+        // Remember the file for this map number
+        Map::addMapFile(mapFilesMap[mapNumber], campaignOrMapPackDirString + "/" + fileNameString);
+    }
+
+    // Load the maps in parallel
+    // Only the headers of the map files are read so this is mostly bound by file opening
+    QList<QFuture<Map *>> futures;
+    QList<int> sortedMapNumbers(datMapNumbers.begin(), datMapNumbers.end());
+    std::sort(sortedMapNumbers.begin(), sortedMapNumbers.end());
+    for (int mapNumber : std::as_const(sortedMapNumbers)) {
+        Map::MapFiles mapFiles = mapFilesMap.value(mapNumber);
+        futures << QtConcurrent::run([type, campaignOrMapPackName, mapNumber, mapFiles]() {
+            return new Map(type, campaignOrMapPackName, mapNumber, mapFiles);
+        });
+    }
+
+    // Collect the loaded maps in map number order
+    QList<Map *> scannedMaps;
+    for (QFuture<Map *> &future : futures) {
+        Map *map = future.result();
         if (map->isValid() == false) {
-            qWarning() << "Map could not be loaded:" << campaignOrMapPackName << "->" << mapNumber;
+            qCWarning(logGame) << "Map could not be loaded:" << campaignOrMapPackName << "->" << map->getMapNumber();
+            delete map;
             continue;
         }
 
         // Add map to list
-        list << map;
-        qDebug() << "Map loaded:" << map->toString();
+        scannedMaps << map;
+        qCDebug(logGame) << "Map loaded:" << map->toString();
+    }
+
+    // Remember the scanned maps and return copies of them
+    {
+        QMutexLocker locker(&Map::catalogCacheMutex);
+        qDeleteAll(Map::catalogCache.value(campaignOrMapPackDirString).maps);
+        Map::catalogCache.insert(campaignOrMapPackDirString, {lastModified, scannedMaps});
+        for (const Map *map : std::as_const(scannedMaps)) {
+            list << new Map(*map);
+        }
     }
 
     return list;
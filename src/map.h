@@ -1,6 +1,9 @@
 #pragma once
 
+#include <QDateTime>
 #include <QFile>
+#include <QHash>
+#include <QMutex>
 #include <QString>
 
 class Map
@@ -25,6 +28,23 @@ public:
     QString toString();
 
 private:
+    // Files in a campaign/levels dir that belong to a single map number
+    struct MapFiles
+    {
+        QString lofFilePath;
+        QString lifFilePath;
+        QString txtFilePath;
+    };
+
+    // Scanned maps of a single campaign/levels dir
+    struct CatalogCacheEntry
+    {
+        QDateTime lastModified;
+        QList<Map *> maps;
+    };
+
+    Map(const Map::Type type, const QString campaignOrMapPackName, const int mapNumber, const Map::MapFiles &mapFiles);
+
     Map::Type type;
     QString campaignOrMapPackName;
     int mapNumber;
@@ -33,6 +53,13 @@ private:
     Map::Format format;
     QString mapName;
 
+    static QHash<QString, CatalogCacheEntry> catalogCache;
+    static QMutex catalogCacheMutex;
+
+    static QString getMapDirString(const Map::Type type, const QString campaignOrMapPackName);
+    static void addMapFile(Map::MapFiles &mapFiles, const QString &filePath);
+
+    void loadFiles(const Map::MapFiles &mapFiles);
     void loadLif(QFile &file);
     void loadLof(QFile &file);
     void loadTxtWorkaround(QFile &file);
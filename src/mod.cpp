@@ -1,9 +1,10 @@
 #include "mod.h"
+#include "logcategories.h"
 
+#include "inireader.h"
 #include "kfxversion.h"
 
 #include <QCoreApplication>
-#include <QSettings>
 
 Mod::Mod(const QDir directory)
 {
@@ -12,36 +13,42 @@ Mod::Mod(const QDir directory)
 
     // Check if the dir exists
     if (directory.exists() == false) {
-        qWarning() << "Invalid mod directory:" << directory.absolutePath();
+        qCWarning(logGame) << "Invalid mod directory:" << directory.absolutePath();
         return;
     }
 
     // Check if the dir is readable
     if (directory.isReadable() == false) {
-        qWarning() << "Mod directory not readable:" << directory.absolutePath();
+        qCWarning(logGame) << "Mod directory not readable:" << directory.absolutePath();
         return;
     }
 
     // Get mod metadata file
     QFile modMetadataFile(directory.absoluteFilePath("mod.cfg"));
     if (modMetadataFile.exists() == false) {
-        qWarning() << "Mod directory does not have 'mod.cfg' metadata file:" << directory.absolutePath();
+        qCWarning(logGame) << "Mod directory does not have 'mod.cfg' metadata file:" << directory.absolutePath();
         return;
     }
 
     // Load metadata file
-    QSettings *modMetadata = new QSettings(modMetadataFile.fileName(), QSettings::IniFormat);
-    if (modMetadata->status() != QSettings::NoError) {
-        qWarning() << "Failed to load mod metadata file. Invalid ini format:" << modMetadataFile.fileName();
-        return;
-    }
+    // Only the keys we use are read and reading stops once all of them are found
+    QHash<QString, QString> modMetadata = IniReader::readValues(modMetadataFile.fileName(), {
+        "mod/Name",
+        "mod/Author",
+        "mod/Description",
+        "mod/Version",
+        "mod/MinimumGameVersion",
+        "mod/Thumbnail",
+        "web/KfxNetAuthorUsername",
+        "web/KfxNetWorkshopItemId",
+    });
 
     // Load info [mod]
-    this->name = modMetadata->value("mod/Name").toString();
-    this->author = modMetadata->value("mod/Author").toString();
-    this->description = modMetadata->value("mod/Description").toString();
-    this->version = modMetadata->value("mod/Version").toString();
-    this->minimumGameVersion = modMetadata->value("mod/MinimumGameVersion").toString();
+    this->name = modMetadata.value("mod/Name");
+    this->author = modMetadata.value("mod/Author");
+    this->description = modMetadata.value("mod/Description");
+    this->version = modMetadata.value("mod/Version");
+    this->minimumGameVersion = modMetadata.value("mod/MinimumGameVersion");
 
     // Load translated info [mod]
     // TODO
@@ -53,8 +60,9 @@ Mod::Mod(const QDir directory)
     QDate createdDate;
     QDate lastUpdatedDate;
 
-    // Load thumbnail [mod]
-    this->thumbnailFilename = modMetadata->value("mod/Thumbnail").toString();
+    // Load thumbnail path [mod]
+    // The image itself is only decoded when a widget needs it
+    this->thumbnailFilename = modMetadata.value("mod/Thumbnail");
     if (this->thumbnailFilename.isEmpty() == false) {
         // Get thumbnail filepath
         QString thumbnailFilepath = this->directory.absoluteFilePath(this->thumbnailFilename);
@@ -62,19 +70,15 @@ Mod::Mod(const QDir directory)
         // Get thumbnail file
         QFile thumbnailFile(thumbnailFilepath);
         if (thumbnailFile.exists()) {
-            if (this->thumbnailPixmap.load(thumbnailFilepath) != true) {
-                qWarning() << "Failed to load mod thumbnail:" << thumbnailFilepath;
-            }
+            this->thumbnailFilePath = thumbnailFilepath;
         } else {
-            qWarning() << "Mod thumbnail does not exist:" << thumbnailFilepath;
+            qCWarning(logGame) << "Mod thumbnail does not exist:" << thumbnailFilepath;
         }
     }
 
     // Load website information [webinfo]
-    this->kfxNetAuthorUsername = modMetadata->value("web/KfxNetAuthorUsername").toString();
-    this->kfxNetWorkshopItemId = modMetadata->value("web/KfxNetWorkshopItemId").toString();
-
-    //qDebug() << "Translation test:" << modMetadata->value("mod/Name[DUT]").toString();
+    this->kfxNetAuthorUsername = modMetadata.value("web/KfxNetAuthorUsername");
+    this->kfxNetWorkshopItemId = modMetadata.value("web/KfxNetWorkshopItemId");
 
     this->valid = true;
 }
@@ -1,7 +1,7 @@
 #pragma once
 
+#include <QDate>
 #include <QDir>
-#include <QPixmap>
 #include <QString>
 
 class Mod
@@ -31,7 +31,7 @@ public:
 
     // Thumbnail
     QString thumbnailFilename;
-    QPixmap thumbnailPixmap;
+    QString thumbnailFilePath;
 
     // Dates
     QDate createdDate;
@@ -1,42 +1,51 @@
 #include "modmanager.h"
 #include "mod.h"
+#include "logcategories.h"
 
 #include <QCoreApplication>
 #include <QDir>
-#include <QSettings>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QFuture>
+#include <QMutexLocker>
+#include <QSet>
+#include <QTextStream>
+#include <QtConcurrent/QtConcurrentRun>
+
+QHash<QString, ModManager::RegistryEntry> ModManager::registry;
+QHash<QString, ModManager::FileListCacheEntry> ModManager::fileListCache;
+QMutex ModManager::fileListCacheMutex;
 
 ModManager::ModManager()
 {
-    qDebug() << "Initializing ModManager";
+    qCDebug(logGame) << "Initializing ModManager";
 
     // Check if the save file dir exists
     QDir modsDir(QCoreApplication::applicationDirPath() + "/mods");
     if (modsDir.exists() == false || modsDir.isReadable() == false) {
-        qWarning() << "Mods directory does not exist or is not readable:" << modsDir.filesystemAbsolutePath();
+        qCWarning(logGame) << "Mods directory does not exist or is not readable:" << modsDir.filesystemAbsolutePath();
         return;
     }
 
     // Get mod folders
-    QStringList modFolders = modsDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
-    if (modFolders.isEmpty()) {
-        qInfo() << "No mods found";
-        return;
-    }
-
-    // Loop trough all folders
-    for (const QString &modFolderName : std::as_const(modFolders)) {
+    QStringList modFolders;
+    for (const QString &modFolderName : modsDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
         // Ignore directories that start with a dot
         // Linux (POSIX) filesystems use this naming scheme for hidden folders
         // Note: dot and dotdot dirs are already filtered before this check
-        if (modFolderName.startsWith(".")) {
-            continue;
+        if (modFolderName.startsWith(".") == false) {
+            modFolders << modFolderName;
         }
+    }
 
-        // Try to load this mod
-        Mod *mod = new Mod(modsDir.absoluteFilePath(modFolderName));
+    // Update the mod registry
+    // Only mods that are new or have changed are loaded
+    ModManager::refreshRegistry(modsDir, modFolders);
 
-        // Put mod into mod list
-        if(mod->isValid()){
+    // Put valid mods into the mod list
+    for (const QString &modFolderName : std::as_const(modFolders)) {
+        QSharedPointer<Mod> mod = ModManager::registry.value(modFolderName).mod;
+        if (mod && mod->isValid()) {
             this->mods.append(mod);
         }
     }
@@ -44,32 +53,117 @@ ModManager::ModManager()
     // Check if mods have been found
     int count = this->mods.count();
     if (count == 0) {
-        qInfo() << "0 mods found";
+        qCInfo(logGame) << "0 mods found";
     } else {
         // Log the mods to the console
-        qInfo().noquote() << QString("%1 mods found:").arg(count);
-        for (const Mod *mod : std::as_const(this->mods)) {
-            qInfo().noquote() << QString("- %1").arg(mod->toString());
+        qCInfo(logGame).noquote() << QString("%1 mods found:").arg(count);
+        for (const QSharedPointer<Mod> &mod : std::as_const(this->mods)) {
+            qCInfo(logGame).noquote() << QString("- %1").arg(mod->toString());
+        }
+    }
+
+    // Resolve the load order
+    loadLoadOrder();
+}
+
+QDateTime ModManager::getModLastModified(const QDir &modDir)
+{
+    // The folder changes when files are added or removed
+    // The metadata file changes when it is edited in place
+    QDateTime folderLastModified = QFileInfo(modDir.absolutePath()).lastModified();
+    QDateTime metadataLastModified = QFileInfo(modDir.absoluteFilePath("mod.cfg")).lastModified();
+
+    return qMax(folderLastModified, metadataLastModified);
+}
+
+void ModManager::refreshRegistry(const QDir &modsDir, const QStringList &modFolders)
+{
+    int loadedCount = 0;
+
+    // Load new and changed mods
+    for (const QString &modFolderName : modFolders) {
+        QDir modDir(modsDir.absoluteFilePath(modFolderName));
+        QDateTime lastModified = ModManager::getModLastModified(modDir);
+
+        // Check if we already have this version of the mod
+        auto it = ModManager::registry.find(modFolderName);
+        if (it != ModManager::registry.end()) {
+            if (it->lastModified == lastModified) {
+                continue;
+            }
+            // Mod managers and widgets that still use the old version keep it alive
+            ModManager::registry.erase(it);
+        }
+
+        // Try to load this mod
+        ModManager::registry.insert(modFolderName, {lastModified, QSharedPointer<Mod>::create(modDir)});
+        loadedCount++;
+    }
+
+    // Remove mods that do not exist anymore
+    QSet<QString> modFolderSet(modFolders.begin(), modFolders.end());
+    for (auto it = ModManager::registry.begin(); it != ModManager::registry.end();) {
+        if (modFolderSet.contains(it.key()) == false) {
+            it = ModManager::registry.erase(it);
+        } else {
+            ++it;
         }
     }
 
+    // Forget the file lists of removed mods
+    {
+        QMutexLocker locker(&ModManager::fileListCacheMutex);
+        for (auto it = ModManager::fileListCache.begin(); it != ModManager::fileListCache.end();) {
+            if (modFolderSet.contains(it.key()) == false) {
+                it = ModManager::fileListCache.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    qCDebug(logGame) << "Mod registry refreshed:" << loadedCount << "mod(s) (re)loaded," << ModManager::registry.size() << "total";
+}
+
+QSharedPointer<Mod> ModManager::findRegisteredMod(const QString &modFolderName)
+{
+    auto it = ModManager::registry.constFind(modFolderName);
+    if (it != ModManager::registry.constEnd()) {
+        return it->mod;
+    }
+
+#ifdef Q_OS_WINDOWS
+    // Folder names are case insensitive on Windows
+    // So the load order can use another case than the mod folder
+    for (it = ModManager::registry.constBegin(); it != ModManager::registry.constEnd(); ++it) {
+        if (it.key().compare(modFolderName, Qt::CaseInsensitive) == 0) {
+            return it->mod;
+        }
+    }
+#endif
+
+    return nullptr;
+}
+
+void ModManager::loadLoadOrder()
+{
     // Open the load order file
     // This also opens a handle even if the file does not exist to create it instead
     QFile loadOrderFile(QCoreApplication::applicationDirPath() + QDir::separator() + "mods" + QDir::separator() + "load_order.cfg");
     if (!loadOrderFile.open(QIODevice::ReadWrite | QIODevice::Text)) {
-        qWarning() << "Failed to open mod load order file:" << loadOrderFile.errorString();
+        qCWarning(logGame) << "Failed to open mod load order file:" << loadOrderFile.errorString();
         return;
     }
 
     // The section map to place the mods in their correct list
-    QHash<QString, QList<Mod*>*> sectionMap {
+    QHash<QString, QList<QSharedPointer<Mod>>*> sectionMap {
         { "after_base", &this->modsAfterBase },
         { "after_campaign", &this->modsAfterCampaign },
         { "after_map", &this->modsAfterMap }
     };
 
     // The list to populate
-    QList<Mod*>* sectionList;
+    QList<QSharedPointer<Mod>>* sectionList = nullptr;
 
     // Loop trough the file
     QTextStream in(&loadOrderFile);
@@ -89,10 +183,10 @@ ModManager::ModManager()
             sectionList = sectionMap.value(section, nullptr);
 
             if(!sectionList){
-                qWarning() << "Invalid mod load order section:" << section;
+                qCWarning(logGame) << "Invalid mod load order section:" << section;
                 continue;
             } else {
-                qInfo() << "Mod load order:" << section;
+                qCInfo(logGame) << "Mod load order:" << section;
             }
 
             continue;
@@ -103,46 +197,171 @@ ModManager::ModManager()
             continue;
         }
 
-        // Try to load this mod
-        Mod *mod = new Mod(modsDir.absoluteFilePath(line));
-        if(mod->isValid()){
+        // Get the mod from the registry
+        QSharedPointer<Mod> mod = ModManager::findRegisteredMod(line);
+        if(mod && mod->isValid()){
 
             // Add mod to correct section list
             // It's important that it's appended at the end and that the section lists are split
             sectionList->append(mod);
-            qInfo() << "   -" << mod->name;
+            qCInfo(logGame) << "   -" << mod->name;
+        } else {
+            qCWarning(logGame) << "Mod in load order not found:" << line;
         }
     }
-    /*
-    const QStringList sections = settings.childGroups();
-    for (const QString& section : sections) {
+}
 
-        QList<Mod*>* sectionList = sectionMap.value(section, nullptr);
-        if(!sectionList){
-            qWarning() << "Invalid mod load order section:" << section;
+QList<QSharedPointer<Mod>> ModManager::getLoadOrder()
+{
+    return this->modsAfterBase + this->modsAfterCampaign + this->modsAfterMap;
+}
+
+QHash<QString, QDateTime> ModManager::getModDirectoryTimes(const QDir &modDir)
+{
+    QHash<QString, QDateTime> directoryTimes;
+
+    // Adding, removing or renaming a file only changes the folder it is in
+    // So we need the modification time of every folder of the mod
+    directoryTimes.insert(".", QFileInfo(modDir.absolutePath()).lastModified());
+
+    QDirIterator it(modDir.absolutePath(), QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        directoryTimes.insert(modDir.relativeFilePath(it.filePath()), it.fileInfo().lastModified());
+    }
+
+    return directoryTimes;
+}
+
+ModManager::FileListCacheEntry ModManager::getModFileList(const QDir &modDir, const FileListCacheEntry &cachedEntry)
+{
+    FileListCacheEntry entry;
+
+    // Walking the folders is a lot cheaper than listing all files
+    // The cached list is still valid when none of the folders changed
+    entry.directoryTimes = ModManager::getModDirectoryTimes(modDir);
+    if (cachedEntry.directoryTimes.isEmpty() == false && entry.directoryTimes == cachedEntry.directoryTimes) {
+        return cachedEntry;
+    }
+
+    // Loop trough all files of the mod
+    QDirIterator it(modDir.absolutePath(), QDir::Files | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        QString relativeFilePath = modDir.relativeFilePath(it.next());
+
+        // Skip the mod metadata file because every mod has one
+        if (relativeFilePath.compare("mod.cfg", Qt::CaseInsensitive) == 0) {
             continue;
-        } else {
-            qInfo() << "Mod load order:" << section;
         }
 
-        // Open this settings section
-        settings.beginGroup(section);
+        // Game files are case insensitive
+        entry.relativeFilePaths << relativeFilePath.toLower();
+    }
+
+    return entry;
+}
+
+QHash<QString, QList<QSharedPointer<Mod>>> ModManager::getFileOverrideIndex()
+{
+    // Only build the index once for this load order
+    if (this->isFileOverrideIndexBuilt) {
+        return this->fileOverrideIndex;
+    }
+    this->isFileOverrideIndexBuilt = true;
 
-        // Loop trough all defined mods
-        for (const QString& modName : settings.childKeys()) {
+    QList<QSharedPointer<Mod>> loadOrder = this->getLoadOrder();
 
-            // Try to load this mod
-            Mod *mod = new Mod(modsDir.absoluteFilePath(modName));
+    // Check and list the files of the mods in parallel
+    // Mods of which no folder changed keep their cached file list
+    QHash<QString, QFuture<FileListCacheEntry>> futures;
+    for (const QSharedPointer<Mod> &mod : std::as_const(loadOrder)) {
+        if (futures.contains(mod->identifier)) {
+            continue;
+        }
 
-            if(mod->isValid()){
-                sectionList->append(mod);
-                qInfo() << "   -" << modName;
-            } else {
-                qWarning() << "Mod does not have a folder:" << modName;
+        QDir modDir = mod->directory;
+        FileListCacheEntry cachedEntry;
+        {
+            QMutexLocker locker(&ModManager::fileListCacheMutex);
+            cachedEntry = ModManager::fileListCache.value(mod->identifier);
+        }
+        futures.insert(mod->identifier, QtConcurrent::run([modDir, cachedEntry]() { return ModManager::getModFileList(modDir, cachedEntry); }));
+    }
+
+    // Store the file lists
+    int listedCount = 0;
+    QHash<QString, FileListCacheEntry> fileLists;
+    for (auto it = futures.begin(); it != futures.end(); ++it) {
+        fileLists.insert(it.key(), it.value().result());
+    }
+    {
+        QMutexLocker locker(&ModManager::fileListCacheMutex);
+        for (auto it = fileLists.constBegin(); it != fileLists.constEnd(); ++it) {
+            auto cachedIt = ModManager::fileListCache.constFind(it.key());
+            if (cachedIt == ModManager::fileListCache.constEnd() || cachedIt->directoryTimes != it->directoryTimes) {
+                listedCount++;
+            }
+            ModManager::fileListCache.insert(it.key(), it.value());
+        }
+    }
+
+    // Create the index in load order
+    for (const QSharedPointer<Mod> &mod : std::as_const(loadOrder)) {
+        const QStringList relativeFilePaths = fileLists.value(mod->identifier).relativeFilePaths;
+        for (const QString &relativeFilePath : relativeFilePaths) {
+            QList<QSharedPointer<Mod>> &providingMods = this->fileOverrideIndex[relativeFilePath];
+            if (providingMods.contains(mod) == false) {
+                providingMods.append(mod);
             }
         }
+    }
+
+    qCDebug(logGame) << "Mod file override index built:" << this->fileOverrideIndex.size() << "file(s)," << listedCount << "mod(s) listed";
+
+    return this->fileOverrideIndex;
+}
+
+QHash<QSharedPointer<Mod>, ModManager::FileOverrides> ModManager::getFileOverrides()
+{
+    const QHash<QString, QList<QSharedPointer<Mod>>> index = this->getFileOverrideIndex();
+
+    // Invert the index in a single pass over all files
+    QHash<QSharedPointer<Mod>, QSet<QSharedPointer<Mod>>> overriddenSets;
+    QHash<QSharedPointer<Mod>, QSet<QSharedPointer<Mod>>> overriddenBySets;
+    QHash<QSharedPointer<Mod>, FileOverrides> fileOverrides;
+    for (const QList<QSharedPointer<Mod>> &providingMods : index) {
+        if (providingMods.size() < 2) {
+            continue;
+        }
+
+        // Mods later in the load order win
+        for (qsizetype i = 0; i < providingMods.size(); i++) {
+            const QSharedPointer<Mod> &mod = providingMods.at(i);
+            fileOverrides[mod].conflictingFileCount++;
+            for (qsizetype j = 0; j < providingMods.size(); j++) {
+                if (j < i) {
+                    overriddenSets[mod].insert(providingMods.at(j));
+                } else if (j > i) {
+                    overriddenBySets[mod].insert(providingMods.at(j));
+                }
+            }
+        }
+    }
+
+    // Put the mods in load order
+    const QList<QSharedPointer<Mod>> loadOrder = this->getLoadOrder();
+    for (auto it = fileOverrides.begin(); it != fileOverrides.end(); ++it) {
+        const QSet<QSharedPointer<Mod>> overriddenSet = overriddenSets.value(it.key());
+        const QSet<QSharedPointer<Mod>> overriddenBySet = overriddenBySets.value(it.key());
+        for (const QSharedPointer<Mod> &mod : loadOrder) {
+            if (overriddenSet.contains(mod) && it->overriddenMods.contains(mod) == false) {
+                it->overriddenMods << mod;
+            }
+            if (overriddenBySet.contains(mod) && it->overriddenByMods.contains(mod) == false) {
+                it->overriddenByMods << mod;
+            }
+        }
+    }
 
-        // Close this settings section
-        settings.endGroup();
-    }*/
+    return fileOverrides;
 }
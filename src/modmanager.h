@@ -4,7 +4,11 @@
 #include "mod.h"
 
 #include <QCoreApplication>
+#include <QDateTime>
 #include <QDir>
+#include <QHash>
+#include <QMutex>
+#include <QSharedPointer>
 
 class ModManager
 {
@@ -23,13 +27,66 @@ public:
         return ModManager::isModsFolderAvailable();
     }
 
-    QList<Mod *> modsAfterBase;
-    QList<Mod *> modsAfterCampaign;
-    QList<Mod *> modsAfterMap;
+    QList<QSharedPointer<Mod>> modsAfterBase;
+    QList<QSharedPointer<Mod>> modsAfterCampaign;
+    QList<QSharedPointer<Mod>> modsAfterMap;
+
+    QList<QSharedPointer<Mod>> getLoadOrder();
+
+    // Relative file path -> mods that provide this file in load order
+    // The last mod in the list overrides the others
+    QHash<QString, QList<QSharedPointer<Mod>>> getFileOverrideIndex();
+
+    // The mods whose files a mod overrides and the mods that override its files
+    struct FileOverrides
+    {
+        QList<QSharedPointer<Mod>> overriddenMods;
+        QList<QSharedPointer<Mod>> overriddenByMods;
+        int conflictingFileCount = 0;
+    };
+
+    // Mod -> its file overrides, mods in load order
+    // Mods that do not share files with other mods are not in here
+    QHash<QSharedPointer<Mod>, FileOverrides> getFileOverrides();
 
 private:
 
-    QList<Mod *> mods;
+    QList<QSharedPointer<Mod>> mods;
+
+    // A mod in the registry and the modification time it was loaded with
+    struct RegistryEntry
+    {
+        QDateTime lastModified;
+        QSharedPointer<Mod> mod;
+    };
+
+    // All loaded mods by identifier
+    // Every mod is only loaded once and shared with the mod managers and widgets using it
+    // A mod that is reloaded or removed stays alive until nothing uses it anymore
+    static QHash<QString, RegistryEntry> registry;
+
+    // The files of a mod and the modification times of its folders when they were listed
+    struct FileListCacheEntry
+    {
+        QHash<QString, QDateTime> directoryTimes;
+        QStringList relativeFilePaths;
+    };
+
+    // Cached file lists by mod identifier
+    // The file overrides can be searched in a worker thread so the cache has its own mutex
+    static QHash<QString, FileListCacheEntry> fileListCache;
+    static QMutex fileListCacheMutex;
+
+    QHash<QString, QList<QSharedPointer<Mod>>> fileOverrideIndex;
+    bool isFileOverrideIndexBuilt = false;
+
+    static QDateTime getModLastModified(const QDir &modDir);
+    static QHash<QString, QDateTime> getModDirectoryTimes(const QDir &modDir);
+    static FileListCacheEntry getModFileList(const QDir &modDir, const FileListCacheEntry &cachedEntry);
+    static void refreshRegistry(const QDir &modsDir, const QStringList &modFolders);
+    static QSharedPointer<Mod> findRegisteredMod(const QString &modFolderName);
+
+    void loadLoadOrder();
 
     static bool isModsFolderAvailable()
     {
@@ -1,8 +1,13 @@
 #include "modmanagerdialog.h"
 #include "modmanager.h"
 #include "modwidget.h"
+#include "taskscheduler.h"
 #include "ui_modmanagerdialog.h"
 
+#include <QFutureWatcher>
+
+#include <memory>
+
 ModManagerDialog::ModManagerDialog(QWidget *parent)
     : QDialog(parent)
     , ui(new Ui::ModManagerDialog)
@@ -15,20 +20,49 @@ ModManagerDialog::ModManagerDialog(QWidget *parent)
     setWindowFlag(Qt::MSWindowsFixedSizeDialogHint);
 
     // Get mods
-    ModManager *manager = new ModManager();
-    QList<Mod *> mods = manager->modsAfterBase;
+    // The widgets share the mods so they stay valid when the registry reloads them
+    std::shared_ptr<ModManager> manager = std::make_shared<ModManager>();
+    QList<QSharedPointer<Mod>> mods = manager->modsAfterBase;
 
     // Add the mods
-    if (mods.isEmpty() == false) {
-        for (auto mod : std::as_const(mods)) {
-            // Create the widget
-            ModWidget *modWidget = new ModWidget(mod, this);
+    QHash<QSharedPointer<Mod>, ModWidget *> modWidgets;
+    for (auto mod : std::as_const(mods)) {
+        ModWidget *modWidget = new ModWidget(mod, this);
+        modWidgets.insert(mod, modWidget);
+        ui->scrollAreaWidgetContents->layout()->addWidget(modWidget);
+    }
 
-            //mod->
+    if (mods.isEmpty()) {
+        return;
+    }
 
-            ui->scrollAreaWidgetContents->layout()->addWidget(modWidget);
+    // Get the mods that share files with other mods
+    // This walks the files of all mods so it is done in the background
+    using FileOverridesMap = QHash<QSharedPointer<Mod>, ModManager::FileOverrides>;
+    QFutureWatcher<FileOverridesMap> *watcher = new QFutureWatcher<FileOverridesMap>(this);
+    connect(watcher, &QFutureWatcher<FileOverridesMap>::finished, this, [watcher, modWidgets]() {
+        const FileOverridesMap fileOverrides = watcher->result();
+        watcher->deleteLater();
+
+        // Show the mods each mod overrides and the mods overriding it
+        for (auto overridesIt = fileOverrides.constBegin(); overridesIt != fileOverrides.constEnd(); ++overridesIt) {
+            ModWidget *modWidget = modWidgets.value(overridesIt.key());
+            if (modWidget == nullptr) {
+                continue;
+            }
+
+            QStringList overriddenMods;
+            for (const QSharedPointer<Mod> &overriddenMod : overridesIt->overriddenMods) {
+                overriddenMods << overriddenMod->toString();
+            }
+            QStringList overriddenByMods;
+            for (const QSharedPointer<Mod> &overriddenByMod : overridesIt->overriddenByMods) {
+                overriddenByMods << overriddenByMod->toString();
+            }
+            modWidget->setFileOverrides(overriddenMods, overriddenByMods, overridesIt->conflictingFileCount);
         }
-    }
+    });
+    watcher->setFuture(TaskScheduler::run(TaskScheduler::Pool::IO, [manager]() { return manager->getFileOverrides(); }));
 }
 
 ModManagerDialog::~ModManagerDialog()
@@ -1,9 +1,13 @@
 #include "modwidget.h"
 #include "ui_modwidget.h"
 
-#include <QPainter>
+#include "imagehelper.h"
+#include "taskscheduler.h"
 
-ModWidget::ModWidget(Mod *mod, QWidget *parent)
+#include <QFutureWatcher>
+#include <QLabel>
+
+ModWidget::ModWidget(QSharedPointer<Mod> mod, QWidget *parent)
     : QWidget(parent)
     , ui(new Ui::ModWidget)
 {
@@ -27,32 +31,81 @@ ModWidget::ModWidget(Mod *mod, QWidget *parent)
         ui->descriptionLabel->hide();
     }
 
-    // Thumbnail
-    if (mod->thumbnailPixmap.isNull() == false) {
-        // Get the size for the thumbnail
-        QSize thumbnailSize = ui->frame->frameSize();
+    // Remember the mod
+    // The thumbnail is loaded when the widget is painted for the first time
+    this->mod = mod;
+}
 
-        // Scale the source pixmap while keeping aspect ratio
-        QPixmap scaledPixmap = mod->thumbnailPixmap.scaled(thumbnailSize, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
+void ModWidget::paintEvent(QPaintEvent *event)
+{
+    QWidget::paintEvent(event);
+
+    // Only mods that are actually visible load their thumbnail
+    if (this->isThumbnailRequested == false) {
+        this->isThumbnailRequested = true;
+        loadThumbnail();
+    }
+}
+
+void ModWidget::loadThumbnail()
+{
+    // Make sure the mod has a thumbnail
+    if (mod->thumbnailFilePath.isEmpty()) {
+        return;
+    }
 
-        // Create final pixmap with transparent (or solid) background
-        QPixmap finalPixmap(thumbnailSize);
-        finalPixmap.fill(Qt::transparent);
+    // Get the size for the thumbnail
+    QSize thumbnailSize = ui->frame->frameSize();
+    QString thumbnailFilePath = mod->thumbnailFilePath;
 
-        // Paint scaled image centered into finalPixmap
-        QPainter painter(&finalPixmap);
-        int x = (thumbnailSize.width() - scaledPixmap.width()) / 2;
-        int y = (thumbnailSize.height() - scaledPixmap.height()) / 2;
-        painter.drawPixmap(x, y, scaledPixmap);
-        painter.end();
+    // Decode the thumbnail at widget size in a worker thread
+    // The watcher is owned by this widget so the result is dropped if the widget is gone
+    QFutureWatcher<QImage> *watcher = new QFutureWatcher<QImage>(this);
+    connect(watcher, &QFutureWatcher<QImage>::finished, this, [this, watcher, thumbnailFilePath, thumbnailSize]() {
+        QImage thumbnailImage = watcher->result();
+        watcher->deleteLater();
+
+        if (thumbnailImage.isNull()) {
+            qWarning() << "Failed to load mod thumbnail:" << thumbnailFilePath;
+            return;
+        }
 
         // Create label and set final pixmap
         QLabel *imageLabel = new QLabel(ui->frame);
-        imageLabel->setPixmap(finalPixmap);
+        imageLabel->setPixmap(QPixmap::fromImage(thumbnailImage));
         imageLabel->setAlignment(Qt::AlignCenter);
         imageLabel->setScaledContents(false); // prevent distorting
         imageLabel->setFixedSize(thumbnailSize);
+        imageLabel->show();
+    });
+    watcher->setFuture(TaskScheduler::run(TaskScheduler::Pool::IO, [thumbnailFilePath, thumbnailSize]() {
+        return ImageHelper::getLocalScaledImage(thumbnailFilePath, thumbnailSize);
+    }));
+}
+
+void ModWidget::setFileOverrides(const QStringList &overriddenMods, const QStringList &overriddenByMods, int conflictingFileCount)
+{
+    // Nothing to show if this mod does not share files with other mods
+    if (conflictingFileCount == 0) {
+        return;
     }
+
+    QStringList lines;
+    lines << tr("%1 file(s) also provided by other mods").arg(conflictingFileCount);
+    if (overriddenMods.isEmpty() == false) {
+        lines << tr("Overrides: %1").arg(overriddenMods.join(", "));
+    }
+    if (overriddenByMods.isEmpty() == false) {
+        lines << tr("Overridden by: %1").arg(overriddenByMods.join(", "));
+    }
+
+    // Add the conflict label below the description
+    QLabel *conflictLabel = new QLabel(lines.join("\n"), ui->widget);
+    conflictLabel->setWordWrap(true);
+    // Use the colors of the palette so the label fits the theme
+    // Mods that lose files stand out more than mods that only override files
+    conflictLabel->setForegroundRole(overriddenByMods.isEmpty() ? QPalette::PlaceholderText : QPalette::Link);
+    ui->widget->layout()->addWidget(conflictLabel);
 }
 
 ModWidget::~ModWidget()
@@ -2,6 +2,7 @@
 
 #include "mod.h"
 
+#include <QSharedPointer>
 #include <QWidget>
 
 namespace Ui { class ModWidget; }
@@ -11,11 +12,19 @@ class ModWidget : public QWidget
     Q_OBJECT
 
 public:
-    explicit ModWidget(Mod *mod, QWidget *parent = nullptr);
+    explicit ModWidget(QSharedPointer<Mod> mod, QWidget *parent = nullptr);
     ~ModWidget();
 
+    void setFileOverrides(const QStringList &overriddenMods, const QStringList &overriddenByMods, int conflictingFileCount);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
 private:
     Ui::ModWidget *ui;
 
-    Mod *mod;
+    QSharedPointer<Mod> mod;
+
+    bool isThumbnailRequested = false;
+    void loadThumbnail();
 };
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayView>
+
+#include <cstring>
+
+// Fixed size byte buffer that only keeps the most recent data
+class RingBuffer
+{
+public:
+    explicit RingBuffer(qsizetype capacity)
+        : buffer(capacity, '\0')
+    {}
+
+    void append(QByteArrayView data)
+    {
+        const qsizetype capacity = buffer.size();
+        if (capacity == 0 || data.isEmpty()) {
+            return;
+        }
+
+        // Only the end of the data fits when it is bigger than the buffer
+        if (data.size() >= capacity) {
+            std::memcpy(buffer.data(), data.data() + data.size() - capacity, capacity);
+            writePos = 0;
+            length = capacity;
+            return;
+        }
+
+        // Copy in at most two parts when wrapping around
+        qsizetype firstPart = qMin(data.size(), capacity - writePos);
+        std::memcpy(buffer.data() + writePos, data.data(), firstPart);
+        std::memcpy(buffer.data(), data.data() + firstPart, data.size() - firstPart);
+
+        writePos = (writePos + data.size()) % capacity;
+        length = qMin(capacity, length + data.size());
+    }
+
+    // Returns the buffered data from old to new
+    QByteArray toByteArray() const
+    {
+        if (length < buffer.size()) {
+            return buffer.first(length);
+        }
+
+        return buffer.sliced(writePos) + buffer.first(writePos);
+    }
+
+    void clear()
+    {
+        writePos = 0;
+        length = 0;
+    }
+
+    qsizetype size() const { return length; }
+
+private:
+    QByteArray buffer;
+    qsizetype writePos = 0;
+    qsizetype length = 0;
+};
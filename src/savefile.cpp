@@ -1,4 +1,5 @@
 #include "savefile.h"
+#include "logcategories.h"
 
 #include "archiver.h"
 #include "kfxversion.h"
@@ -14,7 +15,7 @@ SaveFile::SaveFile(const QString &filePath)
 
     // Make sure the save can be loaded
     if (!file.exists() || !file.open(QIODevice::ReadOnly)) {
-        qWarning() << "Savefile can not be opened:" << filePath;
+        qCWarning(logGame) << "Savefile can not be opened:" << filePath;
         return;
     }
 
@@ -78,10 +79,10 @@ SaveFile::SaveFile(const QString &filePath)
             currentPos++;
         }
 
-        qDebug() << "Savefile object created:" << toString();
+        qCDebug(logGame) << "Savefile object created:" << toString();
 
     } catch (QException& ex) {
-        qWarning() << "Savefile exception: " << ex.what();
+        qCWarning(logGame) << "Savefile exception: " << ex.what();
     }
 
     // Make sure the file handle is closed again
@@ -145,7 +146,7 @@ bool SaveFile::backupAll(QList<SaveFile *> saveFiles)
 {
     // Check if there are savefiles to backup
     if (saveFiles.length() == 0) {
-        qDebug() << "No save files found to backup";
+        qCDebug(logGame) << "No save files found to backup";
         return true;
     }
 
@@ -167,12 +168,12 @@ bool SaveFile::backupAll(QList<SaveFile *> saveFiles)
     }
 
     // Debug
-    qDebug() << "Save backup archive path:" << archiveFilePath;
-    qDebug().noquote() << QString("Archiving %1 save(s)").arg(saveFiles.length()).toStdString();
+    qCDebug(logGame) << "Save backup archive path:" << archiveFilePath;
+    qCDebug(logGame).noquote() << QString("Archiving %1 save(s)").arg(saveFiles.length()).toStdString();
 
     // Archive all saves
     for (SaveFile *saveFile : saveFiles) {
-        qDebug() << "Archiving:" << saveFile->saveName;
+        qCDebug(logGame) << "Archiving:" << saveFile->saveName;
         if (Archiver::compressSingleFile(&saveFile->file, archiveFilePath.toStdString()) == false) {
             return false;
         }
@@ -1,6 +1,25 @@
 #include "enetlanscanner.h"
 #include "scannetworkdialog.h"
 #include "ui_scannetworkdialog.h"
+#include "logcategories.h"
+
+#include <limits>
+
+// Table item that sorts servers by their latency
+class LatencyTableWidgetItem : public QTableWidgetItem
+{
+public:
+    LatencyTableWidgetItem()
+        : QTableWidgetItem("-")
+    {
+        setData(Qt::UserRole, std::numeric_limits<double>::max());
+    }
+
+    bool operator<(const QTableWidgetItem &other) const override
+    {
+        return data(Qt::UserRole).toDouble() < other.data(Qt::UserRole).toDouble();
+    }
+};
 
 ScanNetworkDialog::ScanNetworkDialog(QWidget *parent)
     : QDialog(parent)
@@ -15,9 +34,9 @@ ScanNetworkDialog::ScanNetworkDialog(QWidget *parent)
     setWindowFlag(Qt::MSWindowsFixedSizeDialogHint);
 
     // Setup table
-    ui->tableWidget->setColumnCount(2);
+    ui->tableWidget->setColumnCount(3);
     QStringList headers;
-    headers << tr("IP Address", "Table Header") << tr("Hostname", "Table Header");
+    headers << tr("IP Address", "Table Header") << tr("Hostname", "Table Header") << tr("Latency", "Table Header");
     ui->tableWidget->setHorizontalHeaderLabels(headers);
     ui->tableWidget->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
     ui->tableWidget->verticalHeader()->setVisible(false);
@@ -28,6 +47,12 @@ ScanNetworkDialog::ScanNetworkDialog(QWidget *parent)
 
     // Connect scanner signals to slots
     connect(scanner, &EnetLanScanner::serverFound, this, &ScanNetworkDialog::handleServerFound);
+    connect(scanner, &EnetLanScanner::hostnameResolved, this, &ScanNetworkDialog::handleHostnameResolved);
+    connect(scanner, &EnetLanScanner::serverLatencyUpdated, this, &ScanNetworkDialog::handleServerLatencyUpdated);
+    connect(scanner, &EnetLanScanner::serverLost, this, &ScanNetworkDialog::handleServerLost);
+
+    // Keep browsing after scans if enabled
+    scanner->setBrowsing(ui->browseCheckBox->isChecked());
     connect(scanner, &EnetLanScanner::scanProgress, this, &ScanNetworkDialog::handleScanProgress);
     connect(scanner, &EnetLanScanner::scanComplete, this, &ScanNetworkDialog::handleScanComplete);
 
@@ -104,13 +129,63 @@ void ScanNetworkDialog::on_scanButton_clicked()
 
 void ScanNetworkDialog::handleServerFound(const QString &ip, const QString &hostname)
 {
-    qDebug() << "Server found:" << ip << "Hostname:" << hostname;
+    qCDebug(logNet) << "Server found:" << ip << "Hostname:" << hostname;
 
     // Add row to table
     int row = ui->tableWidget->rowCount();
     ui->tableWidget->insertRow(row);
     ui->tableWidget->setItem(row, 0, new QTableWidgetItem(ip));
     ui->tableWidget->setItem(row, 1, new QTableWidgetItem(hostname));
+    ui->tableWidget->setItem(row, 2, new LatencyTableWidgetItem());
+}
+
+int ScanNetworkDialog::findServerRow(const QString &ip)
+{
+    for (int row = 0; row < ui->tableWidget->rowCount(); row++) {
+        if (ui->tableWidget->item(row, 0)->text() == ip) {
+            return row;
+        }
+    }
+
+    return -1;
+}
+
+void ScanNetworkDialog::handleHostnameResolved(const QString &ip, const QString &hostname)
+{
+    // Fill in the hostname of the server
+    int row = findServerRow(ip);
+    if (row != -1) {
+        ui->tableWidget->item(row, 1)->setText(hostname);
+    }
+}
+
+void ScanNetworkDialog::handleServerLatencyUpdated(const QString &ip, double rttMs, double jitterMs)
+{
+    int row = findServerRow(ip);
+    if (row == -1) {
+        return;
+    }
+
+    // Show the latency
+    QTableWidgetItem *latencyItem = ui->tableWidget->item(row, 2);
+    latencyItem->setText(tr("%1 ms (± %2 ms)", "Table Cell Latency").arg(rttMs, 0, 'f', 1).arg(jitterMs, 0, 'f', 1));
+    latencyItem->setData(Qt::UserRole, rttMs);
+
+    // Show the fastest servers first
+    ui->tableWidget->sortItems(2, Qt::AscendingOrder);
+}
+
+void ScanNetworkDialog::handleServerLost(const QString &ip)
+{
+    int row = findServerRow(ip);
+    if (row != -1) {
+        ui->tableWidget->removeRow(row);
+    }
+}
+
+void ScanNetworkDialog::on_browseCheckBox_toggled(bool checked)
+{
+    scanner->setBrowsing(checked);
 }
 
 void ScanNetworkDialog::handleScanProgress(int scanned, int total)
@@ -132,7 +207,7 @@ void ScanNetworkDialog::handleScanProgress(int scanned, int total)
 
 void ScanNetworkDialog::handleScanComplete()
 {
-    qDebug() << "ENET lobby Scan complete";
+    qCDebug(logNet) << "ENET lobby Scan complete";
 
     // Change Stop button into scan button again
     ui->scanButton->setText(tr("Scan", "Button text"));
@@ -142,6 +217,11 @@ void ScanNetworkDialog::handleScanComplete()
     ui->progressBar->setMaximum(1);
     ui->progressBar->setFormat("");
 
+    // Show that we keep checking the servers
+    if (ui->browseCheckBox->isChecked()) {
+        ui->progressBar->setFormat(tr("Browsing...", "Progress bar"));
+    }
+
     // Remember that we are not scanning anymore
     isScanning = false;
 }
@@ -151,14 +231,14 @@ void ScanNetworkDialog::on_connectButton_clicked()
     // Get selected row
     QList<QTableWidgetItem *> selectedItems = ui->tableWidget->selectedItems();
     if (selectedItems.isEmpty()) {
-        qWarning() << "Unable to find row";
+        qCWarning(logNet) << "Unable to find row";
         return;
     }
 
     // Get IP from selected row
     int row = selectedItems.first()->row();  // Get the row index
     QString ipAddress = ui->tableWidget->item(row, 0)->text();  // Get the IP from column 0
-    qDebug() << "Selected IP Address:" << ipAddress;
+    qCDebug(logNet) << "Selected IP Address:" << ipAddress;
     this->ip = ipAddress;
 
     // Close dialog
@@ -24,9 +24,13 @@ private slots:
     void on_scanButton_clicked();
     void on_connectButton_clicked();
     void handleServerFound(const QString &ip, const QString &hostname);
+    void handleHostnameResolved(const QString &ip, const QString &hostname);
+    void handleServerLatencyUpdated(const QString &ip, double rttMs, double jitterMs);
+    void handleServerLost(const QString &ip);
     void handleScanProgress(int scanned, int total);
     void handleScanComplete();
     void updateConnectButton();
+    void on_browseCheckBox_toggled(bool checked);
 
 private:
     Ui::ScanNetworkDialog *ui;
@@ -36,4 +40,6 @@ private:
     int port;
 
     bool isScanning = false;
+
+    int findServerRow(const QString &ip);
 };
@@ -1,18 +1,28 @@
 #include "settings.h"
+#include "logcategories.h"
 
 #include <QCoreApplication>
 #include <QDateTime>
 #include <QLocale>
+#include <QMutexLocker>
 #include <QScreen>
 #include <QSettings>
 #include <QWidget>
 #include <QWindow>
 
+#include <iterator>
+
 #include "kfxversion.h"
 #include "settingscfgformat.h"
 
-QSettings *Settings::kfxSettings;
-QSettings *Settings::launcherSettings;
+#define SETTINGS_WRITE_DELAY_MS 500
+
+Settings::SettingsStore Settings::kfxStore;
+Settings::SettingsStore Settings::launcherStore;
+QMutex Settings::storeMutex;
+std::array<QVariant, static_cast<size_t>(KfxKey::COUNT)> Settings::kfxValues;
+QThread *Settings::writerThread = nullptr;
+QTimer *Settings::writeTimer = nullptr;
 
 // clang-format off
 
@@ -34,6 +44,7 @@ QMap<QString, QVariant> Settings::defaultLauncherSettingsMap = {
     {"LAUNCHER_LANGUAGE", QLocale(QLocale::system().uiLanguages().value(0, QLocale::system().name())).name().left(2)}, // Get 2 letter language identifier
     {"SHOW_DIR_NAME_IN_WINDOW_TITLE", false},
     {"AUTO_REMOVE_LEFTOVER_FILES", false},
+    {"WINE_PREWARM_ENABLED", true},
 
     // Stuff to remember
     {"SUPPRESS_ORIGINAL_DK_FOUND_MESSAGEBOX", false},
@@ -84,83 +95,270 @@ QMap<QString, QString> Settings::localeToGameLanguageMap = {
     {"zh-Hant", "CHT"}, // Traditional Chinese
 };
 
-QVariant Settings::getKfxSetting(QAnyStringView key)
+// Name and type of every KeeperFX setting by key
+struct KfxKeyEntry
 {
-    // Get value as a string
-    QVariant value = kfxSettings->value(key);
-    QString valueString = value.toString();
+    const char *name;
+    QMetaType type;
+};
+
+static constexpr KfxKeyEntry kfxKeyTable[] = {
+#define KFX_SETTING_KEY_ENTRY(name, type) {#name, QMetaType::fromType<type>()},
+    KFX_SETTING_KEYS(KFX_SETTING_KEY_ENTRY)
+#undef KFX_SETTING_KEY_ENTRY
+};
 
-    // Fix for 'RESIZE_MOVIES' KeeperFX setting
-    // This setting is set to "ON" by default which would make this a boolean
-    // However, ON should be a string here and is treated different than all the rest
-    // Therefor we simply return the value as a string
-    if (key.toString() == "RESIZE_MOVIES") {
-        return valueString;
+static_assert(std::size(kfxKeyTable) == static_cast<size_t>(KfxKey::COUNT), "Every KeeperFX setting key needs an entry");
+
+QVariant Settings::parseKfxValue(KfxKey key, const QVariant &value)
+{
+    if (value.isValid() == false) {
+        return QVariant();
     }
 
-    // True strings
-    if (valueString == "ON" || valueString == "YES" || valueString == "TRUE") {
-        return true;
+    const QMetaType type = kfxKeyTable[static_cast<size_t>(key)].type;
+
+    // Booleans can be written in a few ways
+    if (type == QMetaType::fromType<bool>()) {
+        QString valueString = value.toString();
+        if (valueString == "ON" || valueString == "YES" || valueString == "TRUE") {
+            return true;
+        }
+        if (valueString == "OFF" || valueString == "NO" || valueString == "FALSE") {
+            return false;
+        }
+        return value.toBool();
     }
 
-    // False strings
-    if (valueString == "OFF" || valueString == "NO" || valueString == "FALSE") {
-        return false;
+    if (type == QMetaType::fromType<int>()) {
+        return value.toInt();
     }
 
-    // Return the string value directly
-    return value;
+    return value.toString();
+}
+
+QVariant Settings::getKfxValue(KfxKey key)
+{
+    // Values are parsed into the type of their key when they are loaded or set
+    QMutexLocker locker(&storeMutex);
+    return kfxValues[static_cast<size_t>(key)];
 }
 
-void Settings::setKfxSetting(QAnyStringView key, const QVariant &value)
+void Settings::setKfxValue(KfxKey key, const QVariant &value)
 {
+    QString keyString = QString::fromLatin1(kfxKeyTable[static_cast<size_t>(key)].name);
+    QVariant storedValue = value;
+
     if (value.typeId() == QMetaType::Type::Bool && value == true) {
-        kfxSettings->setValue(key, "TRUE");
-        return;
+        storedValue = "TRUE";
+    } else if (value.typeId() == QMetaType::Type::Bool && value == false) {
+        storedValue = "FALSE";
     }
 
-    if (value.typeId() == QMetaType::Type::Bool && value == false) {
-        kfxSettings->setValue(key, "FALSE");
-        return;
+    {
+        QMutexLocker locker(&storeMutex);
+        kfxValues[static_cast<size_t>(key)] = parseKfxValue(key, value);
+        kfxStore.dirtyValues.insert(keyString, storedValue);
+        kfxStore.removedKeys.remove(keyString);
     }
 
-    kfxSettings->setValue(key, value);
+    scheduleWrite();
 }
 
-void Settings::removeKfxSetting(QAnyStringView key)
+void Settings::removeKfxValue(KfxKey key)
 {
-    if(kfxSettings->contains(key)){
-        kfxSettings->remove(key);
+    QString keyString = QString::fromLatin1(kfxKeyTable[static_cast<size_t>(key)].name);
+
+    {
+        QMutexLocker locker(&storeMutex);
+        QVariant &value = kfxValues[static_cast<size_t>(key)];
+        if (value.isValid() == false) {
+            return;
+        }
+        value = QVariant();
+        kfxStore.dirtyValues.remove(keyString);
+        kfxStore.removedKeys.insert(keyString);
     }
+
+    scheduleWrite();
 }
 
 QVariant Settings::getLauncherSetting(QAnyStringView key)
 {
-    return launcherSettings->value(key);
+    QMutexLocker locker(&storeMutex);
+    return launcherStore.values.value(key.toString());
 }
 
 void Settings::setLauncherSetting(QAnyStringView key, const QVariant &value)
 {
-    launcherSettings->setValue(key, value);
+    QString keyString = key.toString();
+
+    {
+        QMutexLocker locker(&storeMutex);
+        launcherStore.values.insert(keyString, value);
+        launcherStore.dirtyValues.insert(keyString, value);
+        launcherStore.removedKeys.remove(keyString);
+    }
+
+    scheduleWrite();
 }
 
 QFile Settings::getKfxConfigFile()
 {
-    return QFile(kfxSettings->fileName());
+    return QFile(kfxStore.fileName);
+}
+
+void Settings::reloadKfxValues()
+{
+    // Parse the values of the known keys once
+    std::array<QVariant, static_cast<size_t>(KfxKey::COUNT)> values;
+    for (size_t i = 0; i < values.size(); i++) {
+        values[i] = parseKfxValue(static_cast<KfxKey>(i), kfxStore.settings->value(kfxKeyTable[i].name));
+    }
+
+    QMutexLocker locker(&storeMutex);
+    kfxStore.fileName = kfxStore.settings->fileName();
+    kfxValues = values;
+    kfxStore.dirtyValues.clear();
+    kfxStore.removedKeys.clear();
+}
+
+void Settings::reloadStoreValues(SettingsStore &store)
+{
+    // Read all values of the settings file once
+    QHash<QString, QVariant> values;
+    const QStringList keys = store.settings->allKeys();
+    for (const QString &key : keys) {
+        values.insert(key, store.settings->value(key));
+    }
+
+    QMutexLocker locker(&storeMutex);
+    store.fileName = store.settings->fileName();
+    store.values = values;
+    store.dirtyValues.clear();
+    store.removedKeys.clear();
+}
+
+void Settings::scheduleWrite()
+{
+    // Write directly if the writer thread is not available
+    if (writerThread == nullptr || writerThread->isRunning() == false) {
+        writeDirtySettings();
+        return;
+    }
+
+    // (Re)start the timer so multiple changes result in a single write
+    QMetaObject::invokeMethod(writeTimer, []() { writeTimer->start(); }, Qt::QueuedConnection);
+}
+
+void Settings::writeDirtySettings()
+{
+    // Take the pending changes
+    QList<std::pair<SettingsStore *, SettingsStore>> pendingChanges;
+    {
+        QMutexLocker locker(&storeMutex);
+        for (SettingsStore *store : {&kfxStore, &launcherStore}) {
+            if (store->settings == nullptr || (store->dirtyValues.isEmpty() && store->removedKeys.isEmpty())) {
+                continue;
+            }
+
+            SettingsStore changes;
+            changes.dirtyValues.swap(store->dirtyValues);
+            changes.removedKeys.swap(store->removedKeys);
+            pendingChanges.append({store, changes});
+        }
+    }
+
+    // Write the changes to the settings files
+    for (auto &pendingChange : pendingChanges) {
+        QSettings *settings = pendingChange.first->settings;
+
+        for (const QString &key : std::as_const(pendingChange.second.removedKeys)) {
+            settings->remove(key);
+        }
+
+        for (auto it = pendingChange.second.dirtyValues.constBegin(); it != pendingChange.second.dirtyValues.constEnd(); ++it) {
+            settings->setValue(it.key(), it.value());
+        }
+
+        settings->sync();
+
+        qCDebug(logSettings) << "Settings written:" << settings->fileName();
+    }
+}
+
+void Settings::runOnWriterThread(const std::function<void()> &function)
+{
+    // Run directly if we can't or don't have to switch threads
+    if (writerThread == nullptr || writerThread->isRunning() == false || QThread::currentThread() == writerThread) {
+        function();
+        return;
+    }
+
+    QMetaObject::invokeMethod(writeTimer, function, Qt::BlockingQueuedConnection);
+}
+
+void Settings::flush()
+{
+    runOnWriterThread([]() {
+        if (writeTimer) {
+            writeTimer->stop();
+        }
+        writeDirtySettings();
+    });
+}
+
+void Settings::stop()
+{
+    if (writerThread == nullptr || writerThread->isRunning() == false) {
+        return;
+    }
+
+    Settings::flush();
+    writerThread->quit();
+    writerThread->wait();
 }
 
 void Settings::load()
 {
+    // Create the writer thread
+    // Settings are written here so the GUI does not have to wait for the disk
+    if (writerThread == nullptr) {
+        writerThread = new QThread();
+        writerThread->setObjectName("SettingsWriter");
+
+        writeTimer = new QTimer();
+        writeTimer->setSingleShot(true);
+        writeTimer->setInterval(SETTINGS_WRITE_DELAY_MS);
+        QObject::connect(writeTimer, &QTimer::timeout, writeTimer, &Settings::writeDirtySettings);
+        writeTimer->moveToThread(writerThread);
+
+        writerThread->start();
+
+        // Write the last changes when the launcher closes
+        // A post routine also runs when we exit without starting the event loop
+        qAddPostRoutine(Settings::stop);
+    }
+
+    // Write and remove previously loaded settings
+    runOnWriterThread([]() {
+        writeDirtySettings();
+        delete kfxStore.settings;
+        delete launcherStore.settings;
+        kfxStore.settings = nullptr;
+        launcherStore.settings = nullptr;
+    });
+
     // Get the CFG format used by the original keeperfx.cfg
     QSettings::Format settingsCfgFormat = SettingsCfgFormat::registerFormat();
 
     // Check if we need to load config files from the user appdata config
     if(KfxVersion::hasFunctionality("use_appdata_configs")){
 
-        qInfo() << "Using AppData configs";
+        qCInfo(logSettings) << "Using AppData configs";
 
-        kfxSettings = new QSettings(settingsCfgFormat, QSettings::UserScope, "keeperfx", "keeperfx");
-        launcherSettings = new QSettings(settingsCfgFormat, QSettings::UserScope, "keeperfx", "launcher");
+        kfxStore.settings = new QSettings(settingsCfgFormat, QSettings::UserScope, "keeperfx", "keeperfx");
+        launcherStore.settings = new QSettings(settingsCfgFormat, QSettings::UserScope, "keeperfx", "launcher");
 
         // Load default settings from config file in application directory
         // This is only done when we use config files in the appdata
@@ -169,26 +367,34 @@ void Settings::load()
 
     } else {
 
-        kfxSettings = new QSettings(QCoreApplication::applicationDirPath() + "/keeperfx.cfg", settingsCfgFormat);
-        launcherSettings = new QSettings(QCoreApplication::applicationDirPath() + "/keeperfx-launcher-qt.cfg", settingsCfgFormat);
+        kfxStore.settings = new QSettings(QCoreApplication::applicationDirPath() + "/keeperfx.cfg", settingsCfgFormat);
+        launcherStore.settings = new QSettings(QCoreApplication::applicationDirPath() + "/keeperfx-launcher-qt.cfg", settingsCfgFormat);
     }
 
     // Copy missing alpha settings from the '_keeperfx.cfg' file
     copyMissingAlphaSettings();
 
     // Log the paths
-    qInfo() << "KeeperFX Settings File:" << kfxSettings->fileName();
-    qInfo() << "Launcher Settings File:" << launcherSettings->fileName();
+    qCInfo(logSettings) << "KeeperFX Settings File:" << kfxStore.settings->fileName();
+    qCInfo(logSettings) << "Launcher Settings File:" << launcherStore.settings->fileName();
 
     // Copy missing launcher settings
     Settings::copyMissingLauncherSettings();
+
+    // Cache the values
+    reloadKfxValues();
+    reloadStoreValues(launcherStore);
+
+    // From now on the settings files are only used by the writer thread
+    kfxStore.settings->moveToThread(writerThread);
+    launcherStore.settings->moveToThread(writerThread);
 }
 
 void Settings::copyMissingSettings(QSettings *fromSettingsFile, QSettings *toSettingsFile)
 {
     // File not loaded
     if (fromSettingsFile->allKeys().isEmpty()) {
-        qDebug() << "New settings file not loaded. File not found or it contains no keys";
+        qCDebug(logSettings) << "New settings file not loaded. File not found or it contains no keys";
         return;
     }
 
@@ -209,7 +415,7 @@ void Settings::copyMissingSettings(QSettings *fromSettingsFile, QSettings *toSet
         if (!toSettingsFile->contains(key)) {
             // Copy the setting
             toSettingsFile->setValue(key, value);
-            qDebug() << "Copied setting:" << key << "=" << value.toString();
+            qCDebug(logSettings) << "Copied setting:" << key << "=" << value.toString();
         }
     }
 }
@@ -222,12 +428,12 @@ void Settings::copyMissingDefaultSettings()
     }
 
     // Try and load default KFX settings from 'keeperfx.cfg' in the app dir
-    QSettings *defaultKfxSettings = new QSettings(
+    QSettings defaultKfxSettings(
         QCoreApplication::applicationDirPath() + "/keeperfx.cfg",
         SettingsCfgFormat::registerFormat()
     );
 
-    copyMissingSettings(defaultKfxSettings, kfxSettings);
+    copyMissingSettings(&defaultKfxSettings, kfxStore.settings);
 }
 
 void Settings::copyMissingAlphaSettings()
@@ -241,12 +447,14 @@ void Settings::copyMissingAlphaSettings()
     }
 
     // Copy new settings
-    QSettings *newAlphaSettings = new QSettings(alphaSettingsFilePath, SettingsCfgFormat::registerFormat());
-    copyMissingSettings(newAlphaSettings, kfxSettings);
+    QSettings newAlphaSettings(alphaSettingsFilePath, SettingsCfgFormat::registerFormat());
+    copyMissingSettings(&newAlphaSettings, kfxStore.settings);
 }
 
 void Settings::copyMissingLauncherSettings()
 {
+    QSettings *launcherSettings = launcherStore.settings;
+
     // Loop trough default launcher settings
     for (auto it = defaultLauncherSettingsMap.begin(); it != defaultLauncherSettingsMap.end(); ++it) {
 
@@ -255,7 +463,7 @@ void Settings::copyMissingLauncherSettings()
 
             // Copy the setting
             launcherSettings->setValue(it.key(), it.value());
-            qDebug() << "Copied launcher setting from defaults:" << it.key() << "=" << it.value().toString();
+            qCDebug(logSettings) << "Copied launcher setting from defaults:" << it.key() << "=" << it.value().toString();
         }
     }
 
@@ -273,7 +481,7 @@ void Settings::copyMissingLauncherSettings()
 
         // Set key
         launcherSettings->setValue(updateReleaseTypeKey, updateReleaseTypeValue);
-        qDebug() << "Set launcher setting automatically:" << updateReleaseTypeKey << "=" << updateReleaseTypeValue;
+        qCDebug(logSettings) << "Set launcher setting automatically:" << updateReleaseTypeKey << "=" << updateReleaseTypeValue;
     }
 }
 
@@ -330,7 +538,7 @@ bool Settings::autoSetGameLanguageToLocaleLanguage()
     }
 
     // Update game language
-    Settings::setKfxSetting("LANGUAGE", localeToGameLanguageMap[localeLanguage]);
+    Settings::set<KfxKey::LANGUAGE>(localeToGameLanguageMap[localeLanguage]);
 
     return true;
 }
@@ -356,7 +564,7 @@ bool Settings::autoSetMaxFpsToScreenRefreshRate(QWidget *widget)
 
     // No screen found
     if(!screen){
-        qWarning() << "Failed to find screen when trying to find refresh rate for automatically setting max fps";
+        qCWarning(logSettings) << "Failed to find screen when trying to find refresh rate for automatically setting max fps";
         return false;
     }
 
@@ -378,26 +586,32 @@ bool Settings::autoSetMaxFpsToScreenRefreshRate(QWidget *widget)
 
     // Add automatic monitor refresh rate determinitation built into KeeperFX
     if (KfxVersion::hasFunctionality("auto_determine_monitor_refresh_rate") == true) {
-        Settings::setKfxSetting("FRAMES_PER_SECOND", QString("AUTO ") + QString::number(refreshRate));
+        Settings::set<KfxKey::FRAMES_PER_SECOND>(QString("AUTO ") + QString::number(refreshRate));
         return true;
     }
 
-    Settings::setKfxSetting("FRAMES_PER_SECOND", refreshRate);
+    Settings::set<KfxKey::FRAMES_PER_SECOND>(QString::number(refreshRate));
     return true;
 }
 
 void Settings::resetKfxSettings()
 {
-    if (Settings::kfxSettings) {
-        Settings::kfxSettings->clear();
-        Settings::copyMissingDefaultSettings();
+    if (Settings::kfxStore.settings) {
+        Settings::runOnWriterThread([]() {
+            Settings::kfxStore.settings->clear();
+            Settings::copyMissingDefaultSettings();
+            Settings::reloadKfxValues();
+        });
     }
 }
 
 void Settings::resetLauncherSettings()
 {
-    if (Settings::launcherSettings) {
-        Settings::launcherSettings->clear();
-        Settings::copyMissingLauncherSettings();
+    if (Settings::launcherStore.settings) {
+        Settings::runOnWriterThread([]() {
+            Settings::launcherStore.settings->clear();
+            Settings::copyMissingLauncherSettings();
+            Settings::reloadStoreValues(Settings::launcherStore);
+        });
     }
 }
@@ -1,15 +1,101 @@
 #pragma once
 
 #include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QSet>
 #include <QString>
 #include <QSettings>
+#include <QThread>
+#include <QTimer>
+#include <QVariant>
+
+#include <array>
+#include <functional>
+
+// KeeperFX settings used by the launcher: X(name, type)
+// The name is the key in 'keeperfx.cfg' and the type is what the typed accessors use
+// Strings are never turned into booleans, so 'RESIZE_MOVIES = ON' stays "ON"
+#define KFX_SETTING_KEYS(X) \
+    X(API_ENABLED, bool)                    \
+    X(API_PORT, QString)                    \
+    X(ATMOSPHERIC_SOUNDS, bool)             \
+    X(ATMOS_FREQUENCY, QString)             \
+    X(ATMOS_VOLUME, QString)                \
+    X(CENSORSHIP, bool)                     \
+    X(COMMAND_CHAR, QString)                \
+    X(CREATURE_STATUS_SIZE, QString)        \
+    X(CURSOR_EDGE_CAMERA_PANNING, bool)     \
+    X(DEFAULT_TAG_MODE, QString)            \
+    X(DELTA_TIME, bool)                     \
+    X(DISABLE_SPLASH_SCREENS, bool)         \
+    X(DISPLAY_NUMBER, QString)              \
+    X(EXIT_ON_LUA_ERROR, bool)              \
+    X(FLEE_BUTTON_DEFAULT, bool)            \
+    X(FRAMES_PER_SECOND, QString)           \
+    X(FREEZE_GAME_ON_FOCUS_LOST, bool)      \
+    X(FRONTEND_RES, QString)                \
+    X(GUI_BLINK_RATE, QString)              \
+    X(HAND_SIZE, QString)                   \
+    X(IMPRISON_BUTTON_DEFAULT, bool)        \
+    X(INGAME_RES, QString)                  \
+    X(LANGUAGE, QString)                    \
+    X(LINE_BOX_SIZE, QString)               \
+    X(LOCK_CURSOR_IN_POSSESSION, bool)      \
+    X(MASTERSERVER_HOST, QString)           \
+    X(MUTE_AUDIO_ON_FOCUS_LOST, bool)       \
+    X(NEUTRAL_FLASH_RATE, QString)          \
+    X(PAUSE_MUSIC_WHEN_GAME_PAUSED, bool)   \
+    X(POINTER_SENSITIVITY, int)             \
+    X(RESIZE_MOVIES, QString)               \
+    X(SCREENSHOT, QString)                  \
+    X(STARTUP, QString)                     \
+    X(TAG_MODE_TOGGLING, bool)              \
+    X(UNLOCK_CURSOR_WHEN_GAME_PAUSED, bool)
+
+enum class KfxKey {
+#define KFX_SETTING_KEY_ENUM(name, type) name,
+    KFX_SETTING_KEYS(KFX_SETTING_KEY_ENUM)
+#undef KFX_SETTING_KEY_ENUM
+    COUNT
+};
+
+// Name and type of a KeeperFX setting, resolved at compile time
+template<KfxKey Key>
+struct KfxKeyInfo;
+
+#define KFX_SETTING_KEY_INFO(keyName, keyType) \
+    template<> \
+    struct KfxKeyInfo<KfxKey::keyName> \
+    { \
+        using Type = keyType; \
+        static constexpr const char *name = #keyName; \
+    };
+KFX_SETTING_KEYS(KFX_SETTING_KEY_INFO)
+#undef KFX_SETTING_KEY_INFO
 
 class Settings
 {
 public:
-    static QVariant getKfxSetting(QAnyStringView key);
-    static void setKfxSetting(QAnyStringView key, const QVariant &value);
-    static void removeKfxSetting(QAnyStringView key);
+    // Typed access to the KeeperFX settings
+    // A missing setting returns the default value of its type
+    template<KfxKey Key>
+    static typename KfxKeyInfo<Key>::Type get()
+    {
+        return getKfxValue(Key).template value<typename KfxKeyInfo<Key>::Type>();
+    }
+
+    template<KfxKey Key>
+    static void set(const typename KfxKeyInfo<Key>::Type &value)
+    {
+        setKfxValue(Key, QVariant::fromValue(value));
+    }
+
+    template<KfxKey Key>
+    static void remove()
+    {
+        removeKfxValue(Key);
+    }
 
     static QVariant getLauncherSetting(QAnyStringView key);
     static void setLauncherSetting(QAnyStringView key, const QVariant &value);
@@ -18,6 +104,12 @@ public:
 
     static void load();
 
+    // Write all pending changes to disk and wait for it
+    static void flush();
+
+    // Write all pending changes and stop the writer thread
+    static void stop();
+
     static QStringList getGameSettingsParameters();
 
     static bool autoSetGameLanguageToLocaleLanguage();
@@ -31,8 +123,39 @@ private:
     static QMap<QString, QString> gameSettingsParameterMap;
     static QMap<QString, QString> localeToGameLanguageMap;
 
-    static QSettings *kfxSettings;
-    static QSettings *launcherSettings;
+    // A settings file with its cached values
+    // Changes are kept as dirty values until the writer thread writes them
+    struct SettingsStore
+    {
+        QSettings *settings = nullptr;
+        QString fileName;
+        QHash<QString, QVariant> values;
+        QHash<QString, QVariant> dirtyValues;
+        QSet<QString> removedKeys;
+    };
+
+    static SettingsStore kfxStore;
+    static SettingsStore launcherStore;
+    static QMutex storeMutex;
+
+    // Parsed KeeperFX values by key, already converted to the type of their key
+    // Only the keys of the table are cached, other keys in the file are left alone
+    static std::array<QVariant, static_cast<size_t>(KfxKey::COUNT)> kfxValues;
+
+    // The settings files are only accessed from the writer thread after they are loaded
+    static QThread *writerThread;
+    static QTimer *writeTimer;
+
+    static QVariant getKfxValue(KfxKey key);
+    static void setKfxValue(KfxKey key, const QVariant &value);
+    static void removeKfxValue(KfxKey key);
+
+    static QVariant parseKfxValue(KfxKey key, const QVariant &value);
+    static void reloadKfxValues();
+    static void reloadStoreValues(SettingsStore &store);
+    static void scheduleWrite();
+    static void writeDirtySettings();
+    static void runOnWriterThread(const std::function<void()> &function);
 
     static void copyMissingSettings(QSettings *fromSettingsFile, QSettings *toSettingsFile);
     static void copyMissingDefaultSettings();
@@ -1,10 +1,16 @@
 #include <QSaveFile>
+#include <QCryptographicHash>
 #include <QFile>
 #include <QCoreApplication>
 #include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
 
 #include "settingscfgformat.h"
 
+QHash<QString, SettingsCfgFormat::TemplateCacheEntry> SettingsCfgFormat::templateCache;
+QMutex SettingsCfgFormat::templateCacheMutex;
+
 QSettings::Format SettingsCfgFormat::registerFormat()
 {
     return QSettings::registerFormat("cfg", readFile, writeFile);
@@ -33,12 +39,100 @@ bool SettingsCfgFormat::readFile(QIODevice &device, QSettings::SettingsMap &map)
     return true;
 }
 
-bool SettingsCfgFormat::writeFile(QIODevice &device, const QSettings::SettingsMap &map)
+QString SettingsCfgFormat::getTemplateFilePath(const QString &filePath)
+{
+    // Check if this is the standard KeeperFX config file
+    QFileInfo fileInfo(filePath);
+    QString fileName = fileInfo.fileName();
+    if(fileName == "keeperfx.cfg") {
+        // Check for the defaults file
+        // We can use this as a template so we always get all the new comments in it after updates
+        QFileInfo kfxDefaultConfigFileInfo(QCoreApplication::applicationDirPath() + QDir::separator() + "_keeperfx.cfg");
+        if (kfxDefaultConfigFileInfo.exists() && kfxDefaultConfigFileInfo.size() > 0) {
+            return kfxDefaultConfigFileInfo.absoluteFilePath();
+        }
+    }
+
+    // Use the current config file
+    return fileInfo.absoluteFilePath();
+}
+
+void SettingsCfgFormat::indexTemplate(TemplateCacheEntry &entry)
+{
+    entry.keyLineIndex.clear();
+
+    for (int i = 0; i < entry.lines.size(); ++i) {
+        QString line = entry.lines[i].trimmed();
+
+        // Skip comments and empty lines
+        if (line.isEmpty() || line.startsWith(";") || line.startsWith("#"))
+            continue;
+
+        int idx = line.indexOf('=');
+        if (idx <= 0)
+            continue;
+
+        entry.keyLineIndex[line.left(idx).trimmed()].append(i);
+    }
+}
+
+SettingsCfgFormat::TemplateCacheEntry SettingsCfgFormat::getTemplate(const QString &templateFilePath)
 {
+    QFileInfo templateFileInfo(templateFilePath);
+
+    QMutexLocker locker(&templateCacheMutex);
+
+    // Use the cached template if the file did not change
+    auto it = templateCache.find(templateFilePath);
+    if (it != templateCache.end()) {
+        if (it->isPendingWrite && it->fileSize == templateFileInfo.size()) {
+            // Make sure this is the file we wrote last time
+            // The save file might not have been committed or somebody else might have written it
+            QFile writtenFile(templateFilePath);
+            if (writtenFile.open(QIODevice::ReadOnly)
+                && QCryptographicHash::hash(writtenFile.readAll(), QCryptographicHash::Sha1) == it->contentHash) {
+                it->isPendingWrite = false;
+                it->lastModified = templateFileInfo.lastModified();
+                return *it;
+            }
+        }
+        if (it->isPendingWrite == false && it->lastModified == templateFileInfo.lastModified() && it->fileSize == templateFileInfo.size()) {
+            return *it;
+        }
+    }
+
+    TemplateCacheEntry entry;
+    entry.lastModified = templateFileInfo.lastModified();
+    entry.fileSize = templateFileInfo.size();
+
     // Original file content
     // We will use this as a template to update
     QString contents;
+    QFile templateFile(templateFilePath);
+    if (templateFilePath.endsWith("_keeperfx.cfg")) {
+        if (templateFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            contents = templateFile.readAll();
+        }
+    } else {
+        // Read the original content of the current config file
+        if (templateFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            QTextStream in(&templateFile);
+            contents = in.readAll();
+            templateFile.close();
+        }
+    }
+
+    // Split into lines and index the keys
+    entry.lines = contents.split('\n');
+    indexTemplate(entry);
+
+    templateCache.insert(templateFilePath, entry);
+
+    return entry;
+}
 
+bool SettingsCfgFormat::writeFile(QIODevice &device, const QSettings::SettingsMap &map)
+{
     // Try to get the filename
     QString filePath;
     if (QSaveFile *sf = qobject_cast<QSaveFile*>(&device)) {
@@ -47,59 +141,34 @@ bool SettingsCfgFormat::writeFile(QIODevice &device, const QSettings::SettingsMa
         filePath = f->fileName();
     }
 
-    // Check if we got the filename of the device
+    // Get the parsed template
+    // The template is only parsed again when it changed on disk
+    TemplateCacheEntry templateEntry;
+    QString templateFilePath;
     if (!filePath.isEmpty()) {
-
-        // Check if this is the standard KeeperFX config file
-        QFileInfo fileInfo(filePath);
-        QString fileName = fileInfo.fileName();
-        if(fileName == "keeperfx.cfg") {
-            // Check for the defaults file
-            // We can use this as a template so we always get all the new comments in it after updates
-            QFile kfxDefaultConfigFile(QCoreApplication::applicationDirPath() + QDir::separator() + "_keeperfx.cfg");
-            if(kfxDefaultConfigFile.open(QIODevice::ReadOnly | QIODevice::Text)){
-                contents = kfxDefaultConfigFile.readAll();
-            }
-        }
-
-        if(contents.isEmpty()){
-
-            // Read the original content of the current config file
-            QFile readFile(filePath);
-            if (readFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-                QTextStream in(&readFile);
-                contents = in.readAll();
-                readFile.close();
-            }
-        }
+        templateFilePath = getTemplateFilePath(filePath);
+        templateEntry = getTemplate(templateFilePath);
+    } else {
+        templateEntry.lines = QStringList(QString());
     }
 
-    // Split into lines
-    QStringList lines = contents.split('\n');
+    // Only the lines of the keys we set are touched
+    QStringList lines = templateEntry.lines;
     QSet<QString> updatedKeys;
 
-    // Copy the map so we can track unhandled keys
-    QSettings::SettingsMap tmpMap = map;
-
     // Update existing keys
-    for (int i = 0; i < lines.size(); ++i) {
-        QString line = lines[i].trimmed();
-
-        // Skip comments and empty lines
-        if (line.isEmpty() || line.startsWith(";") || line.startsWith("#"))
+    for (auto it = map.constBegin(); it != map.constEnd(); ++it) {
+        auto lineIt = templateEntry.keyLineIndex.constFind(it.key());
+        if (lineIt == templateEntry.keyLineIndex.constEnd())
             continue;
 
-        int idx = line.indexOf('=');
-        if (idx <= 0)
-            continue;
-
-        QString key = line.left(idx).trimmed();
-
-        if (tmpMap.contains(key)) {
-            QString newValue = tmpMap[key].toString();
-            lines[i] = key + "=" + newValue;
-            updatedKeys.insert(key);
+        QString newLine = it.key() + "=" + it.value().toString();
+        for (int lineNumber : lineIt.value()) {
+            if (lines[lineNumber] != newLine) {
+                lines[lineNumber] = newLine;
+            }
         }
+        updatedKeys.insert(it.key());
     }
 
     // Prepare final output
@@ -109,7 +178,7 @@ bool SettingsCfgFormat::writeFile(QIODevice &device, const QSettings::SettingsMa
     // Launcher configs are ignored
     bool firstMissing = true;
 
-    for (auto it = tmpMap.constBegin(); it != tmpMap.constEnd(); ++it) {
+    for (auto it = map.constBegin(); it != map.constEnd(); ++it) {
         if (!updatedKeys.contains(it.key())) {
 
             if (firstMissing) {
@@ -133,12 +202,25 @@ bool SettingsCfgFormat::writeFile(QIODevice &device, const QSettings::SettingsMa
         output.removeFirst();
     }
 
+    // Join the output
+    QString outputString = output.join('\n');
+    QByteArray outputData = outputString.toUtf8();
+
     // Write back to QSaveFile
-    QTextStream out(&device);
-    for (int i = 0; i < output.size(); ++i) {
-        out << output[i];
-        if (i + 1 < output.size())
-            out << "\n";
+    device.write(outputData);
+
+    // Remember what we wrote if the file is its own template
+    // The next write can then use it without reading and parsing it again
+    if (!filePath.isEmpty() && templateFilePath == QFileInfo(filePath).absoluteFilePath()) {
+        TemplateCacheEntry writtenEntry;
+        writtenEntry.isPendingWrite = true;
+        writtenEntry.fileSize = outputData.size();
+        writtenEntry.contentHash = QCryptographicHash::hash(outputData, QCryptographicHash::Sha1);
+        writtenEntry.lines = output;
+        indexTemplate(writtenEntry);
+
+        QMutexLocker locker(&templateCacheMutex);
+        templateCache.insert(templateFilePath, writtenEntry);
     }
 
     return true;
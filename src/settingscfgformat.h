@@ -3,6 +3,11 @@
 #include <QSettings>
 #include <QIODevice>
 #include <QTextStream>
+#include <QDateTime>
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QStringList>
 
 class SettingsCfgFormat
 {
@@ -11,6 +16,32 @@ public:
     static QSettings::Format registerFormat();
 
 private:
+    // A parsed template file
+    struct TemplateCacheEntry
+    {
+        QDateTime lastModified;
+        qint64 fileSize = -1;
+
+        // Set when the template is the file we wrote ourselves
+        // Its modification time is only known after the save file is committed
+        // The file is only accepted as ours when its content matches what we wrote
+        bool isPendingWrite = false;
+        QByteArray contentHash;
+
+        QStringList lines;
+
+        // Key -> line numbers where the key is set
+        QHash<QString, QList<int>> keyLineIndex;
+    };
+
+    // Parsed templates by file path
+    static QHash<QString, TemplateCacheEntry> templateCache;
+    static QMutex templateCacheMutex;
+
+    static QString getTemplateFilePath(const QString &filePath);
+    static TemplateCacheEntry getTemplate(const QString &templateFilePath);
+    static void indexTemplate(TemplateCacheEntry &entry);
+
     static bool readFile(QIODevice &device, QSettings::SettingsMap &map);
     static bool writeFile(QIODevice &device, const QSettings::SettingsMap &map);
 };
@@ -1,5 +1,6 @@
 #include "settingsdialog.h"
 #include "ui_settingsdialog.h"
+#include "logcategories.h"
 
 #include "version.h"
 #include "kfxversion.h"
@@ -30,6 +31,11 @@ SettingsDialog::SettingsDialog(QWidget *parent)
     // Hide 'Multiplayer' tab until a future update requires it
     ui->tabWidget->tabBar()->setTabVisible(4, false);
 
+#ifdef Q_OS_WINDOWS
+    // Wine is only used on Linux
+    ui->checkBoxWinePrewarm->hide();
+#endif
+
     // Reset setting has changed variable
     settingHasChanged = false;
 
@@ -421,7 +427,7 @@ SettingsDialog::SettingsDialog(QWidget *parent)
                 if(parts.length() == 2){
                     t = QString("<a href=\"%1\">%2</a>").arg(parts[1], parts[0]);
                 } else {
-                    qWarning() << "Invalid launcher translator entry:" << t;
+                    qCWarning(logSettings) << "Invalid launcher translator entry:" << t;
                 }
             }
         }
@@ -450,12 +456,12 @@ void SettingsDialog::loadSettings()
     // ========================================================================
 
     ui->comboBoxLanguage->setCurrentIndex(
-        ui->comboBoxLanguage->findData(Settings::getKfxSetting("LANGUAGE").toString()));
+        ui->comboBoxLanguage->findData(Settings::get<KfxKey::LANGUAGE>()));
 
     if (KfxVersion::hasFunctionality("startup_config_option")) {
         ui->checkBoxDisplayIntro->setChecked(false);
         ui->checkBoxDisplaySplashScreens->setChecked(false);
-        QString startupString = Settings::getKfxSetting("STARTUP").toString().trimmed();
+        QString startupString = Settings::get<KfxKey::STARTUP>().trimmed();
         QStringList startupScreens = startupString.split(" ");
         for (const QString &startupScreen : std::as_const(startupScreens)) {
             if (startupScreen == "INTRO") {
@@ -468,17 +474,17 @@ void SettingsDialog::loadSettings()
         }
     } else {
         ui->checkBoxDisplayIntro->setChecked(Settings::getLauncherSetting("GAME_PARAM_NO_INTRO") == false);
-        ui->checkBoxDisplaySplashScreens->setChecked(Settings::getKfxSetting("DISABLE_SPLASH_SCREENS") == false);
+        ui->checkBoxDisplaySplashScreens->setChecked(Settings::get<KfxKey::DISABLE_SPLASH_SCREENS>() == false);
     }
 
     ui->checkBoxCheats->setChecked(Settings::getLauncherSetting("GAME_PARAM_ALEX") == true);
-    ui->checkBoxCensorship->setChecked(Settings::getKfxSetting("CENSORSHIP") == true);
+    ui->checkBoxCensorship->setChecked(Settings::get<KfxKey::CENSORSHIP>() == true);
     ui->comboBoxScreenshots->setCurrentIndex(
-        ui->comboBoxScreenshots->findData(Settings::getKfxSetting("SCREENSHOT").toString()));
+        ui->comboBoxScreenshots->findData(Settings::get<KfxKey::SCREENSHOT>()));
     ui->lineEditGameturns->setText(Settings::getLauncherSetting("GAME_PARAM_FPS").toString());
-    ui->lineEditCommandChar->setText(Settings::getKfxSetting("COMMAND_CHAR").toString());
-    ui->checkBoxDeltaTime->setChecked(Settings::getKfxSetting("DELTA_TIME") == true);
-    ui->checkBoxFreezeGameNoFocus->setChecked(Settings::getKfxSetting("FREEZE_GAME_ON_FOCUS_LOST")
+    ui->lineEditCommandChar->setText(Settings::get<KfxKey::COMMAND_CHAR>());
+    ui->checkBoxDeltaTime->setChecked(Settings::get<KfxKey::DELTA_TIME>() == true);
+    ui->checkBoxFreezeGameNoFocus->setChecked(Settings::get<KfxKey::FREEZE_GAME_ON_FOCUS_LOST>()
                                               == true);
 
     bool isPacketSaveEnabled = Settings::getLauncherSetting("GAME_PARAM_PACKET_SAVE_ENABLED") == true;
@@ -487,22 +493,22 @@ void SettingsDialog::loadSettings()
     ui->lineEditPackSaveFileName->setDisabled(!isPacketSaveEnabled);
     ui->lineEditPackSaveFileName->setText(Settings::getLauncherSetting("GAME_PARAM_PACKET_SAVE_FILE_NAME").toString());
 
-    ui->checkBoxExitOnLuaError->setChecked(Settings::getKfxSetting("EXIT_ON_LUA_ERROR") == true);
+    ui->checkBoxExitOnLuaError->setChecked(Settings::get<KfxKey::EXIT_ON_LUA_ERROR>() == true);
 
-    ui->checkBoxAutoEnableFlee->setChecked(Settings::getKfxSetting("FLEE_BUTTON_DEFAULT") == true);
-    ui->checkBoxAutoEnableImprison->setChecked(Settings::getKfxSetting("IMPRISON_BUTTON_DEFAULT") == true);
+    ui->checkBoxAutoEnableFlee->setChecked(Settings::get<KfxKey::FLEE_BUTTON_DEFAULT>() == true);
+    ui->checkBoxAutoEnableImprison->setChecked(Settings::get<KfxKey::IMPRISON_BUTTON_DEFAULT>() == true);
 
     // ============================================================================
     // ================================ GRAPHICS ==================================
     // ============================================================================
 
-    popupComboBoxMonitorDisplay->setCurrentIndex(popupComboBoxMonitorDisplay->findData(Settings::getKfxSetting("DISPLAY_NUMBER").toString()));
+    popupComboBoxMonitorDisplay->setCurrentIndex(popupComboBoxMonitorDisplay->findData(Settings::get<KfxKey::DISPLAY_NUMBER>()));
     ui->checkBoxSmoothenVideo->setChecked(Settings::getLauncherSetting("GAME_PARAM_VID_SMOOTH")
                                           == true);
 
     // Resize movies
     // Small fix because "ON" defaults to "FIT", but we just want "FIT" here
-    QString resizeMoviesString = Settings::getKfxSetting("RESIZE_MOVIES").toString();
+    QString resizeMoviesString = Settings::get<KfxKey::RESIZE_MOVIES>();
     if (resizeMoviesString == "ON") {
         resizeMoviesString = "FIT";
     }
@@ -511,7 +517,7 @@ void SettingsDialog::loadSettings()
 
     // Loop trough the in-game resolutions
     int resolutionIndex = 0;
-    for (const QString &resolutionString : Settings::getKfxSetting("INGAME_RES").toString().trimmed().split(" "))
+    for (const QString &resolutionString : Settings::get<KfxKey::INGAME_RES>().trimmed().split(" "))
     {
         // Vars
         QString res, mode;
@@ -529,7 +535,7 @@ void SettingsDialog::loadSettings()
             // Use regex to split res and mode
             QRegularExpressionMatch match = QRegularExpression("(x32|w32)$").match(resolutionString);
             if (match.hasMatch() == false) {
-                qWarning() << "Invalid resolution in 'keeperfx.cfg':" << resolutionString;
+                qCWarning(logSettings) << "Invalid resolution in 'keeperfx.cfg':" << resolutionString;
                 resolutionIndex++;
                 continue;
             }
@@ -579,7 +585,7 @@ void SettingsDialog::loadSettings()
 
     // Loop trough the front end resolutions
     resolutionIndex = 0;
-    for (const QString &resolutionString : Settings::getKfxSetting("FRONTEND_RES").toString().trimmed().split(" ")) {
+    for (const QString &resolutionString : Settings::get<KfxKey::FRONTEND_RES>().trimmed().split(" ")) {
         // Vars
         QString res, mode;
 
@@ -595,7 +601,7 @@ void SettingsDialog::loadSettings()
             // Use regex to split res and mode
             QRegularExpressionMatch match = QRegularExpression("(x32|w32)$").match(resolutionString);
             if (match.hasMatch() == false) {
-                qWarning() << "Invalid resolution in 'keeperfx.cfg':" << resolutionString;
+                qCWarning(logSettings) << "Invalid resolution in 'keeperfx.cfg':" << resolutionString;
                 resolutionIndex++;
                 continue;
             }
@@ -643,13 +649,13 @@ void SettingsDialog::loadSettings()
         resolutionIndex++;
     }
 
-    ui->lineEditCreatureFlowerSize->setText(Settings::getKfxSetting("CREATURE_STATUS_SIZE").toString());
-    ui->lineEditLineBoxSize->setText(Settings::getKfxSetting("LINE_BOX_SIZE").toString());
-    ui->lineEditHandSize->setText(Settings::getKfxSetting("HAND_SIZE").toString());
+    ui->lineEditCreatureFlowerSize->setText(Settings::get<KfxKey::CREATURE_STATUS_SIZE>());
+    ui->lineEditLineBoxSize->setText(Settings::get<KfxKey::LINE_BOX_SIZE>());
+    ui->lineEditHandSize->setText(Settings::get<KfxKey::HAND_SIZE>());
 
     if (KfxVersion::hasFunctionality("max_frames_per_second") == true) {
         if (KfxVersion::hasFunctionality("auto_determine_monitor_refresh_rate") == true) {
-            QString maxFps = Settings::getKfxSetting("FRAMES_PER_SECOND").toString();
+            QString maxFps = Settings::get<KfxKey::FRAMES_PER_SECOND>();
             if(maxFps.contains("AUTO")){
                 ui->checkBoxAutoDetermineMaxFps->setChecked(true);
                 QString maxFpsNumber = maxFps.split(" ").last();
@@ -660,16 +666,16 @@ void SettingsDialog::loadSettings()
                 }
             } else {
                 ui->checkBoxAutoDetermineMaxFps->setChecked(false);
-                ui->lineEditMaxFps->setText(QString::number(Settings::getKfxSetting("FRAMES_PER_SECOND").toInt()));
+                ui->lineEditMaxFps->setText(QString::number(Settings::get<KfxKey::FRAMES_PER_SECOND>().toInt()));
             }
         } else {
-            ui->lineEditMaxFps->setText(QString::number(Settings::getKfxSetting("FRAMES_PER_SECOND").toInt()));
+            ui->lineEditMaxFps->setText(QString::number(Settings::get<KfxKey::FRAMES_PER_SECOND>().toInt()));
         }
     }
 
     if (KfxVersion::hasFunctionality("gui_and_neutral_blink_speed") == true) {
-        ui->lineEditGuiBlinkRate->setText(Settings::getKfxSetting("GUI_BLINK_RATE").toString());
-        ui->lineEditNeutralFlashRate->setText(Settings::getKfxSetting("NEUTRAL_FLASH_RATE").toString());
+        ui->lineEditGuiBlinkRate->setText(Settings::get<KfxKey::GUI_BLINK_RATE>());
+        ui->lineEditNeutralFlashRate->setText(Settings::get<KfxKey::NEUTRAL_FLASH_RATE>());
     }
 
     // =========================================================================
@@ -679,20 +685,20 @@ void SettingsDialog::loadSettings()
     ui->checkBoxEnableSound->setChecked(Settings::getLauncherSetting("GAME_PARAM_NO_SOUND") == false);
     ui->checkBoxUseCDMusic->setChecked(Settings::getLauncherSetting("GAME_PARAM_USE_CD_MUSIC") == true);
     ui->checkBoxPauseMusicWhenPaused->setChecked(
-        Settings::getKfxSetting("PAUSE_MUSIC_WHEN_GAME_PAUSED") == true);
+        Settings::get<KfxKey::PAUSE_MUSIC_WHEN_GAME_PAUSED>() == true);
     ui->checkBoxMuteAudioWhenNotFocused->setChecked(
-        Settings::getKfxSetting("MUTE_AUDIO_ON_FOCUS_LOST") == true);
+        Settings::get<KfxKey::MUTE_AUDIO_ON_FOCUS_LOST>() == true);
 
     // Atmospheric sounds
     ui->checkBoxEnableAtmoSounds->setChecked(
-        Settings::getKfxSetting("ATMOSPHERIC_SOUNDS") == true);
+        Settings::get<KfxKey::ATMOSPHERIC_SOUNDS>() == true);
     ui->comboBoxAtmoFrequency->setCurrentIndex(
-        ui->comboBoxAtmoFrequency->findData(Settings::getKfxSetting("ATMOS_FREQUENCY").toString()));
+        ui->comboBoxAtmoFrequency->findData(Settings::get<KfxKey::ATMOS_FREQUENCY>()));
     ui->comboBoxAtmoVolume->setCurrentIndex(
-        ui->comboBoxAtmoVolume->findData(Settings::getKfxSetting("ATMOS_VOLUME").toString()));
+        ui->comboBoxAtmoVolume->findData(Settings::get<KfxKey::ATMOS_VOLUME>()));
 
     // Atmospheric checkbox disable / enable extra info
-    bool isAtmoSoundsEnabled = Settings::getKfxSetting("ATMOSPHERIC_SOUNDS") == true;
+    bool isAtmoSoundsEnabled = Settings::get<KfxKey::ATMOSPHERIC_SOUNDS>() == true;
     ui->labelAtmoFrequency->setDisabled(!isAtmoSoundsEnabled);
     ui->labelAtmoVolume->setDisabled(!isAtmoSoundsEnabled);
     ui->comboBoxAtmoFrequency->setDisabled(!isAtmoSoundsEnabled);
@@ -702,7 +708,7 @@ void SettingsDialog::loadSettings()
     // ================================ INPUT ==================================
     // =========================================================================
 
-    int mouseSens = Settings::getKfxSetting("POINTER_SENSITIVITY").toInt();
+    int mouseSens = Settings::get<KfxKey::POINTER_SENSITIVITY>();
     if (mouseSens == 0) {
         ui->checkBoxRawMouseInput->setChecked(true);
         ui->horizontalSliderMouseSens->setDisabled(true);
@@ -720,29 +726,29 @@ void SettingsDialog::loadSettings()
     }
 
     ui->checkBoxAltInput->setChecked(Settings::getLauncherSetting("GAME_PARAM_ALT_INPUT") == true);
-    ui->checkBoxUnlockCursorWhenPaused->setChecked(Settings::getKfxSetting("UNLOCK_CURSOR_WHEN_GAME_PAUSED") == true);
-    ui->checkBoxLockCursorPossession->setChecked(Settings::getKfxSetting("LOCK_CURSOR_IN_POSSESSION") == true);
-    ui->checkBoxScreenEdgePanning->setChecked(Settings::getKfxSetting("CURSOR_EDGE_CAMERA_PANNING") == true);
+    ui->checkBoxUnlockCursorWhenPaused->setChecked(Settings::get<KfxKey::UNLOCK_CURSOR_WHEN_GAME_PAUSED>() == true);
+    ui->checkBoxLockCursorPossession->setChecked(Settings::get<KfxKey::LOCK_CURSOR_IN_POSSESSION>() == true);
+    ui->checkBoxScreenEdgePanning->setChecked(Settings::get<KfxKey::CURSOR_EDGE_CAMERA_PANNING>() == true);
 
     ui->checkBoxUnlockCursorWhenPaused->setEnabled(Settings::getLauncherSetting("GAME_PARAM_ALT_INPUT") == false); // When alt input is DISABLED
     ui->checkBoxLockCursorPossession->setEnabled(Settings::getLauncherSetting("GAME_PARAM_ALT_INPUT") == true); // When alt input is ENABLED
 
-    ui->checkBoxEnableTagModeToggle->setChecked(Settings::getKfxSetting("TAG_MODE_TOGGLING") == true);
-    ui->comboBoxDefaultTagMode->setCurrentIndex(ui->comboBoxDefaultTagMode->findData(Settings::getKfxSetting("DEFAULT_TAG_MODE").toString()));
+    ui->checkBoxEnableTagModeToggle->setChecked(Settings::get<KfxKey::TAG_MODE_TOGGLING>() == true);
+    ui->comboBoxDefaultTagMode->setCurrentIndex(ui->comboBoxDefaultTagMode->findData(Settings::get<KfxKey::DEFAULT_TAG_MODE>()));
 
     // ===============================================================================
     // ================================ MULTIPLAYER ==================================
     // ===============================================================================
 
-    //ui->lineEditMasterServer->setText(Settings::getKfxSetting("MASTERSERVER_HOST").toString());
+    //ui->lineEditMasterServer->setText(Settings::get<KfxKey::MASTERSERVER_HOST>());
 
     // =======================================================================
     // ================================ API ==================================
     // =======================================================================
 
-    bool isApiEnabled = Settings::getKfxSetting("API_ENABLED") == true;
+    bool isApiEnabled = Settings::get<KfxKey::API_ENABLED>() == true;
     ui->checkBoxEnableAPI->setChecked(isApiEnabled);
-    ui->lineEditApiPort->setText(Settings::getKfxSetting("API_PORT").toString());
+    ui->lineEditApiPort->setText(Settings::get<KfxKey::API_PORT>());
 
     ui->labelApiPort->setDisabled(!isApiEnabled);
     ui->lineEditApiPort->setDisabled(!isApiEnabled);
@@ -773,6 +779,7 @@ void SettingsDialog::loadSettings()
     ui->labelUpdateInterval->setDisabled(!isUpdateCheckEnabled);
 
     ui->checkBoxAutoRemoveLeftoverFiles->setChecked(Settings::getLauncherSetting("AUTO_REMOVE_LEFTOVER_FILES") == true);
+    ui->checkBoxWinePrewarm->setChecked(Settings::getLauncherSetting("WINE_PREWARM_ENABLED") == true);
 }
 
 void SettingsDialog::saveSettings()
@@ -782,17 +789,17 @@ void SettingsDialog::saveSettings()
     // ================================ GAME ==================================
     // ========================================================================
 
-    Settings::setKfxSetting("LANGUAGE", ui->comboBoxLanguage->currentData().toString());
+    Settings::set<KfxKey::LANGUAGE>(ui->comboBoxLanguage->currentData().toString());
     Settings::setLauncherSetting("GAME_PARAM_ALEX", ui->checkBoxCheats->isChecked());
-    Settings::setKfxSetting("CENSORSHIP", ui->checkBoxCensorship->isChecked());
-    Settings::setKfxSetting("SCREENSHOT", ui->comboBoxScreenshots->currentData().toString());
+    Settings::set<KfxKey::CENSORSHIP>(ui->checkBoxCensorship->isChecked());
+    Settings::set<KfxKey::SCREENSHOT>(ui->comboBoxScreenshots->currentData().toString());
     Settings::setLauncherSetting("GAME_PARAM_FPS", ui->lineEditGameturns->text());
-    Settings::setKfxSetting("DELTA_TIME", ui->checkBoxDeltaTime->isChecked());
-    Settings::setKfxSetting("FREEZE_GAME_ON_FOCUS_LOST", ui->checkBoxFreezeGameNoFocus->isChecked());
+    Settings::set<KfxKey::DELTA_TIME>(ui->checkBoxDeltaTime->isChecked());
+    Settings::set<KfxKey::FREEZE_GAME_ON_FOCUS_LOST>(ui->checkBoxFreezeGameNoFocus->isChecked());
     Settings::setLauncherSetting("GAME_PARAM_PACKET_SAVE_ENABLED", ui->checkBoxPacketSaveEnabled->isChecked() == true);
-    Settings::setKfxSetting("EXIT_ON_LUA_ERROR", ui->checkBoxExitOnLuaError->isChecked());
-    Settings::setKfxSetting("FLEE_BUTTON_DEFAULT", ui->checkBoxAutoEnableFlee->isChecked());
-    Settings::setKfxSetting("IMPRISON_BUTTON_DEFAULT", ui->checkBoxAutoEnableImprison->isChecked());
+    Settings::set<KfxKey::EXIT_ON_LUA_ERROR>(ui->checkBoxExitOnLuaError->isChecked());
+    Settings::set<KfxKey::FLEE_BUTTON_DEFAULT>(ui->checkBoxAutoEnableFlee->isChecked());
+    Settings::set<KfxKey::IMPRISON_BUTTON_DEFAULT>(ui->checkBoxAutoEnableImprison->isChecked());
 
     // Handle different ways of the startup screens depending on KFX version
     if (KfxVersion::hasFunctionality("startup_config_option")) {
@@ -807,21 +814,21 @@ void SettingsDialog::saveSettings()
         }
         // Add any hidden startup screens
         if (this->hiddenStartupScreens.isEmpty() == false) {
-            qDebug() << "Adding hidden startup screens to STARTUP:" << this->hiddenStartupScreens;
+            qCDebug(logSettings) << "Adding hidden startup screens to STARTUP:" << this->hiddenStartupScreens;
             startupScreens << this->hiddenStartupScreens;
         }
-        Settings::setKfxSetting("STARTUP", startupScreens.join(" "));
-        Settings::removeKfxSetting("DISABLE_SPLASH_SCREENS");
+        Settings::set<KfxKey::STARTUP>(startupScreens.join(" "));
+        Settings::remove<KfxKey::DISABLE_SPLASH_SCREENS>();
     } else {
         Settings::setLauncherSetting("GAME_PARAM_NO_INTRO", ui->checkBoxDisplayIntro->isChecked() == false);
-        Settings::setKfxSetting("DISABLE_SPLASH_SCREENS", ui->checkBoxDisplaySplashScreens->isChecked() == false);
+        Settings::set<KfxKey::DISABLE_SPLASH_SCREENS>(ui->checkBoxDisplaySplashScreens->isChecked() == false);
     }
 
     // Make sure command char is not empty
     if(ui->lineEditCommandChar->text().isEmpty() == true){
         ui->lineEditCommandChar->setText("!");
     }
-    Settings::setKfxSetting("COMMAND_CHAR", ui->lineEditCommandChar->text());
+    Settings::set<KfxKey::COMMAND_CHAR>(ui->lineEditCommandChar->text());
 
     // Packet save
     QString packetSaveFileName = ui->lineEditPackSaveFileName->text();
@@ -839,8 +846,8 @@ void SettingsDialog::saveSettings()
     // ============================================================================
 
     Settings::setLauncherSetting("GAME_PARAM_VID_SMOOTH", ui->checkBoxSmoothenVideo->isChecked());
-    Settings::setKfxSetting("DISPLAY_NUMBER", popupComboBoxMonitorDisplay->currentData().toString());
-    Settings::setKfxSetting("RESIZE_MOVIES", ui->comboBoxResizeMovies->currentData().toString());
+    Settings::set<KfxKey::DISPLAY_NUMBER>(popupComboBoxMonitorDisplay->currentData().toString());
+    Settings::set<KfxKey::RESIZE_MOVIES>(ui->comboBoxResizeMovies->currentData().toString());
 
     // Save the in-game resolutions
     QString resolutionString = "";
@@ -881,7 +888,7 @@ void SettingsDialog::saveSettings()
             resolutionString += " ";
         }
     }
-    Settings::setKfxSetting("INGAME_RES", resolutionString);
+    Settings::set<KfxKey::INGAME_RES>(resolutionString);
 
     // Save the front end resolutions
     resolutionString = "";
@@ -922,23 +929,23 @@ void SettingsDialog::saveSettings()
             resolutionString += " ";
         }
     }
-    Settings::setKfxSetting("FRONTEND_RES", resolutionString);
+    Settings::set<KfxKey::FRONTEND_RES>(resolutionString);
 
-    Settings::setKfxSetting("CREATURE_STATUS_SIZE", ui->lineEditCreatureFlowerSize->text());
-    Settings::setKfxSetting("LINE_BOX_SIZE", ui->lineEditLineBoxSize->text());
-    Settings::setKfxSetting("HAND_SIZE", ui->lineEditHandSize->text());
+    Settings::set<KfxKey::CREATURE_STATUS_SIZE>(ui->lineEditCreatureFlowerSize->text());
+    Settings::set<KfxKey::LINE_BOX_SIZE>(ui->lineEditLineBoxSize->text());
+    Settings::set<KfxKey::HAND_SIZE>(ui->lineEditHandSize->text());
 
     if (KfxVersion::hasFunctionality("max_frames_per_second") == true) {
         if (KfxVersion::hasFunctionality("auto_determine_monitor_refresh_rate") == true && ui->checkBoxAutoDetermineMaxFps->isChecked()) {
-            Settings::setKfxSetting("FRAMES_PER_SECOND", "AUTO " + ui->lineEditMaxFps->text());
+            Settings::set<KfxKey::FRAMES_PER_SECOND>("AUTO " + ui->lineEditMaxFps->text());
         } else {
-            Settings::setKfxSetting("FRAMES_PER_SECOND", ui->lineEditMaxFps->text());
+            Settings::set<KfxKey::FRAMES_PER_SECOND>(ui->lineEditMaxFps->text());
         }
     }
 
     if (KfxVersion::hasFunctionality("gui_and_neutral_blink_speed") == true) {
-        Settings::setKfxSetting("GUI_BLINK_RATE", ui->lineEditGuiBlinkRate->text());
-        Settings::setKfxSetting("NEUTRAL_FLASH_RATE", ui->lineEditNeutralFlashRate->text());
+        Settings::set<KfxKey::GUI_BLINK_RATE>(ui->lineEditGuiBlinkRate->text());
+        Settings::set<KfxKey::NEUTRAL_FLASH_RATE>(ui->lineEditNeutralFlashRate->text());
     }
 
     // =========================================================================
@@ -947,42 +954,42 @@ void SettingsDialog::saveSettings()
 
     Settings::setLauncherSetting("GAME_PARAM_NO_SOUND", ui->checkBoxEnableSound->isChecked() == false);
     Settings::setLauncherSetting("GAME_PARAM_USE_CD_MUSIC", ui->checkBoxUseCDMusic->isChecked());
-    Settings::setKfxSetting("PAUSE_MUSIC_WHEN_GAME_PAUSED", ui->checkBoxPauseMusicWhenPaused->isChecked());
-    Settings::setKfxSetting("MUTE_AUDIO_ON_FOCUS_LOST", ui->checkBoxMuteAudioWhenNotFocused->isChecked());
-    Settings::setKfxSetting("ATMOSPHERIC_SOUNDS", ui->checkBoxEnableAtmoSounds->isChecked());
-    Settings::setKfxSetting("ATMOS_FREQUENCY", ui->comboBoxAtmoFrequency->currentData().toString());
-    Settings::setKfxSetting("ATMOS_VOLUME", ui->comboBoxAtmoVolume->currentData().toString());
+    Settings::set<KfxKey::PAUSE_MUSIC_WHEN_GAME_PAUSED>(ui->checkBoxPauseMusicWhenPaused->isChecked());
+    Settings::set<KfxKey::MUTE_AUDIO_ON_FOCUS_LOST>(ui->checkBoxMuteAudioWhenNotFocused->isChecked());
+    Settings::set<KfxKey::ATMOSPHERIC_SOUNDS>(ui->checkBoxEnableAtmoSounds->isChecked());
+    Settings::set<KfxKey::ATMOS_FREQUENCY>(ui->comboBoxAtmoFrequency->currentData().toString());
+    Settings::set<KfxKey::ATMOS_VOLUME>(ui->comboBoxAtmoVolume->currentData().toString());
 
     // =========================================================================
     // ================================ INPUT ==================================
     // =========================================================================
 
     if(ui->checkBoxRawMouseInput->isChecked()){
-        Settings::setKfxSetting("POINTER_SENSITIVITY", 0);
+        Settings::set<KfxKey::POINTER_SENSITIVITY>(0);
     } else {
-        Settings::setKfxSetting("POINTER_SENSITIVITY", ui->horizontalSliderMouseSens->value());
+        Settings::set<KfxKey::POINTER_SENSITIVITY>(ui->horizontalSliderMouseSens->value());
     }
 
     Settings::setLauncherSetting("GAME_PARAM_ALT_INPUT", ui->checkBoxAltInput->isChecked() == true);
-    Settings::setKfxSetting("UNLOCK_CURSOR_WHEN_GAME_PAUSED", ui->checkBoxUnlockCursorWhenPaused->isChecked() == true);
-    Settings::setKfxSetting("LOCK_CURSOR_IN_POSSESSION", ui->checkBoxLockCursorPossession->isChecked() == true);
-    Settings::setKfxSetting("CURSOR_EDGE_CAMERA_PANNING", ui->checkBoxScreenEdgePanning->isChecked() == true);
+    Settings::set<KfxKey::UNLOCK_CURSOR_WHEN_GAME_PAUSED>(ui->checkBoxUnlockCursorWhenPaused->isChecked() == true);
+    Settings::set<KfxKey::LOCK_CURSOR_IN_POSSESSION>(ui->checkBoxLockCursorPossession->isChecked() == true);
+    Settings::set<KfxKey::CURSOR_EDGE_CAMERA_PANNING>(ui->checkBoxScreenEdgePanning->isChecked() == true);
 
-    Settings::setKfxSetting("TAG_MODE_TOGGLING", ui->checkBoxEnableTagModeToggle->isChecked() == true);
-    Settings::setKfxSetting("DEFAULT_TAG_MODE", ui->comboBoxDefaultTagMode->currentData().toString());
+    Settings::set<KfxKey::TAG_MODE_TOGGLING>(ui->checkBoxEnableTagModeToggle->isChecked() == true);
+    Settings::set<KfxKey::DEFAULT_TAG_MODE>(ui->comboBoxDefaultTagMode->currentData().toString());
 
     // ===============================================================================
     // ================================ MULTIPLAYER ==================================
     // ===============================================================================
 
-    //Settings::setKfxSetting("MASTERSERVER_HOST", ui->lineEditMasterServer->text());
+    //Settings::set<KfxKey::MASTERSERVER_HOST>(ui->lineEditMasterServer->text());
 
     // =======================================================================
     // ================================ API ==================================
     // =======================================================================
 
-    Settings::setKfxSetting("API_ENABLED", ui->checkBoxEnableAPI->isChecked() == true);
-    Settings::setKfxSetting("API_PORT", ui->lineEditApiPort->text());
+    Settings::set<KfxKey::API_ENABLED>(ui->checkBoxEnableAPI->isChecked() == true);
+    Settings::set<KfxKey::API_PORT>(ui->lineEditApiPort->text());
 
     // ============================================================================
     // ================================ LAUNCHER ==================================
@@ -1003,6 +1010,7 @@ void SettingsDialog::saveSettings()
     Settings::setLauncherSetting("CHECK_FOR_UPDATES_INTERVAL_DAYS", ui->lineEditUpdateInterval->text());
 
     Settings::setLauncherSetting("AUTO_REMOVE_LEFTOVER_FILES", ui->checkBoxAutoRemoveLeftoverFiles->isChecked() == true);
+    Settings::setLauncherSetting("WINE_PREWARM_ENABLED", ui->checkBoxWinePrewarm->isChecked() == true);
 
     // Close the settings screen
     this->close();
@@ -1023,6 +1031,9 @@ void SettingsDialog::restoreSettings()
     // Remember original KeeperFX release path because we don't want that to change
     QString kfxReleasePath = Settings::getLauncherSetting("CHECK_FOR_UPDATES_RELEASE").toString();
 
+    // Write pending changes now so they are not written into the restored file later
+    Settings::flush();
+
     // Get '_keeperfx.cfg' file
     QFile originalSettingsFile(QCoreApplication::applicationDirPath() + "/_keeperfx.cfg");
     if(originalSettingsFile.exists() == false){
@@ -1171,13 +1182,13 @@ void SettingsDialog::setupDisplayMonitorDropdown()
 
 void SettingsDialog::showMonitorNumberOverlays()
 {
-    qDebug() << "Show monitor number overlays";
+    qCDebug(logSettings) << "Show monitor number overlays";
 
     // We can't show the overlays on wayland
     // They will stack like windows and we can't change their position
     // TODO: monitor when this is possible on wayland and allow it again
     if (QGuiApplication::platformName() == "wayland") {
-        qDebug() << "Monitor overlays not shown because running under 'wayland'";
+        qCDebug(logSettings) << "Monitor overlays not shown because running under 'wayland'";
         return;
     }
 
@@ -1223,7 +1234,7 @@ void SettingsDialog::showMonitorNumberOverlays()
 
 void SettingsDialog::hideMonitorNumberOverlays()
 {
-    qDebug() << "Hide monitor number overlays";
+    qCDebug(logSettings) << "Hide monitor number overlays";
 
     // Remove all the overlays
     for (QWidget *overlay : std::as_const(monitorNumberOverlays)) {
@@ -1256,7 +1267,7 @@ void SettingsDialog::onOpenConfigButtonClicked()
 {
     QString configFilePath = Settings::getKfxConfigFile().fileName();
 
-    qDebug() << "Trying to open KeeperFX settings config file:" << configFilePath;
+    qCDebug(logSettings) << "Trying to open KeeperFX settings config file:" << configFilePath;
 
     // Open file using OS functionality
     QDesktopServices::openUrl(QUrl::fromLocalFile(configFilePath));
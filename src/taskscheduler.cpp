@@ -0,0 +1,93 @@
+#include "taskscheduler.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QThread>
+
+// Amount of blocking file tasks that run at the same time
+// More would only make the disk seek between them
+#define TASK_SCHEDULER_IO_THREADS 4
+
+// Amount of blocking web requests that run at the same time
+#define TASK_SCHEDULER_NETWORK_THREADS 8
+
+// How long we wait for running tasks when the launcher closes
+#define TASK_SCHEDULER_SHUTDOWN_TIMEOUT_MS 3000
+
+std::atomic_bool TaskScheduler::shuttingDown{false};
+
+QThreadPool *TaskScheduler::getPool(Pool pool)
+{
+    // The pools are never deleted
+    // Deleting them would wait for tasks that might be stuck on a slow connection
+    static QThreadPool *ioPool = []() {
+        QThreadPool *threadPool = new QThreadPool();
+        threadPool->setObjectName("IO");
+        threadPool->setMaxThreadCount(TASK_SCHEDULER_IO_THREADS);
+        return threadPool;
+    }();
+
+    static QThreadPool *cpuPool = []() {
+        QThreadPool *threadPool = new QThreadPool();
+        threadPool->setObjectName("CPU");
+        threadPool->setMaxThreadCount(QThread::idealThreadCount());
+        return threadPool;
+    }();
+
+    static QThreadPool *networkPool = []() {
+        QThreadPool *threadPool = new QThreadPool();
+        threadPool->setObjectName("NETWORK");
+        threadPool->setMaxThreadCount(TASK_SCHEDULER_NETWORK_THREADS);
+        return threadPool;
+    }();
+
+    switch (pool) {
+    case Pool::IO:
+        return ioPool;
+    case Pool::CPU:
+        return cpuPool;
+    case Pool::NETWORK:
+        return networkPool;
+    }
+
+    return cpuPool;
+}
+
+void TaskScheduler::start(Pool pool, std::function<void()> function)
+{
+    if (TaskScheduler::isShuttingDown()) {
+        return;
+    }
+
+    // Tasks that are still queued when the launcher shuts down are skipped
+    getPool(pool)->start([function = std::move(function)]() {
+        if (TaskScheduler::isShuttingDown() == false) {
+            function();
+        }
+    });
+}
+
+void TaskScheduler::shutdown()
+{
+    TaskScheduler::shuttingDown = true;
+
+    // Queued tasks are not dropped
+    // A dropped QtConcurrent task never finishes its future so anything waiting on it would hang
+    // They still run but stop early because their cancellation tokens are canceled now
+
+    // The pools share the timeout
+    QElapsedTimer timer;
+    timer.start();
+    for (Pool pool : {Pool::IO, Pool::CPU, Pool::NETWORK}) {
+        QThreadPool *threadPool = getPool(pool);
+        int remainingTime = qMax<int>(0, TASK_SCHEDULER_SHUTDOWN_TIMEOUT_MS - timer.elapsed());
+        if (threadPool->waitForDone(remainingTime) == false) {
+            qWarning() << "Tasks still running in the" << threadPool->objectName() << "pool while shutting down";
+        }
+    }
+}
+
+bool TaskScheduler::isShuttingDown()
+{
+    return TaskScheduler::shuttingDown;
+}
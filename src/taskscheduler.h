@@ -0,0 +1,55 @@
+#pragma once
+
+#include <QFuture>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+class TaskScheduler
+{
+public:
+    enum class Pool {
+        IO,      // Blocking file work like testing and extracting archives
+        CPU,     // Work that keeps a core busy
+        NETWORK, // Blocking web requests and the handling of their results
+    };
+
+    static QThreadPool *getPool(Pool pool);
+
+    // Runs a function in a pool and returns its future
+    template<typename Function, typename... Args>
+    static auto run(Pool pool, Function &&function, Args &&...args)
+    {
+        return QtConcurrent::run(getPool(pool), std::forward<Function>(function), std::forward<Args>(args)...);
+    }
+
+    // Starts a function in a pool without a result
+    static void start(Pool pool, std::function<void()> function);
+
+    // Cancels all tokens and gives the running and queued tasks a moment to finish
+    static void shutdown();
+    static bool isShuttingDown();
+
+private:
+    static std::atomic_bool shuttingDown;
+};
+
+// Asks a running task to stop
+// Copies share the same state so a task can keep its own copy
+// A token is also canceled when the launcher shuts down
+class CancellationToken
+{
+public:
+    CancellationToken()
+        : canceled(std::make_shared<std::atomic_bool>(false))
+    {}
+
+    void cancel() { canceled->store(true); }
+    bool isCanceled() const { return canceled->load() || TaskScheduler::isShuttingDown(); }
+
+private:
+    std::shared_ptr<std::atomic_bool> canceled;
+};
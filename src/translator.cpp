@@ -4,13 +4,24 @@
 
 #include <QDebug>
 #include <QFile>
-#include <QMap>
+#include <QHash>
+#include <QResource>
 #include <QString>
 #include <QTextDocument>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cstring>
+
+// Layout of the binary catalogs
+// This has to match 'compile-translations.py'
+#define TRANSLATOR_CATALOG_MAGIC "KFXT"
+#define TRANSLATOR_CATALOG_VERSION 1
+#define TRANSLATOR_CATALOG_HEADER_SIZE 16
+#define TRANSLATOR_CATALOG_ENTRY_SIZE 20
 
 Translator::Translator(QObject *parent)
     : QTranslator(parent) {
-    translations = QMap<QString, QString>();
 }
 
 bool Translator::loadLanguage(const QString &languageCode)
@@ -26,34 +37,173 @@ bool Translator::loadLanguage(const QString &languageCode)
         return false;
     }
 
-    // Translation filepath in resources
-    return Translator::loadPoFile(QString(":/i18n/i18n/translations_%1.po").arg(languageCodeString));
+    // Compiled catalog in resources
+    return Translator::loadCatalogFile(QString(":/i18n/i18n/translations_%1.cat").arg(languageCodeString));
+}
+
+bool Translator::loadCatalogFile(const QString &catalogFilePath)
+{
+    // The catalogs are stored uncompressed so we can use the resource data as it is
+    QResource resource(catalogFilePath);
+    if (resource.isValid() == false) {
+        qWarning() << "Could not open translation catalog:" << catalogFilePath;
+        return false;
+    }
+
+    const uchar *data = resource.data();
+    bool isUsableDirectly = resource.compressionAlgorithm() == QResource::NoCompression
+                            && reinterpret_cast<quintptr>(data) % alignof(char16_t) == 0
+                            && QSysInfo::ByteOrder == QSysInfo::LittleEndian;
+
+    if (isUsableDirectly) {
+        catalogData.clear();
+    } else {
+        catalogData = resource.uncompressedData();
+        data = reinterpret_cast<const uchar *>(catalogData.constData());
+    }
+
+    if (setCatalog(data, isUsableDirectly ? resource.size() : catalogData.size()) == false) {
+        qWarning() << "Invalid translation catalog:" << catalogFilePath;
+        return false;
+    }
+
+    qInfo() << "Translations loaded:" << catalogEntryCount;
+    return true;
+}
+
+bool Translator::setCatalog(const uchar *data, qsizetype size)
+{
+    catalog = nullptr;
+    catalogEntryCount = 0;
+
+    if (size < TRANSLATOR_CATALOG_HEADER_SIZE
+        || memcmp(data, TRANSLATOR_CATALOG_MAGIC, 4) != 0
+        || qFromLittleEndian<quint32>(data + 4) != TRANSLATOR_CATALOG_VERSION) {
+        return false;
+    }
+
+    quint32 entryCount = qFromLittleEndian<quint32>(data + 8);
+    if (size < TRANSLATOR_CATALOG_HEADER_SIZE + qint64(entryCount) * TRANSLATOR_CATALOG_ENTRY_SIZE) {
+        return false;
+    }
+
+    // Make sure every string is inside the catalog
+    for (quint32 i = 0; i < entryCount; i++) {
+        const uchar *entry = data + TRANSLATOR_CATALOG_HEADER_SIZE + i * TRANSLATOR_CATALOG_ENTRY_SIZE;
+        qint64 sourceEnd = qint64(qFromLittleEndian<quint32>(entry + 4)) + qFromLittleEndian<quint32>(entry + 8);
+        qint64 translationOffset = qFromLittleEndian<quint32>(entry + 12);
+        qint64 translationEnd = translationOffset + qint64(qFromLittleEndian<quint32>(entry + 16)) * 2;
+        if (sourceEnd > size || translationEnd > size || translationOffset % 2 != 0) {
+            return false;
+        }
+    }
+
+    catalog = data;
+    catalogEntryCount = entryCount;
+    return true;
+}
+
+quint32 Translator::hashSource(QByteArrayView source)
+{
+    // 32-bit FNV-1a, the catalogs are compiled with the same hash
+    quint32 hash = 0x811C9DC5;
+    for (char c : source) {
+        hash ^= static_cast<uchar>(c);
+        hash *= 0x01000193;
+    }
+    return hash;
+}
+
+QByteArray Translator::compileCatalog(const QHash<QByteArray, QString> &translations)
+{
+    struct Entry
+    {
+        quint32 hash;
+        QByteArray source;
+        QString translation;
+    };
+
+    QList<Entry> entries;
+    entries.reserve(translations.size());
+    for (auto it = translations.constBegin(); it != translations.constEnd(); ++it) {
+        if (it.value().isEmpty() == false) {
+            entries.append({hashSource(it.key()), it.key(), it.value()});
+        }
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+        return a.hash != b.hash ? a.hash < b.hash : a.source < b.source;
+    });
+
+    // Same layout as the catalogs compiled by 'compile-translations.py'
+    QByteArray table;
+    QByteArray data;
+    qint64 dataStart = TRANSLATOR_CATALOG_HEADER_SIZE + qint64(entries.size()) * TRANSLATOR_CATALOG_ENTRY_SIZE;
+    auto appendUInt32 = [](QByteArray &array, quint32 value) {
+        uchar bytes[4];
+        qToLittleEndian(value, bytes);
+        array.append(reinterpret_cast<const char *>(bytes), 4);
+    };
+
+    for (const Entry &entry : std::as_const(entries)) {
+        quint32 sourceOffset = quint32(dataStart + data.size());
+        data.append(entry.source);
+
+        if (data.size() % 2 != 0) {
+            data.append('\0');
+        }
+        quint32 translationOffset = quint32(dataStart + data.size());
+        for (QChar c : entry.translation) {
+            uchar bytes[2];
+            qToLittleEndian(c.unicode(), bytes);
+            data.append(reinterpret_cast<const char *>(bytes), 2);
+        }
+
+        appendUInt32(table, entry.hash);
+        appendUInt32(table, sourceOffset);
+        appendUInt32(table, quint32(entry.source.size()));
+        appendUInt32(table, translationOffset);
+        appendUInt32(table, quint32(entry.translation.size()));
+    }
+
+    QByteArray catalog(TRANSLATOR_CATALOG_MAGIC);
+    appendUInt32(catalog, TRANSLATOR_CATALOG_VERSION);
+    appendUInt32(catalog, quint32(entries.size()));
+    appendUInt32(catalog, 0);
+    return catalog + table + data;
 }
 
 bool Translator::loadPoFile(const QString &poFilePath)
 {
+    // This is only used to test translations, the launcher languages use compiled catalogs
+    // The rules here have to match 'compile-translations.py'
+
     // Open translation file
     QFile file(poFilePath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    if (!file.open(QIODevice::ReadOnly)) {
         qWarning() << "Could not open translation file:" << poFilePath;
         return false;
     }
 
-    // Clear current translations
-    translations.clear();
+    // Read the whole file at once
+    QByteArray data = file.readAll();
+    file.close();
 
     // Variables
-    QTextStream in(&file);
-    QString line;
-    QString msgid;
-    QString msgstr;
+    QHash<QByteArray, QByteArray> translations;
+    QByteArray msgid;
+    QByteArray msgstr;
     bool inMsgid = false;
     bool inMsgstr = false;
     int translationsLoaded = 0;
 
     // Loop trough PO file
-    while (!in.atEnd()) {
-        line = in.readLine().trimmed();
+    qsizetype pos = 0;
+    while (pos < data.size()) {
+        qsizetype newlineIndex = data.indexOf('\n', pos);
+        qsizetype lineEnd = newlineIndex == -1 ? data.size() : newlineIndex;
+        QByteArrayView line = QByteArrayView(data).sliced(pos, lineEnd - pos).trimmed();
+        pos = lineEnd + 1;
 
         if (line.startsWith("msgid")) {
             if (!msgid.isEmpty() && !msgstr.isEmpty()) {
@@ -62,17 +212,17 @@ bool Translator::loadPoFile(const QString &poFilePath)
                 msgid.clear();
                 msgstr.clear();
             }
-            msgid = line.mid(7).chopped(1);
+            msgid = line.mid(7).chopped(1).toByteArray();
             inMsgid = true;
             inMsgstr = false;
         } else if (line.startsWith("msgstr")) {
-            msgstr = line.mid(8).chopped(1);
+            msgstr = line.mid(8).chopped(1).toByteArray();
             inMsgid = false;
             inMsgstr = true;
         } else if (inMsgid && line.startsWith("\"")) {
-            msgid += line.mid(1).chopped(1);
+            msgid.append(line.mid(1).chopped(1));
         } else if (inMsgstr && line.startsWith("\"")) {
-            msgstr += line.mid(1).chopped(1);
+            msgstr.append(line.mid(1).chopped(1));
         }
     }
 
@@ -83,39 +233,87 @@ bool Translator::loadPoFile(const QString &poFilePath)
     }
 
     // Fix translations that contain newlines
-    for (const QString &msgIdString : translations.keys()) {
+    for (const QByteArray &msgIdString : translations.keys()) {
         if (msgIdString.contains("\\n")) {
-            QString newMsgId = msgIdString;
+            QByteArray newMsgId = msgIdString;
             newMsgId.replace("\\n", "\n");
-            translations[newMsgId] = translations.value(msgIdString).replace("\\n", "\n");
+            translations[newMsgId] = QByteArray(translations.value(msgIdString)).replace("\\n", "\n");
             translationsLoaded++;
         }
     }
 
+    // Convert the translations
+    QHash<QByteArray, QString> catalogTranslations;
+    catalogTranslations.reserve(translations.size());
+    for (auto it = translations.constBegin(); it != translations.constEnd(); ++it) {
+        catalogTranslations.insert(it.key(), QString::fromUtf8(it.value()));
+    }
+
+    // Add translations for HTML escaped sources
+    // These are looked up by their unescaped source text so no escaping is required when translating
+    for (auto it = translations.constBegin(); it != translations.constEnd(); ++it) {
+        if (it.key().contains('&') == false) {
+            continue;
+        }
+
+        // Unescape the source text and make sure escaping it results in the original
+        QString escapedSource = QString::fromUtf8(it.key());
+        QString source = escapedSource;
+        source.replace("&lt;", "<").replace("&gt;", ">").replace("&quot;", "\"").replace("&amp;", "&");
+        if (source.toHtmlEscaped() != escapedSource) {
+            continue;
+        }
+
+        // Translations without escaping are used first
+        QByteArray sourceUtf8 = source.toUtf8();
+        if (catalogTranslations.value(sourceUtf8).isEmpty() == false) {
+            continue;
+        }
+
+        QTextDocument outputDoc;
+        outputDoc.setHtml(catalogTranslations.value(it.key()));
+        catalogTranslations.insert(sourceUtf8, outputDoc.toPlainText());
+    }
+
+    // Compile it into the same catalog format as the embedded translations
+    catalogData = compileCatalog(catalogTranslations);
+    setCatalog(reinterpret_cast<const uchar *>(catalogData.constData()), catalogData.size());
+
     // Done!
     qInfo() << "Translations loaded:" << translationsLoaded;
     return true;
 }
 
 QString Translator::translate(const char *context, const char *sourceText, const char *disambiguation, int n) const {
-    // Get source as string
-    QString source(sourceText);
-
-    // Check if this source has a translation
-    if (translations.contains(source)) {
-        QString output(translations.value(source));
-        if (output.isEmpty() == false) {
-            return output;
+    // Get source without copying it
+    QByteArrayView source(sourceText);
+    quint32 hash = hashSource(source);
+
+    // Find the first entry with this hash
+    quint32 first = 0;
+    quint32 last = catalogEntryCount;
+    while (first < last) {
+        quint32 middle = first + (last - first) / 2;
+        if (qFromLittleEndian<quint32>(catalog + TRANSLATOR_CATALOG_HEADER_SIZE + middle * TRANSLATOR_CATALOG_ENTRY_SIZE) < hash) {
+            first = middle + 1;
+        } else {
+            last = middle;
         }
     }
 
-    // Check if this source has a translation that is HTML escaped
-    if (translations.contains(source.toHtmlEscaped())) {
-        QString output(translations.value(source.toHtmlEscaped()));
-        if (output.isEmpty() == false) {
-            QTextDocument outputDoc;
-            outputDoc.setHtml(output);
-            return outputDoc.toPlainText();
+    // Compare the sources with the same hash
+    // Translations in the resource data are returned without copying them
+    for (quint32 i = first; i < catalogEntryCount; i++) {
+        const uchar *entry = catalog + TRANSLATOR_CATALOG_HEADER_SIZE + i * TRANSLATOR_CATALOG_ENTRY_SIZE;
+        if (qFromLittleEndian<quint32>(entry) != hash) {
+            break;
+        }
+
+        QByteArrayView entrySource(catalog + qFromLittleEndian<quint32>(entry + 4), qFromLittleEndian<quint32>(entry + 8));
+        if (entrySource == source) {
+            const QChar *translation = reinterpret_cast<const QChar *>(catalog + qFromLittleEndian<quint32>(entry + 12));
+            qsizetype translationSize = qFromLittleEndian<quint32>(entry + 16);
+            return catalogData.isEmpty() ? QString::fromRawData(translation, translationSize) : QString(translation, translationSize);
         }
     }
 
@@ -124,5 +322,5 @@ QString Translator::translate(const char *context, const char *sourceText, const
         qWarning() << "Translation not found:" << sourceText;
     }
 
-    return source;
+    return QString::fromUtf8(source);
 }
@@ -1,8 +1,9 @@
 #pragma once
 
 #include <QTranslator>
+#include <QByteArray>
+#include <QHash>
 #include <QString>
-#include <QMap>
 
 class Translator : public QTranslator {
     Q_OBJECT
@@ -11,11 +12,23 @@ public:
     explicit Translator(QObject *parent = nullptr);
 
     bool loadLanguage(const QString &languageCode);
+    bool loadCatalogFile(const QString &catalogFilePath);
     bool loadPoFile(const QString &poFilePath);
 
     QString translate(const char *context, const char *sourceText, const char *disambiguation = nullptr, int n = -1) const override;
 
 private:
-    QMap<QString, QString> translations;
+    // Binary catalog of translations sorted by the hash of their UTF-8 source text
+    // The catalogs of the launcher languages are compiled by 'compile-translations.py'
+    // They are searched directly in the resource data so loading them does not parse anything
+    const uchar *catalog = nullptr;
+    quint32 catalogEntryCount = 0;
 
+    // Owns the catalog when it could not be used from the resource directly
+    QByteArray catalogData;
+
+    bool setCatalog(const uchar *data, qsizetype size);
+
+    static quint32 hashSource(QByteArrayView source);
+    static QByteArray compileCatalog(const QHash<QByteArray, QString> &translations);
 };
@@ -5,6 +5,8 @@
 #include "savefile.h"
 #include "settings.h"
 #include "extractor.h"
+#include "logcategories.h"
+#include "taskscheduler.h"
 
 #include <QCloseEvent>
 #include <QDir>
@@ -15,7 +17,6 @@
 #include <QRegularExpression>
 #include <QStandardPaths>
 #include <QThread>
-#include <QThreadPool>
 #include <QTimer>
 
 #include <zlib.h>
@@ -89,7 +90,7 @@ UpdateDialog::UpdateDialog(QWidget *parent, KfxVersion::VersionInfo versionInfo,
     // Handle auto update
     this->autoUpdate = autoUpdate;
     if (this->autoUpdate) {
-        qDebug() << "Automatically starting update process";
+        qCDebug(logUpdate) << "Automatically starting update process";
         // Start process automatically
         ui->updateButton->click();
     }
@@ -103,7 +104,7 @@ UpdateDialog::~UpdateDialog()
 void UpdateDialog::onAppendLog(const QString &string)
 {
     // Log to debug output
-    qDebug() << "Update log:" << string;
+    qCDebug(logUpdate) << "Update log:" << string;
 
     // Set the cursor to the end
     ui->logTextArea->moveCursor(QTextCursor::End);
@@ -283,7 +284,7 @@ void UpdateDialog::updateUsingFilemap(QMap<QString, QString> fileMap)
             // We'll try to fallback to removing the file because the file might be corrupted or something
             // This shouldn't really happen but it might fix a weird issue
             if(file.remove() == true){
-                qDebug() << "Deleted file during update:" << localFilePath;
+                qCDebug(logUpdate) << "Deleted file during update:" << localFilePath;
                 updateList.append(filePath);
                 continue;
             }
@@ -301,7 +302,7 @@ void UpdateDialog::updateUsingFilemap(QMap<QString, QString> fileMap)
 
         // Compare checksums
         if (localChecksum != expectedChecksum) {
-            qDebug() << "Checksum difference:" << filePath << ":" << localChecksum << "->"
+            qCDebug(logUpdate) << "Checksum difference:" << filePath << ":" << localChecksum << "->"
                      << expectedChecksum;
             updateList.append(filePath);
         }
@@ -327,7 +328,7 @@ void UpdateDialog::updateUsingFilemap(QMap<QString, QString> fileMap)
 
     // Check if we need to remove the launcher from the update list
     if (LauncherOptions::isSet("skip-launcher-update") && updateList.contains("/keeperfx-launcher-qt.exe")) {
-        qInfo() << "Skipping launcher self-update ( --skip-launcher-update)";
+        qCInfo(logUpdate) << "Skipping launcher self-update ( --skip-launcher-update)";
         if (updateList.removeOne("/keeperfx-launcher-qt.exe")) {
             totalFiles--;
         }
@@ -386,7 +387,7 @@ void UpdateDialog::onArchiveDownloadFinished(bool success)
 
     // Test archive
     emit appendLog("Testing archive...");
-    QThreadPool::globalInstance()->start([this, outputFile]() {
+    TaskScheduler::start(TaskScheduler::Pool::IO, [this, outputFile]() {
         uint64_t archiveSize = Archiver::testArchiveAndGetSize(outputFile);
         QMetaObject::invokeMethod(this, "onArchiveTestComplete", Qt::QueuedConnection, Q_ARG(uint64_t, archiveSize));
     });